@@ -0,0 +1,307 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_ANALYSIS_HPP
+#define DJINTEROP_ANALYSIS_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/musical_key.hpp>
+#include <djinterop/optional.hpp>
+#include <djinterop/performance_data.hpp>
+
+namespace djinterop
+{
+/// The `beatgrid_analysis` struct holds the result of tempo and beatgrid
+/// estimation by a `beatgrid_analyzer`.
+struct beatgrid_analysis
+{
+    /// The estimated tempo, or `stdx::nullopt` if no steady tempo could be
+    /// found.
+    stdx::optional<double> bpm;
+
+    /// The estimated beatgrid, already normalised in the form expected by
+    /// Engine Prime, and therefore suitable for use as the default beatgrid
+    /// of a track snapshot.
+    ///
+    /// The beatgrid is empty if no steady tempo could be found.
+    std::vector<beatgrid_marker> beatgrid;
+};
+
+/// The `beatgrid_analyzer` class estimates the tempo and beatgrid of a track
+/// from its PCM audio, supplied in blocks of any size.
+///
+/// Audio is reduced to an onset envelope as it is fed in, so that memory use
+/// is proportional to track duration at a rate of roughly 86 values per
+/// second, regardless of the sample rate or the number of channels.  A steady
+/// tempo of between 60 and 200 BPM is assumed.
+///
+/// Instances are independent of one another, and so different tracks may be
+/// analysed concurrently on different threads.
+class DJINTEROP_PUBLIC beatgrid_analyzer
+{
+public:
+    /// Construct an analyzer for audio with the given sample rate and number
+    /// of interleaved channels.
+    ///
+    /// Throws `std::invalid_argument` if the sample rate is below 86Hz.
+    beatgrid_analyzer(double sample_rate, int channel_count);
+
+    beatgrid_analyzer(beatgrid_analyzer&& other) noexcept;
+
+    ~beatgrid_analyzer();
+
+    beatgrid_analyzer& operator=(beatgrid_analyzer&& other) noexcept;
+
+    /// Feed a block of interleaved samples, in the range [-1, 1].
+    ///
+    /// The block contains `frame_count * channel_count` samples.
+    void feed(const float* samples, std::size_t frame_count);
+
+    /// Finish the analysis, having fed all of the track's audio.
+    beatgrid_analysis finish();
+
+private:
+    struct impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+/// The `loudness_analysis` struct holds the result of loudness measurement by
+/// a `loudness_analyzer`.
+struct loudness_analysis
+{
+    /// The integrated loudness, in LUFS, as defined by ITU-R BS.1770-4.
+    ///
+    /// This is `stdx::nullopt` if the track is silent throughout.
+    stdx::optional<double> integrated_loudness;
+
+    /// The average loudness, in the range (0, 1], suitable for use as the
+    /// average loudness of a track snapshot.
+    ///
+    /// This is the integrated loudness converted from decibels to a linear
+    /// scale, so that 0 LUFS maps to 1 and every 6 LU quieter roughly halves
+    /// the value.  It is `stdx::nullopt` if the track is silent throughout.
+    stdx::optional<double> average_loudness;
+};
+
+/// The `loudness_analyzer` class measures the loudness of a track from its
+/// PCM audio, supplied in blocks of any size.
+///
+/// Audio is K-weighted and reduced to mean-square energies over 100ms steps
+/// as it is fed in, so that memory use is negligible even for long tracks.
+/// All channels are weighted equally.
+///
+/// Instances are independent of one another, and so different tracks may be
+/// analysed concurrently on different threads.
+class DJINTEROP_PUBLIC loudness_analyzer
+{
+public:
+    /// Construct an analyzer for audio with the given sample rate and number
+    /// of interleaved channels.
+    ///
+    /// Throws `std::invalid_argument` if the sample rate is below 5Hz.
+    loudness_analyzer(double sample_rate, int channel_count);
+
+    loudness_analyzer(loudness_analyzer&& other) noexcept;
+
+    ~loudness_analyzer();
+
+    loudness_analyzer& operator=(loudness_analyzer&& other) noexcept;
+
+    /// Feed a block of interleaved samples, in the range [-1, 1].
+    ///
+    /// The block contains `frame_count * channel_count` samples.
+    void feed(const float* samples, std::size_t frame_count);
+
+    /// Finish the analysis, having fed all of the track's audio.
+    loudness_analysis finish();
+
+private:
+    struct impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+/// The `key_analysis` struct holds the result of key detection by a
+/// `key_analyzer`.
+struct key_analysis
+{
+    /// The detected key, or `stdx::nullopt` if the track has no discernible
+    /// tonal content.
+    stdx::optional<musical_key> key;
+
+    /// The correlation, in the range [-1, 1], between the track's chroma and
+    /// the profile of the detected key.  Higher values indicate greater
+    /// confidence.
+    double strength = 0;
+};
+
+/// The `key_analyzer` class detects the musical key of a track from its PCM
+/// audio, supplied in blocks of any size.
+///
+/// Audio is low-pass filtered, decimated, and folded into a 12-bin chroma
+/// profile as it is fed in, which is then matched against major and minor key
+/// profiles.  Memory use is fixed, independent of track duration.
+///
+/// Instances are independent of one another, and so different tracks may be
+/// analysed concurrently on different threads.
+class DJINTEROP_PUBLIC key_analyzer
+{
+public:
+    /// Construct an analyzer for audio with the given sample rate and number
+    /// of interleaved channels.
+    ///
+    /// Throws `std::invalid_argument` if the sample rate is below 11025Hz.
+    key_analyzer(double sample_rate, int channel_count);
+
+    key_analyzer(key_analyzer&& other) noexcept;
+
+    ~key_analyzer();
+
+    key_analyzer& operator=(key_analyzer&& other) noexcept;
+
+    /// Feed a block of interleaved samples, in the range [-1, 1].
+    ///
+    /// The block contains `frame_count * channel_count` samples.
+    void feed(const float* samples, std::size_t frame_count);
+
+    /// Finish the analysis, having fed all of the track's audio.
+    key_analysis finish();
+
+private:
+    struct impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+/// The `waveform_analyzer` class generates a high-resolution waveform for a
+/// track from its PCM audio, supplied in blocks of any size.
+///
+/// The audio is split into low, mid and high frequency bands, and each
+/// waveform entry records the peak level of each band over the number of
+/// samples given by `enginelibrary::required_waveform_samples_per_entry()`.
+///
+/// Instances are independent of one another, and so different tracks may be
+/// analysed concurrently on different threads.
+class DJINTEROP_PUBLIC waveform_analyzer
+{
+public:
+    /// Construct an analyzer for audio with the given sample rate and number
+    /// of interleaved channels.
+    waveform_analyzer(double sample_rate, int channel_count);
+
+    waveform_analyzer(waveform_analyzer&& other) noexcept;
+
+    ~waveform_analyzer();
+
+    waveform_analyzer& operator=(waveform_analyzer&& other) noexcept;
+
+    /// Feed a block of interleaved samples, in the range [-1, 1].
+    ///
+    /// The block contains `frame_count * channel_count` samples.
+    void feed(const float* samples, std::size_t frame_count);
+
+    /// Finish the analysis, having fed all of the track's audio, and obtain
+    /// the waveform.
+    std::vector<waveform_entry> finish();
+
+private:
+    struct impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+/// The `batch_analysis_progress` struct describes the progress of a call to
+/// `database::analyze_tracks()`.
+struct batch_analysis_progress
+{
+    /// The ID of the track whose results have just been written.
+    int64_t track_id = 0;
+
+    /// The number of tracks finished so far, whether successfully or not.
+    std::size_t completed = 0;
+
+    /// The total number of tracks to be analysed.
+    std::size_t total = 0;
+};
+
+/// The `batch_analysis_failure` struct describes a track that could not be
+/// analysed by `database::analyze_tracks()`.
+struct batch_analysis_failure
+{
+    int64_t track_id = 0;
+    std::string reason;
+};
+
+/// The `batch_analysis_result` struct summarises a call to
+/// `database::analyze_tracks()`.
+struct batch_analysis_result
+{
+    /// The number of tracks that were analysed, and whose results were
+    /// written to the database.
+    std::size_t analyzed = 0;
+
+    /// The number of tracks that were not analysed, because their files are
+    /// not in a supported format.
+    std::size_t skipped = 0;
+
+    /// Tracks whose files could not be read or analysed.
+    std::vector<batch_analysis_failure> failures;
+
+    /// Whether the run was cancelled before all tracks were analysed.
+    bool cancelled = false;
+};
+
+/// The `batch_analysis_options` struct controls the behaviour of
+/// `database::analyze_tracks()`.
+struct batch_analysis_options
+{
+    /// The maximum number of threads of the database's executor to use, or
+    /// zero to use as many as the executor can usefully run.
+    std::size_t thread_count = 0;
+
+    /// The number of tracks whose results are written to the database in each
+    /// transaction.
+    std::size_t batch_size = 64;
+
+    /// Whether to replace a track's existing adjusted beatgrid with the
+    /// analysed one.  By default, an adjusted beatgrid is only written where
+    /// a track does not already have one, so that hand-made adjustments are
+    /// kept.
+    bool replace_adjusted_beatgrids = false;
+
+    /// A callback, invoked on the calling thread after the results for each
+    /// track have been written.
+    std::function<void(const batch_analysis_progress&)> on_progress;
+
+    /// An optional flag which, once set by any thread, causes the run to stop
+    /// as soon as possible.  Results already obtained are still written.
+    const std::atomic<bool>* cancel = nullptr;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_ANALYSIS_HPP
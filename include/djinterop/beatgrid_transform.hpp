@@ -0,0 +1,80 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_BEATGRID_TRANSFORM_HPP
+#define DJINTEROP_BEATGRID_TRANSFORM_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <functional>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/optional.hpp>
+#include <djinterop/performance_data.hpp>
+
+namespace djinterop
+{
+/// Selects which of a track's beatgrids are affected by a beatgrid transform.
+enum class beatgrid_target
+{
+    default_beatgrid,
+    adjusted_beatgrid,
+    both,
+};
+
+/// A transform applied to the beatgrids of a track by
+/// `database::transform_beatgrids()`.
+///
+/// The transform is given the track's sampling info, and may modify its
+/// default and adjusted beatgrids in place.  Transforms are invoked on worker
+/// threads, possibly concurrently, and so must be safe to call from multiple
+/// threads at once.
+using beatgrid_transform = std::function<void(
+    const stdx::optional<sampling_info>& sampling,
+    std::vector<beatgrid_marker>& default_beatgrid,
+    std::vector<beatgrid_marker>& adjusted_beatgrid)>;
+
+/// Make a transform that moves every marker of a beatgrid by a number of
+/// samples.
+beatgrid_transform DJINTEROP_PUBLIC shift_beatgrid(
+    double sample_offset, beatgrid_target target = beatgrid_target::both);
+
+/// Make a transform that rescales a beatgrid to a new tempo, keeping its first
+/// marker in place.
+///
+/// Tracks with no sampling info are left unchanged.
+beatgrid_transform DJINTEROP_PUBLIC rescale_beatgrid(
+    double bpm, beatgrid_target target = beatgrid_target::both);
+
+/// Make a transform that normalizes a beatgrid using
+/// `enginelibrary::normalize_beatgrid()`.
+///
+/// Tracks with no sampling info are left unchanged.
+beatgrid_transform DJINTEROP_PUBLIC
+normalize_beatgrid_transform(beatgrid_target target = beatgrid_target::both);
+
+/// Make a transform that replaces the adjusted beatgrid with a copy of the
+/// default beatgrid.
+beatgrid_transform DJINTEROP_PUBLIC copy_default_to_adjusted_beatgrid();
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_BEATGRID_TRANSFORM_HPP
@@ -0,0 +1,132 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_COROUTINE_HPP
+#define DJINTEROP_COROUTINE_HPP
+
+#include <djinterop/config.hpp>
+
+#if !defined DJINTEROP_COROUTINES || !defined __cpp_impl_coroutine
+#error Coroutine support needs a C++20 compiler, and a library built with it
+#endif
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <djinterop/database.hpp>
+#include <djinterop/executor.hpp>
+#include <djinterop/optional.hpp>
+#include <djinterop/track.hpp>
+#include <djinterop/track_snapshot.hpp>
+
+namespace djinterop
+{
+/// The `async_operation` class template is an awaitable that runs a function
+/// on the executor of a database, and resumes the awaiting coroutine once it
+/// has finished.
+///
+/// The function is only queued when the operation is awaited, and the
+/// awaiting coroutine is then suspended without blocking its thread.  The
+/// function is run with a database object for a connection of its own, after
+/// any operations on the same database that were awaited before it.  The
+/// awaiting coroutine is then resumed on a thread of the executor, with the
+/// result of the function, or with the exception that it threw.  Each
+/// operation may be awaited only once.
+template <typename T>
+class async_operation
+{
+public:
+    async_operation(database db, std::function<T(database&)> fn) :
+        db_{std::move(db)}, exec_{db_.task_executor()}, fn_{std::move(fn)}
+    {
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> awaiting)
+    {
+        // The resumed coroutine may destroy this operation, so nothing may be
+        // touched once resumption has been submitted.  Resumption is a task
+        // of its own, so that the coroutine does not hold up the operations
+        // queued after this one.
+        db_.submit_async([this, awaiting](database& connection) {
+            try
+            {
+                if constexpr (std::is_void_v<T>)
+                {
+                    fn_(connection);
+                }
+                else
+                {
+                    result_.emplace(fn_(connection));
+                }
+            }
+            catch (...)
+            {
+                error_ = std::current_exception();
+            }
+
+            auto exec = exec_;
+            exec->submit([awaiting] { awaiting.resume(); });
+        });
+    }
+
+    T await_resume()
+    {
+        if (error_)
+        {
+            std::rethrow_exception(error_);
+        }
+
+        if constexpr (!std::is_void_v<T>)
+        {
+            return std::move(*result_);
+        }
+    }
+
+private:
+    using result_type =
+        std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    database db_;
+    std::shared_ptr<executor> exec_;
+    std::function<T(database&)> fn_;
+    std::optional<result_type> result_;
+    std::exception_ptr error_;
+};
+
+template <typename F>
+auto database::run_async(F fn) const
+    -> async_operation<std::invoke_result_t<F&, database&> >
+{
+    using result_type = std::invoke_result_t<F&, database&>;
+    return async_operation<result_type>{*this, std::move(fn)};
+}
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_COROUTINE_HPP
@@ -21,6 +21,7 @@ Lesser General Public License for more details.
 #error This library needs at least a C++17 compliant compiler
 #endif
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -133,6 +134,13 @@ public:
     /// If no such crate is found, then `djinterop::nullopt` is returned.
     stdx::optional<crate> sub_crate_by_name(const std::string& name) const;
 
+    /// Returns the number of tracks contained in the crate
+    ///
+    /// Where the schema maintains a count of each crate's tracks, it is read
+    /// directly, and otherwise they are counted without creating a handle to
+    /// each one.
+    std::size_t track_count() const;
+
     /// Returns the crate's contained tracks
     std::vector<track> tracks() const;
 
@@ -23,12 +23,18 @@
 #error This library needs at least a C++17 compliant compiler
 #endif
 
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#include <djinterop/analysis.hpp>
+#include <djinterop/beatgrid_transform.hpp>
 #include <djinterop/config.hpp>
 #include <djinterop/optional.hpp>
 
@@ -36,11 +42,17 @@ namespace djinterop
 {
 class crate;
 class database_impl;
+class executor;
 struct semantic_version;
 class track;
 struct track_snapshot;
 class transaction_guard;
 
+#if defined DJINTEROP_COROUTINES && defined __cpp_impl_coroutine
+template <typename T>
+class async_operation;
+#endif
+
 class database_not_found : public std::runtime_error
 {
 public:
@@ -50,6 +62,355 @@ public:
     }
 };
 
+/// Selects the kinds of track data loaded by `database::prefetch()`.
+enum class prefetch_fields : uint32_t
+{
+    none = 0,
+
+    /// Core track attributes and metadata, such as title, artist, and BPM.
+    row = 1 << 0,
+
+    /// The decoded overview waveform.
+    overview_waveform = 1 << 1,
+
+    all = row | overview_waveform,
+};
+
+inline prefetch_fields operator|(prefetch_fields lhs, prefetch_fields rhs)
+{
+    return static_cast<prefetch_fields>(
+        static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs));
+}
+
+inline prefetch_fields operator&(prefetch_fields lhs, prefetch_fields rhs)
+{
+    return static_cast<prefetch_fields>(
+        static_cast<uint32_t>(lhs) & static_cast<uint32_t>(rhs));
+}
+
+/// The `backup_progress` struct describes the progress of
+/// `database::backup_to()`.
+struct backup_progress
+{
+    /// The name of the database file being copied, such as `m.db`.
+    std::string filename;
+
+    /// The number of pages of the file that have been copied.
+    std::size_t copied_pages;
+
+    /// The total number of pages in the file.
+    std::size_t total_pages;
+};
+
+/// The `backup_options` struct controls the behaviour of
+/// `database::backup_to()`.
+struct backup_options
+{
+    /// The number of pages copied in each step, or zero to copy each file in a
+    /// single step.
+    std::size_t pages_per_step = 64;
+
+    /// The time to sleep between steps, during which other connections may
+    /// use the database.
+    std::chrono::milliseconds step_interval{10};
+
+    /// Whether to skip the backup if the existing backup in the target
+    /// directory is of the same database, and its change log shows that
+    /// nothing has changed since.
+    ///
+    /// Only schema versions 1.17.0 and above have a change log.  For earlier
+    /// versions, the backup is never skipped.  Note that the change log
+    /// records changes to tracks and the ID sequences record inserted rows,
+    /// but neither records changes made by other software that delete rows
+    /// or replace them, such as string metadata.
+    bool skip_if_unchanged = false;
+
+    /// Callback invoked after each step.
+    std::function<void(const backup_progress&)> on_progress;
+};
+
+/// Selects how `database::checkpoint()` copies the contents of write-ahead
+/// logs back into the database files, mirroring the SQLite checkpoint modes.
+enum class checkpoint_mode
+{
+    /// Checkpoint as much as possible without waiting for other connections.
+    passive,
+
+    /// Wait for writers to finish, then checkpoint the whole log.
+    full,
+
+    /// As for `full`, and also wait for readers so that the log is restarted.
+    restart,
+
+    /// As for `restart`, and also truncate the log file to zero bytes.
+    truncate,
+};
+
+/// The `checkpoint_result` struct describes the outcome of checkpointing one
+/// of the files of a database.
+struct checkpoint_result
+{
+    /// The name of the database file, such as `m.db`.
+    std::string filename;
+
+    /// The number of frames in the write-ahead log, or -1 if the file is not
+    /// in WAL mode.
+    int log_frames;
+
+    /// The number of frames in the write-ahead log that have been copied back
+    /// into the database file, or -1 if the file is not in WAL mode.
+    int checkpointed_frames;
+
+    /// Whether the checkpoint could not be completed because another
+    /// connection was using the database.
+    bool busy;
+};
+
+/// The `checkpoint_options` struct controls how a database in WAL mode is
+/// checkpointed automatically.
+struct checkpoint_options
+{
+    /// The number of frames that a write-ahead log may hold before a
+    /// checkpoint is run automatically, or zero to disable automatic
+    /// checkpoints.
+    int auto_checkpoint_frames = 1000;
+
+    /// Whether automatic checkpoints are run in the background on the
+    /// database's executor, rather than by the commit that takes a log over
+    /// the threshold.
+    bool background = false;
+
+    /// The mode of automatic checkpoints run in the background.
+    /// Automatic checkpoints run by a commit are always passive.
+    checkpoint_mode background_mode = checkpoint_mode::passive;
+};
+
+/// The `bulk_update_options` struct controls the behaviour of operations that
+/// update many tracks at once, such as `database::regenerate_overviews()`.
+struct bulk_update_options
+{
+    /// The maximum number of threads of the database's executor to use, or
+    /// zero to use as many as the executor can usefully run.
+    std::size_t thread_count = 0;
+
+    /// The number of tracks whose data are written to the database in each
+    /// transaction.
+    std::size_t batch_size = 256;
+};
+
+/// Selects the positions to which cues are snapped by
+/// `database::quantize_cues()`.
+enum class quantize_resolution
+{
+    /// Snap to the nearest beat.
+    beat,
+
+    /// Snap to the nearest bar, taken as every fourth beat from beat index
+    /// zero.
+    bar,
+};
+
+/// The `export_progress` struct describes the progress of
+/// `database::export_to()` in writing to one of its targets.
+struct export_progress
+{
+    /// The index of the target directory.
+    std::size_t target;
+
+    /// The number of requested tracks that have been written to the target.
+    std::size_t completed;
+
+    /// The total number of requested tracks.
+    std::size_t total;
+};
+
+/// The `export_target_result` struct holds the outcome of
+/// `database::export_to()` for one of its targets.
+struct export_target_result
+{
+    /// The IDs of the tracks created in the target.
+    std::vector<int64_t> track_ids;
+
+    /// A description of the error that stopped the export to the target, if
+    /// any.
+    stdx::optional<std::string> error;
+};
+
+/// The `export_options` struct controls the behaviour of
+/// `database::export_to()`.
+struct export_options
+{
+    /// The number of tracks that are encoded together, and then written to
+    /// each target in a single transaction.
+    std::size_t batch_size = 64;
+
+    /// Callback invoked after each batch is written to a target.
+    ///
+    /// The callback may be invoked on any thread, but never concurrently.
+    std::function<void(const export_progress&)> on_progress;
+};
+
+/// The `imported_track_link` struct associates a track with the track in
+/// another database from which it was imported.
+struct imported_track_link
+{
+    /// The ID of the track in this database.
+    int64_t id;
+
+    /// The ID of the track in the other database.
+    int64_t source_id;
+};
+
+/// The `relink_options` struct controls the behaviour of
+/// `database::relink_tracks()`.
+struct relink_options
+{
+    /// The maximum number of threads of the database's executor to use in
+    /// checking and scanning for files, or zero to use as many as the executor
+    /// can usefully run.
+    std::size_t thread_count = 0;
+};
+
+/// The `relinked_track` struct describes a track whose file was found by
+/// `database::relink_tracks()`.
+struct relinked_track
+{
+    /// The ID of the track.
+    int64_t id;
+
+    /// The new path of the track, relative to the database directory.
+    std::string relative_path;
+};
+
+/// The `ambiguous_relink` struct describes a track for which
+/// `database::relink_tracks()` found more than one candidate file.
+struct ambiguous_relink
+{
+    /// The ID of the track.
+    int64_t id;
+
+    /// The paths of the candidate files, relative to the database directory.
+    std::vector<std::string> candidates;
+};
+
+/// The `relink_result` struct holds the outcome of
+/// `database::relink_tracks()`.
+struct relink_result
+{
+    /// The tracks whose paths were changed.
+    std::vector<relinked_track> relinked;
+
+    /// The missing tracks with several candidate files, which were left
+    /// unchanged.
+    std::vector<ambiguous_relink> ambiguous;
+
+    /// The IDs of the missing tracks with no candidate file.
+    std::vector<int64_t> unmatched;
+};
+
+/// The `folder_import_options` struct controls the behaviour of
+/// `database::import_folder_tree()`.
+struct folder_import_options
+{
+    /// The maximum number of threads of the database's executor to use in
+    /// scanning the folder tree, or zero to use as many as the executor can
+    /// usefully run.
+    std::size_t thread_count = 0;
+
+    /// The number of tracks that are created in each transaction.
+    std::size_t batch_size = 1024;
+
+    /// The extensions of the files to import, in lower case and without a
+    /// leading dot, or empty to import all files.
+    std::vector<std::string> extensions = {
+        "aif", "aiff", "alac", "flac", "m4a", "mp3", "mp4", "ogg", "wav"};
+};
+
+/// The `folder_import_result` struct holds the outcome of
+/// `database::import_folder_tree()`.
+struct folder_import_result
+{
+    /// The ID of the crate mirroring the root folder.
+    int64_t root_crate_id;
+
+    /// The IDs of the tracks that were created.
+    std::vector<int64_t> created_track_ids;
+
+    /// The number of imported files that matched an existing track.
+    std::size_t matched_track_count;
+
+    /// The number of crates that were created.
+    std::size_t created_crate_count;
+};
+
+/// Selects the fields of tracks fetched by `database::columns()`.
+enum class track_column
+{
+    album,
+    artist,
+    bpm,
+    duration,
+    genre,
+    key,
+    rating,
+    title,
+    year,
+};
+
+/// The `string_column` struct holds a dictionary-encoded column of strings.
+struct string_column
+{
+    /// The distinct values of the column, in ascending order.
+    std::vector<std::string> dictionary;
+
+    /// The index in the dictionary of the value of each track, or -1 if the
+    /// track has no value.
+    ///
+    /// As the dictionary is sorted, comparing codes orders tracks in the same
+    /// way as comparing their values.
+    std::vector<int32_t> codes;
+};
+
+/// The `track_columns` struct holds fields of many tracks as
+/// structure-of-arrays, as returned by `database::columns()`.
+///
+/// Every requested column has one entry per track, aligned with `ids`, and
+/// columns that were not requested are empty.  Missing floating-point values
+/// are NaN, and missing integer values are -1.
+struct track_columns
+{
+    /// The IDs of the tracks, in ascending order.
+    std::vector<int64_t> ids;
+
+    /// The BPM of each track.
+    std::vector<double> bpm;
+
+    /// The duration of each track in seconds, as recorded in whole seconds
+    /// by the database.
+    std::vector<double> duration;
+
+    /// The year of each track.
+    std::vector<int32_t> year;
+
+    /// The rating of each track, in the range 0 to 100.
+    std::vector<int32_t> rating;
+
+    /// The musical key of each track, as the value of its `musical_key`.
+    std::vector<int32_t> key;
+
+    /// The album of each track.
+    string_column album;
+
+    /// The artist of each track.
+    string_column artist;
+
+    /// The genre of each track.
+    string_column genre;
+
+    /// The title of each track.
+    string_column title;
+};
+
 class DJINTEROP_PUBLIC database
 {
 public:
@@ -62,8 +423,74 @@ public:
     /// Copy assignment operator
     database& operator=(const database& db);
 
+    /// Analyses all tracks that are missing performance data, and writes the
+    /// results to the database.
+    ///
+    /// A track is considered to be missing performance data if it has no
+    /// sampling information.  Its file is located relative to the database
+    /// directory, and must be an uncompressed WAV file.  Tracks are analysed
+    /// in parallel on the database's executor, each determining sampling
+    /// information, the waveform, average loudness, BPM and beatgrid.  Results
+    /// are written on the calling thread, in batches.
+    batch_analysis_result analyze_tracks(
+        const batch_analysis_options& options = {}) const;
+
+    /// Applies a delta package made by `create_delta_package()` to this
+    /// database.
+    ///
+    /// Each packaged track replaces the copy of the same track that an earlier
+    /// package made, or failing that, the track with the same relative path,
+    /// keeping its ID.  Other packaged tracks are added.  The packaged tracks
+    /// are added to the crates with the same names in which they are packaged,
+    /// creating any that do not exist.  The package's change log positions are
+    /// recorded in the `Pack` table, and its track mappings in the
+    /// `CopiedTrack` table.  All tracks are applied by set-based statements in
+    /// a single transaction, with the package attached to this database's
+    /// connection, and so this function must not be called while a
+    /// transaction is open.
+    ///
+    /// Only schema versions 1.17.0 and above are supported.  The number of
+    /// tracks applied is returned.
+    std::size_t apply_delta_package(const std::string& package_directory) const;
+
+    /// Copies the database into the given directory, using the SQLite online
+    /// backup API.
+    ///
+    /// The files of the database are copied a few pages at a time, sleeping
+    /// between steps, so that the database stays usable by other connections
+    /// while the backup is in progress.  Any existing backup in the directory
+    /// is replaced.  Returns true if a backup was made, or false if it was
+    /// skipped because nothing had changed.
+    bool backup_to(
+        const std::string& directory, const backup_options& options = {}) const;
+
     transaction_guard begin_transaction() const;
 
+    /// Checkpoints the write-ahead log of each file of the database.
+    ///
+    /// A result is returned for each file.  Files that are not in WAL mode,
+    /// such as those of a temporary in-memory database, are left untouched.
+    /// Any mode other than `checkpoint_mode::passive` may block until other
+    /// connections to the database have finished with it.
+    std::vector<checkpoint_result> checkpoint(
+        checkpoint_mode mode = checkpoint_mode::passive) const;
+
+    /// Returns an in-memory copy of the database.
+    ///
+    /// The copy is a fully functional database, but changes made to it do not
+    /// persist beyond its destruction, and do not affect this database.  It is
+    /// made using the SQLite online backup API, and so is much faster than
+    /// copying the files of the database and loading them.
+    database clone_to_memory() const;
+
+    /// Returns the given fields of every track in the database, as one
+    /// contiguous array per field.
+    ///
+    /// Each group of fields is read for all tracks by a single query, without
+    /// creating a handle or snapshot for any track, making this suitable for
+    /// sorting or analysing a whole library at once.
+    track_columns columns(const std::vector<track_column>& columns) const;
+
     /// Returns the crate with the given ID
     ///
     /// If no such crate exists in the database, then `djinterop::stdx::nullopt`
@@ -76,6 +503,33 @@ public:
     /// Returns all crates with the given name
     std::vector<crate> crates_by_name(const std::string& name) const;
 
+    /// Determines which of the crates with the given IDs exist.
+    ///
+    /// The IDs are checked together by a single query, rather than one query
+    /// per ID.  The results are given in the same order as the IDs.
+    std::vector<bool> crates_exist(const std::vector<int64_t>& ids) const;
+
+    /// Writes the tracks that have changed since they were last copied to the
+    /// existing database in the target directory into a new delta package, to
+    /// be applied to the target by `apply_delta_package()`.
+    ///
+    /// The package is a database of the same schema version, created in the
+    /// given package directory.  It holds every track that has changed since
+    /// the last package from this database was applied to the target, as
+    /// recorded in the target's `Pack` table, together with every track that
+    /// the target has no copy of, and the crates that those tracks are in.
+    /// Only changes recorded in the change logs are detected; in particular,
+    /// removals of tracks and crate memberships are not carried over.  The
+    /// tracks are chosen and copied by set-based statements, with the package
+    /// and the target attached to this database's connection, and so this
+    /// function must not be called while a transaction is open.
+    ///
+    /// Only schema versions 1.17.0 and above are supported.  The number of
+    /// tracks in the package is returned.
+    std::size_t create_delta_package(
+        const std::string& package_directory,
+        const std::string& target_directory) const;
+
     /// Creates a new root crate with the given name.
     ///
     /// The created crate has no parent.
@@ -90,10 +544,138 @@ public:
     /// This is the same as the directory passed to the `database` constructor.
     std::string directory() const;
 
+    /// Copies the given tracks into the existing databases in each of the
+    /// given directories.
+    ///
+    /// Each track is created in the targets as if by `create_track()` with a
+    /// snapshot of the track, but its rows and performance data are only
+    /// encoded once, however many targets there are.  Tracks are exported in
+    /// batches on the database's executor: each batch is written to every
+    /// target concurrently, each through its own connection, while the next
+    /// batch is read and encoded.  IDs of tracks that do not exist are
+    /// ignored.
+    ///
+    /// A target that fails to open or to be written is reported in its result,
+    /// and does not affect the others.  Batches already written to it remain.
+    /// The results are given in the same order as the directories.
+    std::vector<export_target_result> export_to(
+        const std::vector<std::string>& directories,
+        const std::vector<int64_t>& ids,
+        const export_options& options = {}) const;
+
+    /// Mirrors a folder tree of music files as a tree of crates.
+    ///
+    /// The root folder becomes a root crate of the same name, and each folder
+    /// beneath it that contains music files, directly or in its subfolders,
+    /// becomes a sub-crate of the crate of its parent folder.  Each file is
+    /// matched to an existing track with the same relative path, or else a
+    /// new track is created for it, and added to the crate of its folder.
+    /// Crates that already exist with the same path are reused.
+    ///
+    /// The folder tree is scanned in parallel.  New tracks are created in
+    /// batches, and all crates and crate memberships are then written with a
+    /// few set-based statements in a single transaction.  Folders whose
+    /// names are not valid crate names are skipped, together with their
+    /// contents.
+    folder_import_result import_folder_tree(
+        const std::string& root_directory,
+        const folder_import_options& options = {}) const;
+
+    /// Returns the tracks that are linked to tracks of the existing database
+    /// in the given directory, together with the IDs of those tracks.
+    ///
+    /// A track is linked to another database by its import information.  Links
+    /// to tracks that no longer exist in the other database are omitted.  All
+    /// links are resolved by a single query, with the music database of the
+    /// other database attached to this one's connection.  The results are
+    /// ordered by track ID.
+    std::vector<imported_track_link> imported_tracks(
+        const std::string& source_directory) const;
+
     /// Returns true iff the database version is supported by this version of
     /// `libdjinterop` or not
     bool is_supported() const;
 
+    /// Links each track to the track with the same relative path in the
+    /// existing database in the given directory, by setting its import
+    /// information.
+    ///
+    /// All tracks are linked by a single update, with the music database of
+    /// the other database attached to this one's connection, and so this
+    /// function must not be called while a transaction is open.  If several
+    /// tracks of the other database have the same path, the one with the
+    /// lowest ID is used.  Tracks without a counterpart are left unchanged.
+    /// The number of tracks whose import information was changed is returned.
+    std::size_t link_imported_tracks(
+        const std::string& source_directory) const;
+
+    /// Asynchronously loads data for the tracks with the given IDs into the
+    /// library's caches, so that later reads of that data do not need to
+    /// query or decode anything.
+    ///
+    /// This function returns immediately.  Loading is carried out at low
+    /// priority in the background on the database's executor, using a
+    /// separate connection to the database, in the order in which tracks are
+    /// requested.  Prefetched data is discarded as soon as the track is
+    /// modified through this database.  IDs of tracks that do not exist are
+    /// ignored.
+    ///
+    /// Prefetching has no effect on temporary in-memory databases.
+    void prefetch(
+        const std::vector<int64_t>& ids,
+        prefetch_fields fields = prefetch_fields::all) const;
+
+    /// Snaps the hot cues, loops and adjusted main cue of the given tracks to
+    /// the nearest beat or bar of each track's adjusted beatgrid, and writes
+    /// back any that have changed.
+    ///
+    /// Only the quick cues and loops data of each track are rewritten.  Tracks
+    /// without a usable adjusted beatgrid, and IDs of tracks that do not
+    /// exist, are ignored.  Loops shorter than the chosen resolution keep
+    /// their length.  Decoding and re-encoding run in parallel, and results
+    /// are written in batches.  The number of tracks whose cues or loops were
+    /// changed is returned.
+    std::size_t quantize_cues(
+        const std::vector<int64_t>& ids,
+        quantize_resolution resolution = quantize_resolution::beat,
+        const bulk_update_options& options = {}) const;
+
+    /// Recalculates the overview waveform of every track from its
+    /// high-resolution waveform, and writes back any that have changed.
+    ///
+    /// This repairs missing or stale overviews, such as those in libraries
+    /// written by other software.  Waveforms are decoded and reduced in
+    /// parallel, and results are written in batches.  The number of tracks
+    /// whose overviews were changed is returned.
+    std::size_t regenerate_overviews(
+        const bulk_update_options& options = {}) const;
+
+    /// Finds the files of tracks that are missing from their recorded paths
+    /// among the files in the given directories, and changes the paths of the
+    /// tracks to point to them.
+    ///
+    /// The directories are scanned recursively and in parallel, and files are
+    /// matched to missing tracks by filename and, where the database records
+    /// it, by file size.  A track with exactly one candidate file is relinked
+    /// to it, while tracks with several candidates are reported and left
+    /// unchanged.  All paths are changed in a single transaction.  Parts of
+    /// the directories that cannot be read are skipped.
+    relink_result relink_tracks(
+        const std::vector<std::string>& directories,
+        const relink_options& options = {}) const;
+
+    /// Applies a transform to the beatgrids of the given tracks, and writes
+    /// back any that have changed.
+    ///
+    /// Only the beat data of each track is rewritten; in particular, its BPM
+    /// is left unchanged.  The transform is applied in parallel, and results
+    /// are written in batches.  IDs of tracks that do not exist, or that have
+    /// no beat data, are ignored.  The number of tracks whose beatgrids were
+    /// changed is returned.
+    std::size_t transform_beatgrids(
+        const std::vector<int64_t>& ids, const beatgrid_transform& transform,
+        const bulk_update_options& options = {}) const;
+
     /// Returns the UUID of the database
     std::string uuid() const;
 
@@ -129,12 +711,40 @@ public:
     /// A root crate is a crate that has no parent.
     std::vector<crate> root_crates() const;
 
+    /// Sets how the write-ahead logs of a database in WAL mode are
+    /// checkpointed automatically.
+    ///
+    /// By default, SQLite checkpoints a log as part of whichever commit takes
+    /// it over the threshold, which adds to the latency of that commit.  With
+    /// `checkpoint_options::background` set, checkpoints are instead run in the
+    /// background on the database's executor, through a separate connection.
+    /// The options apply only to this database object, and background
+    /// checkpoints have no effect on temporary in-memory databases.
+    void set_checkpoint_options(const checkpoint_options& options) const;
+
+    /// Switches the files of the database into or out of write-ahead logging
+    /// mode.
+    ///
+    /// The journal mode is stored in the database files, and so persists
+    /// after the database is closed.  It cannot be changed within a
+    /// transaction, and has no effect on temporary in-memory databases.
+    void set_wal_mode(bool enabled) const;
+
+    /// Returns the executor on which the database's parallel and background
+    /// work is run.
+    std::shared_ptr<executor> task_executor() const;
+
     /// Returns the track with the given id
     ///
     /// If no such track exists in the database, then `djinterop::stdx::nullopt`
     /// is returned.
     stdx::optional<track> track_by_id(int64_t id) const;
 
+    /// Returns the number of tracks contained in the database
+    ///
+    /// The tracks are counted without creating a handle to each one.
+    std::size_t track_count() const;
+
     /// Returns all tracks whose `relative_path` attribute in the database
     /// matches the given string
     std::vector<track> tracks_by_relative_path(
@@ -143,6 +753,50 @@ public:
     /// Returns all tracks contained in the database
     std::vector<track> tracks() const;
 
+    /// Determines which of the tracks with the given IDs exist.
+    ///
+    /// The IDs are checked together by a single query, rather than one query
+    /// per ID.  The results are given in the same order as the IDs.
+    std::vector<bool> tracks_exist(const std::vector<int64_t>& ids) const;
+
+#if defined DJINTEROP_COROUTINES && defined __cpp_impl_coroutine
+    // The awaitable operations below need `<djinterop/coroutine.hpp>`.  Each
+    // runs on the database's executor, through a connection of its own and
+    // after any operations awaited before it, and so is never part of a
+    // transaction open on this object.  They need a database stored on disk,
+    // and throw `std::logic_error` for temporary in-memory databases.
+
+    /// Creates tracks from the given snapshots, in a single transaction.
+    async_operation<std::vector<track> > create_tracks_async(
+        std::vector<track_snapshot> snapshots) const;
+
+    /// Finds all tracks whose `relative_path` attribute in the database
+    /// matches the given string.
+    async_operation<std::vector<track> > find_tracks_async(
+        std::string relative_path) const;
+
+    /// Runs a function with a database object for the connection on which
+    /// awaitable operations are run.
+    ///
+    /// Tracks and crates obtained through that object belong to the
+    /// connection, and should not be used once the function has returned.
+    template <typename F>
+    auto run_async(F fn) const
+        -> async_operation<std::invoke_result_t<F&, database&> >;
+
+    /// Obtains a snapshot of the track with the given ID, or
+    /// `djinterop::stdx::nullopt` if no such track exists.
+    async_operation<stdx::optional<track_snapshot> > snapshot_async(
+        int64_t id) const;
+
+    /// Queues an operation to be run with a database object for the
+    /// connection on which awaitable operations are run.
+    ///
+    /// This is the building block of the awaitable operations, which should
+    /// be preferred.
+    void submit_async(std::function<void(database&)> operation) const;
+#endif
+
     // TODO (haslersn): non public?
     database(std::shared_ptr<database_impl> pimpl);
 
@@ -24,15 +24,25 @@
 #endif
 
 #include <djinterop/album_art.hpp>
+#include <djinterop/analysis.hpp>
+#include <djinterop/beatgrid_transform.hpp>
 #include <djinterop/crate.hpp>
 #include <djinterop/database.hpp>
 #include <djinterop/enginelibrary.hpp>
 #include <djinterop/exceptions.hpp>
+#include <djinterop/executor.hpp>
 #include <djinterop/musical_key.hpp>
 #include <djinterop/pad_color.hpp>
 #include <djinterop/performance_data.hpp>
+#include <djinterop/performance_data_codec.hpp>
+#include <djinterop/playback_data.hpp>
 #include <djinterop/semantic_version.hpp>
 #include <djinterop/track.hpp>
 #include <djinterop/track_snapshot.hpp>
+#include <djinterop/waveform_render.hpp>
+
+#if defined DJINTEROP_COROUTINES && defined __cpp_impl_coroutine
+#include <djinterop/coroutine.hpp>
+#endif
 
 #endif  // DJINTEROP_DJINTEROP_HPP
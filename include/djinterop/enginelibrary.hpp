@@ -25,11 +25,13 @@
 
 #include <array>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <djinterop/config.hpp>
 #include <djinterop/database.hpp>
+#include <djinterop/executor.hpp>
 #include <djinterop/pad_color.hpp>
 #include <djinterop/semantic_version.hpp>
 
@@ -104,6 +106,10 @@ constexpr const char* default_database_dir_name = "Engine Library";
 /// Gets a descriptive name for a given schema version.
 std::string DJINTEROP_PUBLIC version_name(const semantic_version& version);
 
+// All functions below that open a database accept an optional executor, on
+// which all of the parallel and background work of the returned database is
+// run.  If none is given, `default_executor()` is used.
+
 /// Creates a new, empty database in a directory using the schema version
 /// provided.
 ///
@@ -112,14 +118,16 @@ std::string DJINTEROP_PUBLIC version_name(const semantic_version& version);
 /// thrown.
 database DJINTEROP_PUBLIC create_database(
     const std::string& directory,
-    const semantic_version& schema_version = version_latest);
+    const semantic_version& schema_version = version_latest,
+    std::shared_ptr<executor> task_executor = {});
 
 /// Creates a new temporary database.
 ///
 /// Any changes made to the database will not be persisted anywhere, and will
 /// be lost upon destruction of the returned variable.
 database DJINTEROP_PUBLIC create_temporary_database(
-    const semantic_version& schema_version = version_latest);
+    const semantic_version& schema_version = version_latest,
+    std::shared_ptr<executor> task_executor = {});
 
 /// Creates a new database from a set of SQL scripts.
 ///
@@ -127,8 +135,12 @@ database DJINTEROP_PUBLIC create_temporary_database(
 /// of the form "<dbname>.db.sql", which will be read and used to hydrate
 /// SQLite databases with the name "<dbname>.db".  These hydrated SQLite
 /// databases are then loaded into the returned `database` object.
+///
+/// Each script is executed as a whole within a single transaction, and so may
+/// contain statements spanning multiple lines.
 database DJINTEROP_PUBLIC create_database_from_scripts(
-    const std::string& db_directory, const std::string& script_directory);
+    const std::string& db_directory, const std::string& script_directory,
+    std::shared_ptr<executor> task_executor = {});
 
 /// Create or load an Engine Library database in a given directory.
 ///
@@ -138,14 +150,15 @@ database DJINTEROP_PUBLIC create_database_from_scripts(
 /// to determine whether the database was created or merely loaded.
 database DJINTEROP_PUBLIC create_or_load_database(
     const std::string& directory, const semantic_version& schema_version,
-    bool& created);
+    bool& created, std::shared_ptr<executor> task_executor = {});
 
 /// Returns a boolean indicating whether an Engine Library already exists in a
 /// given directory.
 bool DJINTEROP_PUBLIC database_exists(const std::string& directory);
 
 /// Loads an Engine Library database from a given directory.
-database DJINTEROP_PUBLIC load_database(const std::string& directory);
+database DJINTEROP_PUBLIC load_database(
+    const std::string& directory, std::shared_ptr<executor> task_executor = {});
 
 /// Given an Engine Library database, returns the path to its m.db sqlite
 /// database file
@@ -0,0 +1,90 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_EXECUTOR_HPP
+#define DJINTEROP_EXECUTOR_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include <djinterop/config.hpp>
+
+namespace djinterop
+{
+/// The `executor` class is the interface through which the library runs all
+/// of its parallel and background work.
+///
+/// A host application may implement it in order to have that work scheduled
+/// on its own thread pool, and pass it when opening a database.  The library
+/// never blocks a task waiting for another task that has not yet started, and
+/// so it is safe to use a database from within a task run by its own
+/// executor.
+class DJINTEROP_PUBLIC executor
+{
+public:
+    virtual ~executor() = default;
+
+    /// Schedules a task to be run on any thread.
+    ///
+    /// The task must eventually be run, although it may be run on the calling
+    /// thread before `submit()` returns.  Tasks submitted by the library never
+    /// throw.
+    virtual void submit(std::function<void()> task) = 0;
+
+    /// Gets the number of tasks that the executor can usefully run at once.
+    virtual std::size_t concurrency() const = 0;
+};
+
+/// The `thread_pool_executor` class is an executor that runs tasks on a fixed
+/// number of threads owned by it.
+class DJINTEROP_PUBLIC thread_pool_executor : public executor
+{
+public:
+    /// Constructs a pool with the given number of threads, or one thread per
+    /// hardware thread if zero.
+    explicit thread_pool_executor(std::size_t thread_count = 0);
+
+    /// Runs any outstanding tasks, and then stops the threads of the pool.
+    ~thread_pool_executor() override;
+
+    thread_pool_executor(const thread_pool_executor&) = delete;
+    thread_pool_executor& operator=(const thread_pool_executor&) = delete;
+
+    void submit(std::function<void()> task) override;
+
+    std::size_t concurrency() const override;
+
+private:
+    struct impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+/// Gets the executor used by databases that are opened without one.
+///
+/// The default executor is a `thread_pool_executor` with one thread per
+/// hardware thread, shared by the whole process, and started on first use.
+std::shared_ptr<executor> DJINTEROP_PUBLIC default_executor();
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_EXECUTOR_HPP
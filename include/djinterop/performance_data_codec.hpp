@@ -0,0 +1,181 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_PERFORMANCE_DATA_CODEC_HPP
+#define DJINTEROP_PERFORMANCE_DATA_CODEC_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/musical_key.hpp>
+#include <djinterop/optional.hpp>
+#include <djinterop/performance_data.hpp>
+
+namespace djinterop
+{
+namespace enginelibrary
+{
+// The structs in this file mirror the BLOB columns of the `PerformanceData`
+// table, and can be used to read and write those BLOBs without a database.
+//
+// Each struct can be encoded to, and decoded from, a BLOB in two ways.  The
+// value-returning `encode()` and `decode()` are the simplest to use.  The
+// overloads taking an output parameter reuse its storage instead, which avoids
+// repeated allocations when processing many BLOBs in a loop.  All decoders
+// throw `std::invalid_argument` if the BLOB is malformed, in which case an
+// output parameter is left in a valid but unspecified state.
+
+/// The contents of the `beatData` BLOB.
+struct DJINTEROP_PUBLIC beat_data
+{
+    stdx::optional<sampling_info> sampling;
+    std::vector<beatgrid_marker> default_beatgrid;
+    std::vector<beatgrid_marker> adjusted_beatgrid;
+
+    friend bool operator==(
+        const beat_data& first, const beat_data& second) noexcept
+    {
+        return first.sampling == second.sampling &&
+               first.default_beatgrid == second.default_beatgrid &&
+               first.adjusted_beatgrid == second.adjusted_beatgrid;
+    }
+
+    std::vector<char> encode() const;
+    void encode(std::vector<char>& blob) const;
+    static beat_data decode(const std::vector<char>& compressed_data);
+    static void decode(const char* data, std::size_t size, beat_data& result);
+};
+
+/// The contents of the `highResolutionWaveFormData` BLOB.
+struct DJINTEROP_PUBLIC high_res_waveform_data
+{
+    double samples_per_entry = 0;
+    std::vector<waveform_entry> waveform;
+
+    friend bool operator==(
+        const high_res_waveform_data& first,
+        const high_res_waveform_data& second) noexcept
+    {
+        return first.samples_per_entry == second.samples_per_entry &&
+               first.waveform == second.waveform;
+    }
+
+    std::vector<char> encode() const;
+    void encode(std::vector<char>& blob) const;
+    static high_res_waveform_data decode(
+        const std::vector<char>& compressed_data);
+    static void decode(
+        const char* data, std::size_t size, high_res_waveform_data& result);
+};
+
+/// The contents of the `loops` BLOB.
+///
+/// Unlike the other BLOBs, loops are not compressed.
+struct DJINTEROP_PUBLIC loops_data
+{
+    std::array<stdx::optional<loop>, 8> loops;  // Don't use curly braces here!
+
+    friend bool operator==(
+        const loops_data& first, const loops_data& second) noexcept
+    {
+        return first.loops == second.loops;
+    }
+
+    std::vector<char> encode() const;
+    void encode(std::vector<char>& blob) const;
+    static loops_data decode(
+        const std::vector<char>& raw_data);  // not compressed
+    static void decode(const char* data, std::size_t size, loops_data& result);
+};
+
+/// The contents of the `overviewWaveFormData` BLOB.
+struct DJINTEROP_PUBLIC overview_waveform_data
+{
+    double samples_per_entry = 0;
+    std::vector<waveform_entry> waveform;
+
+    friend bool operator==(
+        const overview_waveform_data& first,
+        const overview_waveform_data& second) noexcept
+    {
+        return first.samples_per_entry == second.samples_per_entry &&
+               first.waveform == second.waveform;
+    }
+
+    std::vector<char> encode() const;
+    void encode(std::vector<char>& blob) const;
+    static overview_waveform_data decode(
+        const std::vector<char>& compressed_data);
+    static void decode(
+        const char* data, std::size_t size, overview_waveform_data& result);
+};
+
+/// The contents of the `quickCues` BLOB.
+struct DJINTEROP_PUBLIC quick_cues_data
+{
+    std::array<stdx::optional<hot_cue>, 8> hot_cues;
+    double adjusted_main_cue = 0;
+    double default_main_cue = 0;
+
+    friend bool operator==(
+        const quick_cues_data& first, const quick_cues_data& second) noexcept
+    {
+        return first.hot_cues == second.hot_cues &&
+               first.adjusted_main_cue == second.adjusted_main_cue &&
+               first.default_main_cue == second.default_main_cue;
+    }
+
+    std::vector<char> encode() const;
+    void encode(std::vector<char>& blob) const;
+    static quick_cues_data decode(const std::vector<char>& compressed_data);
+    static void decode(
+        const char* data, std::size_t size, quick_cues_data& result);
+};
+
+/// The contents of the `trackData` BLOB.
+struct DJINTEROP_PUBLIC track_data
+{
+    stdx::optional<sampling_info> sampling;
+    stdx::optional<double> average_loudness;  // range (0, 1]
+    stdx::optional<musical_key> key;
+
+    friend bool operator==(
+        const track_data& first, const track_data& second) noexcept
+    {
+        return first.sampling == second.sampling &&
+               first.average_loudness == second.average_loudness &&
+               first.key == second.key;
+    }
+
+    std::vector<char> encode() const;
+    void encode(std::vector<char>& blob) const;
+    static track_data decode(const std::vector<char>& compressed_data);
+    static void decode(const char* data, std::size_t size, track_data& result);
+};
+
+}  // namespace enginelibrary
+}  // namespace djinterop
+
+#endif  // DJINTEROP_PERFORMANCE_DATA_CODEC_HPP
@@ -0,0 +1,88 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_PLAYBACK_DATA_HPP
+#define DJINTEROP_PLAYBACK_DATA_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <djinterop/musical_key.hpp>
+#include <djinterop/optional.hpp>
+#include <djinterop/performance_data.hpp>
+
+namespace djinterop
+{
+/// The `playback_data` struct is an immutable bundle of all of the data that
+/// is required in order to load a track onto a deck for playback.
+///
+/// Instances are obtained via `track::load_for_playback()`.  The waveforms are
+/// held by shared pointer, so that copies of a bundle (for example, one per
+/// deck or per UI component) all share the same waveform payloads.
+struct playback_data
+{
+    /// The id of the track to which this data pertains.
+    const int64_t track_id;
+
+    /// The sampling info.
+    const stdx::optional<sampling_info> sampling;
+
+    /// The default beatgrid.
+    const std::vector<beatgrid_marker> default_beatgrid;
+
+    /// The adjusted beatgrid.
+    const std::vector<beatgrid_marker> adjusted_beatgrid;
+
+    /// The default main cue sample offset.
+    const stdx::optional<double> default_main_cue;
+
+    /// The adjusted main cue sample offset.
+    const stdx::optional<double> adjusted_main_cue;
+
+    /// The hot cues.
+    const std::array<stdx::optional<hot_cue>, 8> hot_cues;
+
+    /// The loops.
+    const std::array<stdx::optional<loop>, 8> loops;
+
+    /// The average loudness, as recorded in the track's performance data.
+    const stdx::optional<double> average_loudness;
+
+    /// The key, as recorded in the track's performance data.
+    const stdx::optional<musical_key> key;
+
+    /// The high-resolution waveform.
+    ///
+    /// The pointer is never null, but the waveform may be empty.
+    const std::shared_ptr<const std::vector<waveform_entry> > waveform;
+
+    /// The overview waveform.
+    ///
+    /// The pointer is never null, but the waveform may be empty.
+    const std::shared_ptr<const std::vector<waveform_entry> > overview_waveform;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_PLAYBACK_DATA_HPP
@@ -41,6 +41,7 @@ namespace djinterop
 {
 class database;
 class crate;
+struct playback_data;
 class track_impl;
 struct track_snapshot;
 
@@ -260,6 +261,14 @@ public:
         stdx::optional<std::chrono::system_clock::time_point> time) const;
     void set_last_played_at(std::chrono::system_clock::time_point time) const;
 
+    /// Load all of the data required to play the track on a deck.
+    ///
+    /// The performance data for the track is read from the database only once,
+    /// and its various parts are decoded concurrently.  This is considerably
+    /// faster than obtaining the same information via the individual getters
+    /// on this class.
+    playback_data load_for_playback() const;
+
     stdx::optional<loop> loop_at(int32_t index) const;
 
     void set_loop_at(int32_t index, stdx::optional<loop> l) const;
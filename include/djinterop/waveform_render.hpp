@@ -0,0 +1,91 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_WAVEFORM_RENDER_HPP
+#define DJINTEROP_WAVEFORM_RENDER_HPP
+
+#if __cplusplus < 201703L
+#error This library needs at least a C++17 compliant compiler
+#endif
+
+#include <cstdint>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/pad_color.hpp>
+#include <djinterop/performance_data.hpp>
+
+namespace djinterop
+{
+/// The `waveform_palette` struct holds the colours with which a waveform is
+/// rendered.
+///
+/// The alpha component of each band colour is combined with the opacity of
+/// each waveform point.
+struct waveform_palette
+{
+    pad_color background{0x00, 0x00, 0x00, 0xFF};
+    pad_color low{0x20, 0x40, 0xFF, 0xFF};
+    pad_color mid{0x40, 0xC0, 0x40, 0xFF};
+    pad_color high{0xFF, 0xFF, 0xFF, 0xFF};
+};
+
+/// The `waveform_tile` struct holds a rendered tile of a waveform.
+///
+/// A waveform rendered at a given zoom level is divided into tiles of a fixed
+/// width, numbered from zero at the start of the waveform.  A tile depends
+/// only on its index, the zoom level, its dimensions and the palette, and so
+/// tiles may be cached and reused as a waveform is scrolled.
+struct waveform_tile
+{
+    /// The index of the tile.
+    int64_t index = 0;
+
+    /// The number of waveform entries represented by each pixel column.
+    double entries_per_pixel = 0;
+
+    /// The width of the tile, in pixels.
+    int width = 0;
+
+    /// The height of the tile, in pixels.
+    int height = 0;
+
+    /// The pixels of the tile, in 8-bit RGBA format, row by row from the top.
+    ///
+    /// There are `4 * width * height` bytes in total.
+    std::vector<uint8_t> pixels;
+};
+
+/// Render a tile of a waveform.
+///
+/// Each pixel column of the tile represents `entries_per_pixel` waveform
+/// entries, of which the peak is taken for each band.  Each band is drawn as
+/// a bar centred vertically in the tile, with height proportional to its
+/// value, and the high band drawn over the mid band over the low band.
+/// Columns that fall beyond the end of the waveform are left as background.
+///
+/// An `std::invalid_argument` is thrown if `entries_per_pixel`, `width` or
+/// `height` are not positive, or if `index` is negative.
+waveform_tile DJINTEROP_PUBLIC render_waveform_tile(
+    const std::vector<waveform_entry>& waveform, double entries_per_pixel,
+    int64_t index, int width, int height,
+    const waveform_palette& palette = waveform_palette{});
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_WAVEFORM_RENDER_HPP
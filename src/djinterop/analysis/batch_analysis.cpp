@@ -0,0 +1,217 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "batch_analysis.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+#include <djinterop/optional.hpp>
+#include <djinterop/parallel.hpp>
+#include <djinterop/util.hpp>
+
+#include "wav_reader.hpp"
+
+namespace djinterop::analysis
+{
+namespace
+{
+/// Number of frames read from a file and fed to the analyzers at a time.
+constexpr std::size_t read_block_frames = 65536;
+
+struct job
+{
+    int64_t track_id;
+    std::string path;
+};
+
+struct track_result
+{
+    analysis_results results;
+    std::string error;
+};
+
+bool is_wav(const std::string& path)
+{
+    auto extension = get_file_extension(path);
+    if (!extension)
+    {
+        return false;
+    }
+
+    std::transform(
+        extension->begin(), extension->end(), extension->begin(),
+        [](unsigned char c) { return std::tolower(c); });
+    return *extension == "wav" || *extension == "wave";
+}
+
+track_result analyze_file(const job& j)
+{
+    track_result result{
+        analysis_results{
+            j.track_id, sampling_info{}, stdx::nullopt, stdx::nullopt, {}, {}},
+        std::string{}};
+    try
+    {
+        wav_reader reader{j.path};
+        auto sample_rate = reader.sample_rate();
+        auto channel_count = reader.channel_count();
+        beatgrid_analyzer beats{sample_rate, channel_count};
+        loudness_analyzer loudness{sample_rate, channel_count};
+        waveform_analyzer waveform{sample_rate, channel_count};
+
+        std::vector<float> block(read_block_frames * channel_count);
+        int64_t frame_count = 0;
+        while (auto frames = reader.read(block.data(), read_block_frames))
+        {
+            beats.feed(block.data(), frames);
+            loudness.feed(block.data(), frames);
+            waveform.feed(block.data(), frames);
+            frame_count += frames;
+        }
+
+        auto beats_analysis = beats.finish();
+        result.results.sampling = sampling_info{sample_rate, frame_count};
+        result.results.average_loudness = loudness.finish().average_loudness;
+        result.results.bpm = beats_analysis.bpm;
+        result.results.beatgrid = std::move(beats_analysis.beatgrid);
+        result.results.waveform = waveform.finish();
+    }
+    catch (const std::exception& e)
+    {
+        result.error = e.what();
+    }
+
+    return result;
+}
+
+}  // anonymous namespace
+
+batch_analysis_result analyze_tracks(
+    database_impl& db, executor& exec, const batch_analysis_options& options)
+{
+    batch_analysis_result summary;
+    auto cancelled = [&options] {
+        return options.cancel && options.cancel->load();
+    };
+
+    std::vector<job> jobs;
+    auto directory = db.directory();
+    for (auto& unanalyzed : db.unanalyzed_tracks())
+    {
+        if (!is_wav(unanalyzed.relative_path))
+        {
+            ++summary.skipped;
+            continue;
+        }
+
+        jobs.push_back(
+            job{unanalyzed.id, directory + "/" + unanalyzed.relative_path});
+    }
+
+    if (jobs.empty())
+    {
+        return summary;
+    }
+
+    // Files are analysed in rounds, in parallel on the executor, and the
+    // results of each round are then written on this thread.  Each round is
+    // big enough to keep the executor busy, but bounded so that the whole
+    // waveforms held by results do not pile up.
+    auto batch_size = std::max<std::size_t>(1, options.batch_size);
+    auto parallelism =
+        options.thread_count != 0 ? options.thread_count : exec.concurrency();
+    auto round_size = std::max(batch_size, parallelism);
+
+    std::size_t completed = 0;
+    std::vector<track_result> batch;
+    auto flush = [&] {
+        if (batch.empty())
+        {
+            return;
+        }
+
+        // The results of the whole batch are written in one transaction.
+        std::vector<analysis_results> successes;
+        for (auto& result : batch)
+        {
+            if (!result.error.empty())
+            {
+                summary.failures.push_back(batch_analysis_failure{
+                    result.results.id, result.error});
+            }
+            else
+            {
+                successes.push_back(std::move(result.results));
+            }
+        }
+
+        summary.analyzed += db.write_analysis_results(
+            successes, options.replace_adjusted_beatgrids);
+
+        if (options.on_progress)
+        {
+            for (auto& result : batch)
+            {
+                options.on_progress(batch_analysis_progress{
+                    result.results.id, ++completed, jobs.size()});
+            }
+        }
+        else
+        {
+            completed += batch.size();
+        }
+
+        batch.clear();
+    };
+
+    for (std::size_t next = 0; next < jobs.size() && !cancelled();)
+    {
+        auto end = std::min(jobs.size(), next + round_size);
+        std::vector<stdx::optional<track_result> > results(end - next);
+        parallel_for(exec, results.size(), parallelism, [&](std::size_t i) {
+            // Files not yet started when the run is cancelled are abandoned.
+            if (!cancelled())
+            {
+                results[i] = analyze_file(jobs[next + i]);
+            }
+        });
+        next = end;
+
+        for (auto& result : results)
+        {
+            if (!result)
+            {
+                continue;
+            }
+
+            batch.push_back(std::move(*result));
+            if (batch.size() >= batch_size)
+            {
+                flush();
+            }
+        }
+
+        flush();
+    }
+
+    summary.cancelled = completed < jobs.size();
+    return summary;
+}
+
+}  // namespace djinterop::analysis
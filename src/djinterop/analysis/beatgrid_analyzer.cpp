@@ -0,0 +1,300 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/analysis.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <djinterop/enginelibrary.hpp>
+
+#include "fft.hpp"
+
+namespace djinterop
+{
+namespace
+{
+/// Approximate number of onset envelope frames per second, before rounding
+/// the FFT size down to a power of two.
+constexpr double target_frame_rate = 43;
+
+/// Range of tempos that are considered.
+constexpr double min_bpm = 60;
+constexpr double max_bpm = 200;
+
+/// Centre and width, in octaves, of the prior over tempos, used to choose
+/// between tempos that are related by a simple ratio.
+constexpr double preferred_bpm = 120;
+constexpr double tempo_prior_octaves = 1.4;
+
+/// Gain applied before log compression of the magnitude spectrum.
+constexpr float compression_gain = 100;
+
+/// Range and step, in envelope frames, over which the beat period is refined.
+constexpr double period_search_range = 1;
+constexpr double period_search_step = 0.01;
+
+/// Linearly-interpolate the envelope at a fractional position.
+double interpolate(const std::vector<float>& envelope, double position)
+{
+    auto index = static_cast<std::size_t>(position);
+    auto frac = position - index;
+    return (1 - frac) * envelope[index] + frac * envelope[index + 1];
+}
+
+/// Get the mean envelope strength at a comb of positions, starting at a given
+/// phase and separated by a given period.
+double comb_score(
+    const std::vector<float>& envelope, double period, double phase)
+{
+    double sum = 0;
+    int64_t count = 0;
+    auto limit = static_cast<double>(envelope.size() - 1);
+    for (auto position = phase; position < limit; position += period)
+    {
+        sum += interpolate(envelope, position);
+        ++count;
+    }
+
+    return count > 0 ? sum / count : 0;
+}
+
+/// Subtract a moving average from the envelope, and half-wave rectify it, so
+/// that only onsets that stand out from their surroundings remain.
+void whiten(std::vector<float>& envelope, std::size_t radius)
+{
+    std::vector<double> prefix(envelope.size() + 1);
+    for (std::size_t i = 0; i < envelope.size(); ++i)
+    {
+        prefix[i + 1] = prefix[i] + envelope[i];
+    }
+
+    for (std::size_t i = 0; i < envelope.size(); ++i)
+    {
+        auto lo = i > radius ? i - radius : 0;
+        auto hi = std::min(envelope.size(), i + radius + 1);
+        auto mean = (prefix[hi] - prefix[lo]) / (hi - lo);
+        envelope[i] = std::max(0.0f, envelope[i] - static_cast<float>(mean));
+    }
+}
+
+}  // anonymous namespace
+
+struct beatgrid_analyzer::impl
+{
+    impl(double sample_rate, int channel_count) :
+        sample_rate{sample_rate}, channel_count{channel_count},
+        fft{analysis::floor_power_of_two(
+            static_cast<std::size_t>(sample_rate / target_frame_rate))},
+        hop{fft.size() / 2}, spectrum(fft.bin_count()),
+        previous_spectrum(fft.bin_count())
+    {
+    }
+
+    void process_frames()
+    {
+        auto size = fft.size();
+        auto bins = fft.bin_count();
+        while (pending.size() - pending_offset >= size)
+        {
+            fft.magnitudes(&pending[pending_offset], spectrum.data());
+            for (std::size_t i = 0; i < bins; ++i)
+            {
+                spectrum[i] = std::log1p(compression_gain * spectrum[i]);
+            }
+
+            // Spectral flux: the total increase in compressed magnitude.
+            float flux = 0;
+            for (std::size_t i = 0; i < bins; ++i)
+            {
+                flux += std::max(0.0f, spectrum[i] - previous_spectrum[i]);
+            }
+
+            envelope.push_back(envelope.empty() ? 0 : flux);
+            std::swap(spectrum, previous_spectrum);
+            pending_offset += hop;
+        }
+
+        pending.erase(pending.begin(), pending.begin() + pending_offset);
+        pending_offset = 0;
+    }
+
+    double sample_rate;
+    int channel_count;
+    analysis::real_fft fft;
+    std::size_t hop;
+    std::vector<float> pending;
+    std::size_t pending_offset = 0;
+    std::vector<float> spectrum;
+    std::vector<float> previous_spectrum;
+    std::vector<float> envelope;
+    int64_t sample_count = 0;
+};
+
+beatgrid_analyzer::beatgrid_analyzer(double sample_rate, int channel_count)
+{
+    if (sample_rate <= 0 || channel_count <= 0)
+    {
+        throw std::invalid_argument{
+            "Sample rate and channel count must be positive"};
+    }
+
+    // The smallest FFT, of two frames, must still span at least one frame at
+    // the target envelope frame rate.
+    if (sample_rate < 2 * target_frame_rate)
+    {
+        throw std::invalid_argument{
+            "Sample rate is too low for beatgrid analysis"};
+    }
+
+    pimpl_ = std::make_unique<impl>(sample_rate, channel_count);
+}
+
+beatgrid_analyzer::beatgrid_analyzer(beatgrid_analyzer&& other) noexcept =
+    default;
+
+beatgrid_analyzer::~beatgrid_analyzer() = default;
+
+beatgrid_analyzer& beatgrid_analyzer::operator=(
+    beatgrid_analyzer&& other) noexcept = default;
+
+void beatgrid_analyzer::feed(const float* samples, std::size_t frame_count)
+{
+    auto& p = *pimpl_;
+    auto offset = p.pending.size();
+    p.pending.resize(offset + frame_count);
+    auto gain = 1.0f / p.channel_count;
+    for (std::size_t i = 0; i < frame_count; ++i)
+    {
+        float sum = 0;
+        for (int c = 0; c < p.channel_count; ++c)
+        {
+            sum += samples[i * p.channel_count + c];
+        }
+
+        p.pending[offset + i] = gain * sum;
+    }
+
+    p.sample_count += static_cast<int64_t>(frame_count);
+    p.process_frames();
+}
+
+beatgrid_analysis beatgrid_analyzer::finish()
+{
+    auto& p = *pimpl_;
+    auto& envelope = p.envelope;
+    auto frame_rate = p.sample_rate / p.hop;
+    auto min_lag =
+        static_cast<std::size_t>(std::floor(frame_rate * 60 / max_bpm));
+    auto max_lag =
+        static_cast<std::size_t>(std::ceil(frame_rate * 60 / min_bpm));
+    if (envelope.size() < 4 * max_lag)
+    {
+        return beatgrid_analysis{};
+    }
+
+    whiten(envelope, static_cast<std::size_t>(frame_rate / 2));
+
+    // Coarse tempo: the autocorrelation of the envelope, weighted by a prior
+    // over tempos.
+    std::vector<double> scores(max_lag + 1);
+    for (auto lag = min_lag; lag <= max_lag; ++lag)
+    {
+        double sum = 0;
+        auto count = envelope.size() - lag;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            sum += envelope[i] * envelope[i + lag];
+        }
+
+        auto bpm = 60 * frame_rate / lag;
+        auto octaves = std::log2(bpm / preferred_bpm) / tempo_prior_octaves;
+        scores[lag] = std::exp(-0.5 * octaves * octaves) * sum / count;
+    }
+
+    auto best_lag = min_lag;
+    for (auto lag = min_lag; lag <= max_lag; ++lag)
+    {
+        if (scores[lag] > scores[best_lag])
+        {
+            best_lag = lag;
+        }
+    }
+
+    if (scores[best_lag] <= 0)
+    {
+        return beatgrid_analysis{};
+    }
+
+    // Fine tempo and phase: the comb of beats that best lines up with onsets
+    // across the whole track.
+    double best_period = best_lag;
+    double best_phase = 0;
+    double best_score = -1;
+    auto steps = static_cast<int>(period_search_range / period_search_step);
+    for (int step = -steps; step <= steps; ++step)
+    {
+        auto period = best_lag + step * period_search_step;
+        for (double phase = 0; phase < period; ++phase)
+        {
+            auto score = comb_score(envelope, period, phase);
+            if (score > best_score)
+            {
+                best_score = score;
+                best_period = period;
+                best_phase = phase;
+            }
+        }
+    }
+
+    // Refine the phase to a fraction of a frame.
+    if (best_phase >= 1)
+    {
+        auto before = comb_score(envelope, best_period, best_phase - 1);
+        auto after = comb_score(envelope, best_period, best_phase + 1);
+        auto denominator = before - 2 * best_score + after;
+        if (denominator < 0)
+        {
+            best_phase += 0.5 * (before - after) / denominator;
+        }
+    }
+
+    // Each envelope frame describes the onset at the centre of its window.
+    auto samples_per_beat = best_period * p.hop;
+    auto first_beat = std::fmod(
+        best_phase * p.hop + p.fft.size() / 2.0, samples_per_beat);
+    auto beat_count = static_cast<int32_t>(
+        std::floor((p.sample_count - first_beat) / samples_per_beat));
+    if (beat_count < 1)
+    {
+        return beatgrid_analysis{};
+    }
+
+    std::vector<beatgrid_marker> beatgrid{
+        beatgrid_marker{0, first_beat},
+        beatgrid_marker{
+            beat_count, first_beat + beat_count * samples_per_beat}};
+
+    beatgrid_analysis result;
+    result.bpm = 60 * p.sample_rate / samples_per_beat;
+    result.beatgrid =
+        enginelibrary::normalize_beatgrid(std::move(beatgrid), p.sample_count);
+    return result;
+}
+
+}  // namespace djinterop
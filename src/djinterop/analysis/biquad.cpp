@@ -0,0 +1,52 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "biquad.hpp"
+
+#include <cmath>
+
+namespace djinterop::analysis
+{
+namespace
+{
+constexpr double pi = 3.14159265358979323846;
+
+}  // anonymous namespace
+
+biquad make_low_pass(double sample_rate, double cutoff)
+{
+    auto w0 = 2 * pi * cutoff / sample_rate;
+    auto alpha = std::sin(w0) / std::sqrt(2.0);
+    auto cos_w0 = std::cos(w0);
+    auto a0 = 1 + alpha;
+    return biquad{
+        (1 - cos_w0) / 2 / a0, (1 - cos_w0) / a0, (1 - cos_w0) / 2 / a0,
+        -2 * cos_w0 / a0, (1 - alpha) / a0};
+}
+
+biquad make_high_pass(double sample_rate, double cutoff)
+{
+    auto w0 = 2 * pi * cutoff / sample_rate;
+    auto alpha = std::sin(w0) / std::sqrt(2.0);
+    auto cos_w0 = std::cos(w0);
+    auto a0 = 1 + alpha;
+    return biquad{
+        (1 + cos_w0) / 2 / a0, -(1 + cos_w0) / a0, (1 + cos_w0) / 2 / a0,
+        -2 * cos_w0 / a0, (1 - alpha) / a0};
+}
+
+}  // namespace djinterop::analysis
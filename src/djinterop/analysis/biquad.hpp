@@ -0,0 +1,51 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace djinterop::analysis
+{
+/// A biquad filter, in transposed direct form II.
+struct biquad
+{
+    double b0, b1, b2, a1, a2;
+    double z1 = 0;
+    double z2 = 0;
+
+    /// Filter a contiguous run of samples in place.
+    void process(float* samples, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            double in = samples[i];
+            double out = b0 * in + z1;
+            z1 = b1 * in - a1 * out + z2;
+            z2 = b2 * in - a2 * out;
+            samples[i] = static_cast<float>(out);
+        }
+    }
+};
+
+/// Make a second-order Butterworth low-pass filter.
+biquad make_low_pass(double sample_rate, double cutoff);
+
+/// Make a second-order Butterworth high-pass filter.
+biquad make_high_pass(double sample_rate, double cutoff);
+
+}  // namespace djinterop::analysis
@@ -0,0 +1,121 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fft.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace djinterop::analysis
+{
+namespace
+{
+constexpr double pi = 3.14159265358979323846;
+
+}  // anonymous namespace
+
+real_fft::real_fft(std::size_t size) :
+    size_{size}, window_(size), twiddle_re_(size / 2), twiddle_im_(size / 2),
+    bit_reversed_(size), re_(size), im_(size)
+{
+    if (size < 2 || (size & (size - 1)) != 0)
+    {
+        throw std::invalid_argument{"FFT size must be a power of two"};
+    }
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        window_[i] =
+            static_cast<float>(0.5 - 0.5 * std::cos(2 * pi * i / size));
+    }
+
+    for (std::size_t i = 0; i < size / 2; ++i)
+    {
+        twiddle_re_[i] = static_cast<float>(std::cos(2 * pi * i / size));
+        twiddle_im_[i] = static_cast<float>(-std::sin(2 * pi * i / size));
+    }
+
+    std::size_t bits = 0;
+    while ((std::size_t{1} << bits) < size)
+    {
+        ++bits;
+    }
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        std::size_t reversed = 0;
+        for (std::size_t b = 0; b < bits; ++b)
+        {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+
+        bit_reversed_[i] = reversed;
+    }
+}
+
+void real_fft::magnitudes(const float* input, float* output)
+{
+    for (std::size_t i = 0; i < size_; ++i)
+    {
+        re_[bit_reversed_[i]] = input[i] * window_[i];
+        im_[i] = 0;
+    }
+
+    // Iterative Cooley-Tukey butterflies.  The innermost loop runs over
+    // contiguous elements, so that it may be vectorised.
+    for (std::size_t half = 1; half < size_; half *= 2)
+    {
+        auto stride = size_ / (2 * half);
+        for (std::size_t start = 0; start < size_; start += 2 * half)
+        {
+            float* a_re = &re_[start];
+            float* a_im = &im_[start];
+            float* b_re = &re_[start + half];
+            float* b_im = &im_[start + half];
+            for (std::size_t k = 0; k < half; ++k)
+            {
+                auto w_re = twiddle_re_[k * stride];
+                auto w_im = twiddle_im_[k * stride];
+                auto t_re = b_re[k] * w_re - b_im[k] * w_im;
+                auto t_im = b_re[k] * w_im + b_im[k] * w_re;
+                b_re[k] = a_re[k] - t_re;
+                b_im[k] = a_im[k] - t_im;
+                a_re[k] += t_re;
+                a_im[k] += t_im;
+            }
+        }
+    }
+
+    auto scale = 2.0f / size_;
+    for (std::size_t i = 0; i < bin_count(); ++i)
+    {
+        output[i] = scale * std::sqrt(re_[i] * re_[i] + im_[i] * im_[i]);
+    }
+}
+
+std::size_t floor_power_of_two(std::size_t value)
+{
+    std::size_t result = 1;
+    while (result * 2 <= value)
+    {
+        result *= 2;
+    }
+
+    return result;
+}
+
+}  // namespace djinterop::analysis
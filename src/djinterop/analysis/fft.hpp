@@ -0,0 +1,60 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace djinterop::analysis
+{
+/// The `real_fft` class computes the magnitude spectrum of fixed-size frames
+/// of real-valued audio, after applying a Hann window.
+///
+/// The transform is an iterative radix-2 FFT over separate real and imaginary
+/// arrays, laid out so that the butterfly and windowing loops can be
+/// vectorised by the compiler.
+class real_fft
+{
+public:
+    /// Construct an FFT of the given size, which must be a power of two.
+    explicit real_fft(std::size_t size);
+
+    /// Get the size of the input frames.
+    std::size_t size() const noexcept { return size_; }
+
+    /// Get the number of bins in the output spectrum.
+    std::size_t bin_count() const noexcept { return size_ / 2 + 1; }
+
+    /// Compute the magnitude spectrum of `size()` input samples, writing
+    /// `bin_count()` values to the output.
+    void magnitudes(const float* input, float* output);
+
+private:
+    std::size_t size_;
+    std::vector<float> window_;
+    std::vector<float> twiddle_re_;
+    std::vector<float> twiddle_im_;
+    std::vector<std::size_t> bit_reversed_;
+    std::vector<float> re_;
+    std::vector<float> im_;
+};
+
+/// Get the largest power of two that does not exceed the given value.
+std::size_t floor_power_of_two(std::size_t value);
+
+}  // namespace djinterop::analysis
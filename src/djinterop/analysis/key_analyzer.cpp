@@ -0,0 +1,253 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/analysis.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+#include "biquad.hpp"
+#include "fft.hpp"
+
+namespace djinterop
+{
+namespace
+{
+/// Audio is decimated to at least this sample rate before analysis.
+constexpr double min_analysis_rate = 11025;
+
+/// Size of the FFT frames, in decimated samples.
+constexpr std::size_t fft_size = 8192;
+
+/// Range of frequencies that contribute to the chroma profile.
+constexpr double min_frequency = 65.4;    // C2
+constexpr double max_frequency = 2093.0;  // C7
+
+/// Key profiles, indexed by semitones above the tonic, as measured by
+/// Krumhansl and Kessler.
+constexpr std::array<double, 12> major_profile{
+    6.35, 2.23, 3.48, 2.33, 4.38, 4.09, 2.52, 5.19, 2.39, 3.66, 2.29, 2.88};
+constexpr std::array<double, 12> minor_profile{
+    6.33, 2.68, 3.52, 5.38, 2.60, 3.53, 2.54, 4.75, 3.98, 2.69, 3.34, 3.17};
+
+/// Pearson correlation between a chroma profile and a key profile rotated to
+/// the given tonic.
+double correlate(
+    const std::array<double, 12>& chroma, const std::array<double, 12>& profile,
+    int tonic)
+{
+    double chroma_mean = 0;
+    double profile_mean = 0;
+    for (int i = 0; i < 12; ++i)
+    {
+        chroma_mean += chroma[i] / 12;
+        profile_mean += profile[i] / 12;
+    }
+
+    double covariance = 0;
+    double chroma_variance = 0;
+    double profile_variance = 0;
+    for (int i = 0; i < 12; ++i)
+    {
+        auto c = chroma[(tonic + i) % 12] - chroma_mean;
+        auto p = profile[i] - profile_mean;
+        covariance += c * p;
+        chroma_variance += c * c;
+        profile_variance += p * p;
+    }
+
+    if (chroma_variance <= 0)
+    {
+        return 0;
+    }
+
+    return covariance / std::sqrt(chroma_variance * profile_variance);
+}
+
+/// Convert a tonic pitch class (C = 0) and mode to a `musical_key`.
+///
+/// The `musical_key` enumeration runs around the circle of fifths from C
+/// major, with each major key followed by its relative minor.
+musical_key to_musical_key(int tonic, bool is_minor)
+{
+    auto major_tonic = is_minor ? (tonic + 3) % 12 : tonic;
+    auto fifths = (major_tonic * 7) % 12;
+    return static_cast<musical_key>(2 * fifths + (is_minor ? 1 : 0));
+}
+
+}  // anonymous namespace
+
+struct key_analyzer::impl
+{
+    impl(double sample_rate, int channel_count) :
+        channel_count{channel_count},
+        decimation{std::max(
+            1, static_cast<int>(std::floor(sample_rate / min_analysis_rate)))},
+        fft{fft_size}, spectrum(fft.bin_count()),
+        bin_pitch_class(fft.bin_count(), -1)
+    {
+        auto analysis_rate = sample_rate / decimation;
+        for (auto& filter : anti_alias)
+        {
+            filter = analysis::make_low_pass(sample_rate, analysis_rate / 4);
+        }
+
+        for (std::size_t bin = 1; bin < fft.bin_count(); ++bin)
+        {
+            auto frequency = bin * analysis_rate / fft_size;
+            if (frequency >= min_frequency && frequency <= max_frequency)
+            {
+                // MIDI note 69 is A4 (440Hz), and MIDI note 60 is C4.
+                auto note = 69 + 12 * std::log2(frequency / 440);
+                bin_pitch_class[bin] =
+                    static_cast<int>(std::lround(note)) % 12;
+            }
+        }
+
+        frame.reserve(fft_size);
+    }
+
+    int channel_count;
+    int decimation;
+    analysis::real_fft fft;
+    std::array<analysis::biquad, 2> anti_alias;
+    std::vector<float> mono;
+    std::vector<float> frame;
+    std::vector<float> spectrum;
+    std::vector<int> bin_pitch_class;
+    std::array<double, 12> chroma{};
+    int decimation_phase = 0;
+};
+
+key_analyzer::key_analyzer(double sample_rate, int channel_count)
+{
+    if (sample_rate <= 0 || channel_count <= 0)
+    {
+        throw std::invalid_argument{
+            "Sample rate and channel count must be positive"};
+    }
+
+    // Below the minimum analysis rate, the anti-aliasing filter would cut off
+    // the upper end of the chroma range.
+    if (sample_rate < min_analysis_rate)
+    {
+        throw std::invalid_argument{"Sample rate is too low for key analysis"};
+    }
+
+    pimpl_ = std::make_unique<impl>(sample_rate, channel_count);
+}
+
+key_analyzer::key_analyzer(key_analyzer&& other) noexcept = default;
+
+key_analyzer::~key_analyzer() = default;
+
+key_analyzer& key_analyzer::operator=(key_analyzer&& other) noexcept =
+    default;
+
+void key_analyzer::feed(const float* samples, std::size_t frame_count)
+{
+    auto& p = *pimpl_;
+
+    // Down-mix and filter in bounded chunks, so that memory use does not
+    // depend on the size of the blocks fed in.
+    constexpr std::size_t chunk_size = 4096;
+    p.mono.resize(chunk_size);
+    auto gain = 1.0f / p.channel_count;
+    while (frame_count > 0)
+    {
+        auto count = std::min(frame_count, chunk_size);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            float sum = 0;
+            for (int c = 0; c < p.channel_count; ++c)
+            {
+                sum += samples[i * p.channel_count + c];
+            }
+
+            p.mono[i] = gain * sum;
+        }
+
+        for (auto& filter : p.anti_alias)
+        {
+            filter.process(p.mono.data(), count);
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (p.decimation_phase++ % p.decimation != 0)
+            {
+                continue;
+            }
+
+            p.frame.push_back(p.mono[i]);
+            if (p.frame.size() == fft_size)
+            {
+                p.fft.magnitudes(p.frame.data(), p.spectrum.data());
+                for (std::size_t bin = 0; bin < p.spectrum.size(); ++bin)
+                {
+                    if (p.bin_pitch_class[bin] >= 0)
+                    {
+                        p.chroma[p.bin_pitch_class[bin]] += p.spectrum[bin];
+                    }
+                }
+
+                // Successive frames overlap by half.
+                p.frame.erase(p.frame.begin(), p.frame.begin() + fft_size / 2);
+            }
+        }
+
+        p.decimation_phase %= p.decimation;
+        samples += count * p.channel_count;
+        frame_count -= count;
+    }
+}
+
+key_analysis key_analyzer::finish()
+{
+    auto& p = *pimpl_;
+    key_analysis result;
+    double total = 0;
+    for (auto value : p.chroma)
+    {
+        total += value;
+    }
+
+    if (total <= 0)
+    {
+        return result;
+    }
+
+    for (int tonic = 0; tonic < 12; ++tonic)
+    {
+        for (auto is_minor : {false, true})
+        {
+            auto strength = correlate(
+                p.chroma, is_minor ? minor_profile : major_profile, tonic);
+            if (!result.key || strength > result.strength)
+            {
+                result.key = to_musical_key(tonic, is_minor);
+                result.strength = strength;
+            }
+        }
+    }
+
+    return result;
+}
+
+}  // namespace djinterop
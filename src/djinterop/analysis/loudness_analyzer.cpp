@@ -0,0 +1,224 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/analysis.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "biquad.hpp"
+
+namespace djinterop
+{
+namespace
+{
+constexpr double pi = 3.14159265358979323846;
+
+/// Duration of each gating block step, in seconds, and the number of steps
+/// that make up one 400ms gating block.
+constexpr double step_duration = 0.1;
+constexpr std::size_t steps_per_block = 4;
+
+/// Gating thresholds, as defined by ITU-R BS.1770-4.
+constexpr double absolute_gate_lufs = -70;
+constexpr double relative_gate_lu = -10;
+
+using analysis::biquad;
+
+/// Make the first stage of the K-weighting filter, modelling the acoustic
+/// effect of the head.
+biquad make_high_shelf(double sample_rate)
+{
+    constexpr double f0 = 1681.974450955533;
+    constexpr double gain_db = 3.999843853973347;
+    constexpr double q = 0.7071752369554196;
+
+    auto k = std::tan(pi * f0 / sample_rate);
+    auto vh = std::pow(10.0, gain_db / 20);
+    auto vb = std::pow(vh, 0.4996667741545416);
+    auto a0 = 1 + k / q + k * k;
+    return biquad{
+        (vh + vb * k / q + k * k) / a0, 2 * (k * k - vh) / a0,
+        (vh - vb * k / q + k * k) / a0, 2 * (k * k - 1) / a0,
+        (1 - k / q + k * k) / a0};
+}
+
+/// Make the second stage of the K-weighting filter, a high-pass filter.
+biquad make_high_pass(double sample_rate)
+{
+    constexpr double f0 = 38.13547087602444;
+    constexpr double q = 0.5003270373238773;
+
+    auto k = std::tan(pi * f0 / sample_rate);
+    auto a0 = 1 + k / q + k * k;
+    return biquad{1, -2, 1, 2 * (k * k - 1) / a0, (1 - k / q + k * k) / a0};
+}
+
+double to_lufs(double mean_square)
+{
+    return -0.691 + 10 * std::log10(mean_square);
+}
+
+}  // anonymous namespace
+
+struct loudness_analyzer::impl
+{
+    impl(double sample_rate, int channel_count) :
+        channel_count{channel_count},
+        step_size{static_cast<std::size_t>(
+            std::lround(sample_rate * step_duration))},
+        channel_scratch(step_size)
+    {
+        for (int c = 0; c < channel_count; ++c)
+        {
+            filters.push_back(make_high_shelf(sample_rate));
+            filters.push_back(make_high_pass(sample_rate));
+        }
+    }
+
+    /// Filter and accumulate the energy of `count` frames from `samples`,
+    /// which does not exceed the remainder of the current step.
+    void accumulate(const float* samples, std::size_t count)
+    {
+        for (int c = 0; c < channel_count; ++c)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                channel_scratch[i] = samples[i * channel_count + c];
+            }
+
+            filters[2 * c].process(channel_scratch.data(), count);
+            filters[2 * c + 1].process(channel_scratch.data(), count);
+
+            float energy = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                energy += channel_scratch[i] * channel_scratch[i];
+            }
+
+            step_energy += energy;
+        }
+
+        step_fill += count;
+        if (step_fill == step_size)
+        {
+            step_energies.push_back(step_energy / step_size);
+            step_energy = 0;
+            step_fill = 0;
+        }
+    }
+
+    int channel_count;
+    std::size_t step_size;
+    std::vector<biquad> filters;
+    std::vector<float> channel_scratch;
+    std::vector<double> step_energies;
+    double step_energy = 0;
+    std::size_t step_fill = 0;
+};
+
+loudness_analyzer::loudness_analyzer(double sample_rate, int channel_count)
+{
+    if (sample_rate <= 0 || channel_count <= 0)
+    {
+        throw std::invalid_argument{
+            "Sample rate and channel count must be positive"};
+    }
+
+    // Each gating block step must span at least one frame.
+    if (std::lround(sample_rate * step_duration) == 0)
+    {
+        throw std::invalid_argument{
+            "Sample rate is too low for loudness analysis"};
+    }
+
+    pimpl_ = std::make_unique<impl>(sample_rate, channel_count);
+}
+
+loudness_analyzer::loudness_analyzer(loudness_analyzer&& other) noexcept =
+    default;
+
+loudness_analyzer::~loudness_analyzer() = default;
+
+loudness_analyzer& loudness_analyzer::operator=(
+    loudness_analyzer&& other) noexcept = default;
+
+void loudness_analyzer::feed(const float* samples, std::size_t frame_count)
+{
+    auto& p = *pimpl_;
+    while (frame_count > 0)
+    {
+        auto count = std::min(frame_count, p.step_size - p.step_fill);
+        p.accumulate(samples, count);
+        samples += count * p.channel_count;
+        frame_count -= count;
+    }
+}
+
+loudness_analysis loudness_analyzer::finish()
+{
+    auto& p = *pimpl_;
+
+    // Mean-square energy of each overlapping 400ms gating block.
+    std::vector<double> blocks;
+    for (std::size_t i = 0; i + steps_per_block <= p.step_energies.size(); ++i)
+    {
+        double sum = 0;
+        for (std::size_t j = 0; j < steps_per_block; ++j)
+        {
+            sum += p.step_energies[i + j];
+        }
+
+        blocks.push_back(sum / steps_per_block);
+    }
+
+    auto gated_mean = [&blocks](double threshold_lufs) {
+        double sum = 0;
+        std::size_t count = 0;
+        for (auto energy : blocks)
+        {
+            if (energy > 0 && to_lufs(energy) > threshold_lufs)
+            {
+                sum += energy;
+                ++count;
+            }
+        }
+
+        return count > 0 ? sum / count : 0.0;
+    };
+
+    auto absolute_mean = gated_mean(absolute_gate_lufs);
+    if (absolute_mean <= 0)
+    {
+        return loudness_analysis{};
+    }
+
+    auto relative_mean = gated_mean(to_lufs(absolute_mean) + relative_gate_lu);
+    if (relative_mean <= 0)
+    {
+        return loudness_analysis{};
+    }
+
+    loudness_analysis result;
+    result.integrated_loudness = to_lufs(relative_mean);
+    result.average_loudness =
+        std::min(1.0, std::pow(10.0, *result.integrated_loudness / 20));
+    return result;
+}
+
+}  // namespace djinterop
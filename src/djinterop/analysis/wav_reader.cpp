@@ -0,0 +1,311 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wav_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace djinterop::analysis
+{
+namespace
+{
+constexpr uint16_t format_pcm = 0x0001;
+constexpr uint16_t format_ieee_float = 0x0003;
+constexpr uint16_t format_extensible = 0xFFFE;
+
+uint16_t read_u16(const unsigned char* p)
+{
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t read_u32(const unsigned char* p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+[[noreturn]] void fail(const std::string& path, const std::string& reason)
+{
+    throw std::runtime_error{"Cannot read WAV file " + path + ": " + reason};
+}
+
+#if !defined(_WIN32)
+/// Map an entire file into memory for reading, returning null on failure.
+const unsigned char* map_file(const std::string& path, std::size_t& size)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat st;
+    void* mapping = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        size = static_cast<std::size_t>(st.st_size);
+        mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    // The file is read once, front to back.
+    ::madvise(mapping, size, MADV_SEQUENTIAL);
+    return static_cast<const unsigned char*>(mapping);
+}
+#endif
+
+}  // anonymous namespace
+
+wav_reader::wav_reader(const std::string& path) :
+    stream_{path, std::ios::binary}
+{
+    if (!stream_)
+    {
+        fail(path, "file cannot be opened");
+    }
+
+    unsigned char riff[12];
+    if (!stream_.read(reinterpret_cast<char*>(riff), sizeof riff) ||
+        std::memcmp(riff, "RIFF", 4) != 0 ||
+        std::memcmp(riff + 8, "WAVE", 4) != 0)
+    {
+        fail(path, "not a RIFF/WAVE file");
+    }
+
+    // Walk the chunks until the data chunk is found.
+    bool have_format = false;
+    uint16_t format = 0;
+    uint16_t bits_per_sample = 0;
+    std::size_t offset = sizeof riff;
+    std::size_t data_size = 0;
+    for (;;)
+    {
+        unsigned char header[8];
+        if (!stream_.read(reinterpret_cast<char*>(header), sizeof header))
+        {
+            fail(path, "no data chunk");
+        }
+
+        auto chunk_size = read_u32(header + 4);
+        offset += sizeof header;
+        if (std::memcmp(header, "fmt ", 4) == 0)
+        {
+            std::vector<unsigned char> fmt(std::max<uint32_t>(chunk_size, 16));
+            if (!stream_.read(reinterpret_cast<char*>(fmt.data()), chunk_size))
+            {
+                fail(path, "truncated format chunk");
+            }
+
+            format = read_u16(&fmt[0]);
+            channel_count_ = read_u16(&fmt[2]);
+            sample_rate_ = read_u32(&fmt[4]);
+            bits_per_sample = read_u16(&fmt[14]);
+            if (format == format_extensible && chunk_size >= 26)
+            {
+                // The sub-format GUID begins with the actual format code.
+                format = read_u16(&fmt[24]);
+            }
+
+            have_format = true;
+        }
+        else if (std::memcmp(header, "data", 4) == 0)
+        {
+            data_offset_ = offset;
+            data_size = chunk_size;
+            break;
+        }
+        else
+        {
+            stream_.seekg(chunk_size, std::ios::cur);
+        }
+
+        // Chunks are padded to an even number of bytes.
+        if (chunk_size % 2 != 0)
+        {
+            stream_.seekg(1, std::ios::cur);
+        }
+
+        offset += chunk_size + chunk_size % 2;
+    }
+
+    if (!have_format || channel_count_ <= 0 || sample_rate_ <= 0)
+    {
+        fail(path, "missing or invalid format chunk");
+    }
+
+    if (format == format_pcm && bits_per_sample == 8)
+    {
+        encoding_ = encoding::unsigned_8;
+    }
+    else if (format == format_pcm && bits_per_sample == 16)
+    {
+        encoding_ = encoding::signed_16;
+    }
+    else if (format == format_pcm && bits_per_sample == 24)
+    {
+        encoding_ = encoding::signed_24;
+    }
+    else if (format == format_pcm && bits_per_sample == 32)
+    {
+        encoding_ = encoding::signed_32;
+    }
+    else if (format == format_ieee_float && bits_per_sample == 32)
+    {
+        encoding_ = encoding::float_32;
+    }
+    else if (format == format_ieee_float && bits_per_sample == 64)
+    {
+        encoding_ = encoding::float_64;
+    }
+    else
+    {
+        fail(path, "unsupported sample format");
+    }
+
+    bytes_per_sample_ = bits_per_sample / 8;
+    auto bytes_per_frame = bytes_per_sample_ * channel_count_;
+
+#if !defined(_WIN32)
+    mapping_ = map_file(path, mapping_size_);
+    if (mapping_)
+    {
+        // Tolerate files whose data chunk claims to run past the end.
+        data_size = std::min(data_size, mapping_size_ - data_offset_);
+    }
+#endif
+
+    frame_count_ = static_cast<int64_t>(data_size / bytes_per_frame);
+}
+
+wav_reader::~wav_reader()
+{
+#if !defined(_WIN32)
+    if (mapping_)
+    {
+        ::munmap(const_cast<unsigned char*>(mapping_), mapping_size_);
+    }
+#endif
+}
+
+std::size_t wav_reader::read(float* output, std::size_t max_frames)
+{
+    auto frames = static_cast<std::size_t>(
+        std::min<int64_t>(max_frames, frame_count_ - frames_read_));
+    if (frames == 0)
+    {
+        return 0;
+    }
+
+    auto bytes_per_frame = bytes_per_sample_ * channel_count_;
+    auto sample_count = frames * channel_count_;
+    if (mapping_)
+    {
+        convert(
+            mapping_ + data_offset_ + frames_read_ * bytes_per_frame, output,
+            sample_count);
+    }
+    else
+    {
+        buffer_.resize(frames * bytes_per_frame);
+        stream_.read(reinterpret_cast<char*>(buffer_.data()), buffer_.size());
+        frames = static_cast<std::size_t>(stream_.gcount()) / bytes_per_frame;
+        sample_count = frames * channel_count_;
+        convert(buffer_.data(), output, sample_count);
+    }
+
+    frames_read_ += frames;
+    return frames;
+}
+
+void wav_reader::convert(
+    const unsigned char* input, float* output, std::size_t count)
+{
+    switch (encoding_)
+    {
+        case encoding::unsigned_8:
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                output[i] = (input[i] - 128) * (1.0f / 128);
+            }
+            break;
+
+        case encoding::signed_16:
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                auto value = static_cast<int16_t>(read_u16(input + 2 * i));
+                output[i] = value * (1.0f / 32768);
+            }
+            break;
+
+        case encoding::signed_24:
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const auto* p = input + 3 * i;
+                auto value = static_cast<int32_t>(
+                                 (static_cast<uint32_t>(p[0]) << 8) |
+                                 (static_cast<uint32_t>(p[1]) << 16) |
+                                 (static_cast<uint32_t>(p[2]) << 24)) >>
+                             8;
+                output[i] = value * (1.0f / 8388608);
+            }
+            break;
+
+        case encoding::signed_32:
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                auto value = static_cast<int32_t>(read_u32(input + 4 * i));
+                output[i] = value * (1.0f / 2147483648.0f);
+            }
+            break;
+
+        case encoding::float_32:
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                auto bits = read_u32(input + 4 * i);
+                std::memcpy(&output[i], &bits, sizeof bits);
+            }
+            break;
+
+        case encoding::float_64:
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                uint64_t bits = read_u32(input + 8 * i) |
+                                (uint64_t{read_u32(input + 8 * i + 4)} << 32);
+                double value;
+                std::memcpy(&value, &bits, sizeof bits);
+                output[i] = static_cast<float>(value);
+            }
+            break;
+    }
+}
+
+}  // namespace djinterop::analysis
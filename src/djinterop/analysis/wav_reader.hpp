@@ -0,0 +1,89 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace djinterop::analysis
+{
+/// The `wav_reader` class decodes uncompressed PCM audio from a WAV file into
+/// interleaved floating-point samples.
+///
+/// Integer PCM of 8, 16, 24 or 32 bits and IEEE floating-point PCM of 32 or 64
+/// bits are supported, including when described by `WAVE_FORMAT_EXTENSIBLE`.
+/// Where possible, the file is memory-mapped and samples are converted
+/// directly from the mapping.  Otherwise, the file is read in chunks.
+class wav_reader
+{
+public:
+    /// Open a WAV file, and read its header.
+    ///
+    /// A `std::runtime_error` is thrown if the file cannot be opened, or is
+    /// not a supported WAV file.
+    explicit wav_reader(const std::string& path);
+
+    ~wav_reader();
+
+    wav_reader(const wav_reader&) = delete;
+    wav_reader& operator=(const wav_reader&) = delete;
+
+    double sample_rate() const noexcept { return sample_rate_; }
+
+    int channel_count() const noexcept { return channel_count_; }
+
+    /// Get the total number of frames (samples per channel) in the file.
+    int64_t frame_count() const noexcept { return frame_count_; }
+
+    /// Read up to `max_frames` frames of interleaved samples into `output`,
+    /// returning the number of frames read.  Zero is returned at the end of
+    /// the file.
+    std::size_t read(float* output, std::size_t max_frames);
+
+private:
+    enum class encoding
+    {
+        unsigned_8,
+        signed_16,
+        signed_24,
+        signed_32,
+        float_32,
+        float_64,
+    };
+
+    void convert(const unsigned char* input, float* output, std::size_t count);
+
+    double sample_rate_ = 0;
+    int channel_count_ = 0;
+    int64_t frame_count_ = 0;
+    int64_t frames_read_ = 0;
+    encoding encoding_ = encoding::signed_16;
+    std::size_t bytes_per_sample_ = 0;
+
+    std::ifstream stream_;
+    std::vector<unsigned char> buffer_;
+
+    const unsigned char* mapping_ = nullptr;
+    std::size_t mapping_size_ = 0;
+    std::size_t data_offset_ = 0;
+};
+
+}  // namespace djinterop::analysis
@@ -0,0 +1,200 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/analysis.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+#include <djinterop/enginelibrary.hpp>
+
+#include "biquad.hpp"
+
+namespace djinterop
+{
+namespace
+{
+/// Crossover frequencies between the low, mid and high bands.
+constexpr double low_mid_crossover = 250;
+constexpr double mid_high_crossover = 2500;
+
+/// Block size, in frames, in which audio is filtered.
+constexpr std::size_t chunk_size = 4096;
+
+uint8_t to_point_value(float peak)
+{
+    return static_cast<uint8_t>(std::lround(255 * std::min(peak, 1.0f)));
+}
+
+float peak_of(const float* samples, std::size_t count)
+{
+    float peak = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        peak = std::max(peak, std::abs(samples[i]));
+    }
+
+    return peak;
+}
+
+}  // anonymous namespace
+
+struct waveform_analyzer::impl
+{
+    impl(double sample_rate, int channel_count) :
+        channel_count{channel_count},
+        samples_per_entry{static_cast<std::size_t>(
+            enginelibrary::required_waveform_samples_per_entry(sample_rate))},
+        low_filters{
+            analysis::make_low_pass(sample_rate, low_mid_crossover),
+            analysis::make_low_pass(sample_rate, low_mid_crossover)},
+        mid_filters{
+            analysis::make_high_pass(sample_rate, low_mid_crossover),
+            analysis::make_low_pass(sample_rate, mid_high_crossover)},
+        high_filters{
+            analysis::make_high_pass(sample_rate, mid_high_crossover),
+            analysis::make_high_pass(sample_rate, mid_high_crossover)}
+    {
+        if (samples_per_entry == 0)
+        {
+            throw std::invalid_argument{
+                "Sample rate is too low to generate a waveform"};
+        }
+
+        for (auto& band : bands)
+        {
+            band.resize(chunk_size);
+        }
+    }
+
+    void emit_entry()
+    {
+        waveform_entry entry;
+        entry.low.value = to_point_value(peaks[0]);
+        entry.mid.value = to_point_value(peaks[1]);
+        entry.high.value = to_point_value(peaks[2]);
+        waveform.push_back(entry);
+        peaks = {};
+        entry_fill = 0;
+    }
+
+    int channel_count;
+    std::size_t samples_per_entry;
+    std::array<analysis::biquad, 2> low_filters;
+    std::array<analysis::biquad, 2> mid_filters;
+    std::array<analysis::biquad, 2> high_filters;
+    std::array<std::vector<float>, 3> bands;
+    std::array<float, 3> peaks{};
+    std::size_t entry_fill = 0;
+    std::vector<waveform_entry> waveform;
+};
+
+waveform_analyzer::waveform_analyzer(double sample_rate, int channel_count)
+{
+    if (sample_rate <= 0 || channel_count <= 0)
+    {
+        throw std::invalid_argument{
+            "Sample rate and channel count must be positive"};
+    }
+
+    pimpl_ = std::make_unique<impl>(sample_rate, channel_count);
+}
+
+waveform_analyzer::waveform_analyzer(waveform_analyzer&& other) noexcept =
+    default;
+
+waveform_analyzer::~waveform_analyzer() = default;
+
+waveform_analyzer& waveform_analyzer::operator=(
+    waveform_analyzer&& other) noexcept = default;
+
+void waveform_analyzer::feed(const float* samples, std::size_t frame_count)
+{
+    auto& p = *pimpl_;
+    auto gain = 1.0f / p.channel_count;
+    while (frame_count > 0)
+    {
+        auto count = std::min(frame_count, chunk_size);
+        auto& low = p.bands[0];
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            float sum = 0;
+            for (int c = 0; c < p.channel_count; ++c)
+            {
+                sum += samples[i * p.channel_count + c];
+            }
+
+            low[i] = gain * sum;
+        }
+
+        std::copy(low.begin(), low.begin() + count, p.bands[1].begin());
+        std::copy(low.begin(), low.begin() + count, p.bands[2].begin());
+        for (auto& filter : p.low_filters)
+        {
+            filter.process(p.bands[0].data(), count);
+        }
+
+        for (auto& filter : p.mid_filters)
+        {
+            filter.process(p.bands[1].data(), count);
+        }
+
+        for (auto& filter : p.high_filters)
+        {
+            filter.process(p.bands[2].data(), count);
+        }
+
+        // Split the chunk at entry boundaries, and take the peak of each band
+        // over each piece.
+        std::size_t offset = 0;
+        while (offset < count)
+        {
+            auto piece =
+                std::min(count - offset, p.samples_per_entry - p.entry_fill);
+            for (std::size_t band = 0; band < 3; ++band)
+            {
+                p.peaks[band] = std::max(
+                    p.peaks[band], peak_of(&p.bands[band][offset], piece));
+            }
+
+            offset += piece;
+            p.entry_fill += piece;
+            if (p.entry_fill == p.samples_per_entry)
+            {
+                p.emit_entry();
+            }
+        }
+
+        samples += count * p.channel_count;
+        frame_count -= count;
+    }
+}
+
+std::vector<waveform_entry> waveform_analyzer::finish()
+{
+    auto& p = *pimpl_;
+    if (p.entry_fill > 0)
+    {
+        p.emit_entry();
+    }
+
+    return std::move(p.waveform);
+}
+
+}  // namespace djinterop
@@ -0,0 +1,115 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/beatgrid_transform.hpp>
+
+#include <stdexcept>
+#include <utility>
+
+#include <djinterop/enginelibrary.hpp>
+
+namespace djinterop
+{
+namespace
+{
+/// Make a transform that applies a function to each targeted beatgrid.
+template <typename F>
+beatgrid_transform for_each_target(beatgrid_target target, F f)
+{
+    return [target, f = std::move(f)](
+               const stdx::optional<sampling_info>& sampling,
+               std::vector<beatgrid_marker>& default_beatgrid,
+               std::vector<beatgrid_marker>& adjusted_beatgrid) {
+        if (target != beatgrid_target::adjusted_beatgrid)
+        {
+            f(sampling, default_beatgrid);
+        }
+
+        if (target != beatgrid_target::default_beatgrid)
+        {
+            f(sampling, adjusted_beatgrid);
+        }
+    };
+}
+
+}  // anonymous namespace
+
+beatgrid_transform shift_beatgrid(double sample_offset, beatgrid_target target)
+{
+    return for_each_target(
+        target, [sample_offset](
+                    const stdx::optional<sampling_info>&,
+                    std::vector<beatgrid_marker>& beatgrid) {
+            for (auto& marker : beatgrid)
+            {
+                marker.sample_offset += sample_offset;
+            }
+        });
+}
+
+beatgrid_transform rescale_beatgrid(double bpm, beatgrid_target target)
+{
+    if (bpm <= 0)
+    {
+        throw std::invalid_argument{"BPM must be positive"};
+    }
+
+    return for_each_target(
+        target, [bpm](
+                    const stdx::optional<sampling_info>& sampling,
+                    std::vector<beatgrid_marker>& beatgrid) {
+            if (!sampling || beatgrid.empty())
+            {
+                return;
+            }
+
+            auto samples_per_beat = 60 * sampling->sample_rate / bpm;
+            const auto first = beatgrid.front();
+            for (auto& marker : beatgrid)
+            {
+                marker.sample_offset = first.sample_offset +
+                                       (marker.index - first.index) *
+                                           samples_per_beat;
+            }
+        });
+}
+
+beatgrid_transform normalize_beatgrid_transform(beatgrid_target target)
+{
+    return for_each_target(
+        target, [](const stdx::optional<sampling_info>& sampling,
+                   std::vector<beatgrid_marker>& beatgrid) {
+            if (!sampling)
+            {
+                return;
+            }
+
+            beatgrid = enginelibrary::normalize_beatgrid(
+                std::move(beatgrid), sampling->sample_count);
+        });
+}
+
+beatgrid_transform copy_default_to_adjusted_beatgrid()
+{
+    return [](const stdx::optional<sampling_info>&,
+              std::vector<beatgrid_marker>& default_beatgrid,
+              std::vector<beatgrid_marker>& adjusted_beatgrid) {
+        adjusted_beatgrid = default_beatgrid;
+    };
+}
+
+}  // namespace djinterop
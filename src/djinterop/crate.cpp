@@ -105,6 +105,11 @@ stdx::optional<crate> crate::sub_crate_by_name(const std::string& name) const
     return pimpl_->sub_crate_by_name(name);
 }
 
+std::size_t crate::track_count() const
+{
+    return pimpl_->track_count();
+}
+
 std::vector<track> crate::tracks() const
 {
     return pimpl_->tracks();
@@ -17,6 +17,7 @@
 
 #include <sqlite_modern_cpp.h>
 
+#include <djinterop/analysis/batch_analysis.hpp>
 #include <djinterop/djinterop.hpp>
 #include <djinterop/enginelibrary/el_database_impl.hpp>
 #include <djinterop/enginelibrary/schema/schema.hpp>
@@ -24,6 +25,10 @@
 #include <djinterop/transaction_guard.hpp>
 #include <djinterop/util.hpp>
 
+#if defined DJINTEROP_COROUTINES && defined __cpp_impl_coroutine
+#include <djinterop/coroutine.hpp>
+#endif
+
 namespace djinterop
 {
 database::database(const database& db) = default;
@@ -32,11 +37,47 @@ database::~database() = default;
 
 database& database::operator=(const database& db) = default;
 
+batch_analysis_result database::analyze_tracks(
+    const batch_analysis_options& options) const
+{
+    return analysis::analyze_tracks(
+        *pimpl_, *pimpl_->task_executor(), options);
+}
+
+std::size_t database::apply_delta_package(
+    const std::string& package_directory) const
+{
+    return pimpl_->apply_delta_package(package_directory);
+}
+
+bool database::backup_to(
+    const std::string& directory, const backup_options& options) const
+{
+    return pimpl_->backup_to(directory, options);
+}
+
 transaction_guard database::begin_transaction() const
 {
     return pimpl_->begin_transaction();
 }
 
+std::vector<checkpoint_result> database::checkpoint(
+    checkpoint_mode mode) const
+{
+    return pimpl_->checkpoint(mode);
+}
+
+database database::clone_to_memory() const
+{
+    return pimpl_->clone_to_memory();
+}
+
+track_columns database::columns(
+    const std::vector<track_column>& columns) const
+{
+    return pimpl_->columns(columns);
+}
+
 stdx::optional<crate> database::crate_by_id(int64_t id) const
 {
     return pimpl_->crate_by_id(id);
@@ -52,6 +93,18 @@ std::vector<crate> database::crates_by_name(const std::string& name) const
     return pimpl_->crates_by_name(name);
 }
 
+std::vector<bool> database::crates_exist(const std::vector<int64_t>& ids) const
+{
+    return pimpl_->crates_exist(ids);
+}
+
+std::size_t database::create_delta_package(
+    const std::string& package_directory,
+    const std::string& target_directory) const
+{
+    return pimpl_->create_delta_package(package_directory, target_directory);
+}
+
 crate database::create_root_crate(std::string name) const
 {
     return pimpl_->create_root_crate(name);
@@ -67,11 +120,43 @@ std::string database::directory() const
     return pimpl_->directory();
 }
 
+std::vector<export_target_result> database::export_to(
+    const std::vector<std::string>& directories,
+    const std::vector<int64_t>& ids, const export_options& options) const
+{
+    return pimpl_->export_to(directories, ids, options);
+}
+
+folder_import_result database::import_folder_tree(
+    const std::string& root_directory,
+    const folder_import_options& options) const
+{
+    return pimpl_->import_folder_tree(root_directory, options);
+}
+
+std::vector<imported_track_link> database::imported_tracks(
+    const std::string& source_directory) const
+{
+    return pimpl_->imported_tracks(source_directory);
+}
+
 bool database::is_supported() const
 {
     return pimpl_->is_supported();
 }
 
+std::size_t database::link_imported_tracks(
+    const std::string& source_directory) const
+{
+    return pimpl_->link_imported_tracks(source_directory);
+}
+
+void database::prefetch(
+    const std::vector<int64_t>& ids, prefetch_fields fields) const
+{
+    pimpl_->prefetch(ids, fields);
+}
+
 void database::verify() const
 {
     pimpl_->verify();
@@ -98,22 +183,74 @@ stdx::optional<crate> database::root_crate_by_name(
     return pimpl_->root_crate_by_name(name);
 }
 
+void database::set_checkpoint_options(const checkpoint_options& options) const
+{
+    pimpl_->set_checkpoint_options(options);
+}
+
+void database::set_wal_mode(bool enabled) const
+{
+    pimpl_->set_wal_mode(enabled);
+}
+
+std::shared_ptr<executor> database::task_executor() const
+{
+    return pimpl_->task_executor();
+}
+
 stdx::optional<track> database::track_by_id(int64_t id) const
 {
     return pimpl_->track_by_id(id);
 }
 
+std::size_t database::track_count() const
+{
+    return pimpl_->track_count();
+}
+
 std::vector<track> database::tracks() const
 {
     return pimpl_->tracks();
 }
 
+std::vector<bool> database::tracks_exist(const std::vector<int64_t>& ids) const
+{
+    return pimpl_->tracks_exist(ids);
+}
+
 std::vector<track> database::tracks_by_relative_path(
     const std::string& relative_path) const
 {
     return pimpl_->tracks_by_relative_path(relative_path);
 }
 
+std::size_t database::quantize_cues(
+    const std::vector<int64_t>& ids, quantize_resolution resolution,
+    const bulk_update_options& options) const
+{
+    return pimpl_->quantize_cues(ids, resolution, options);
+}
+
+std::size_t database::regenerate_overviews(
+    const bulk_update_options& options) const
+{
+    return pimpl_->regenerate_overviews(options);
+}
+
+relink_result database::relink_tracks(
+    const std::vector<std::string>& directories,
+    const relink_options& options) const
+{
+    return pimpl_->relink_tracks(directories, options);
+}
+
+std::size_t database::transform_beatgrids(
+    const std::vector<int64_t>& ids, const beatgrid_transform& transform,
+    const bulk_update_options& options) const
+{
+    return pimpl_->transform_beatgrids(ids, transform, options);
+}
+
 std::string database::uuid() const
 {
     return pimpl_->uuid();
@@ -129,6 +266,65 @@ std::string database::version_name() const
     return pimpl_->version_name();
 }
 
+#if defined DJINTEROP_COROUTINES && defined __cpp_impl_coroutine
+async_operation<std::vector<track> > database::create_tracks_async(
+    std::vector<track_snapshot> snapshots) const
+{
+    // Tracks are handed back for this object's connection, rather than that
+    // of the operation.
+    return async_operation<std::vector<track> >{
+        *this, [pimpl = pimpl_, snapshots = std::move(snapshots)](
+                   database& connection) {
+            std::vector<int64_t> ids;
+            ids.reserve(snapshots.size());
+            auto trans = connection.begin_transaction();
+            for (auto&& snapshot : snapshots)
+            {
+                ids.push_back(connection.create_track(snapshot).id());
+            }
+
+            trans.commit();
+            return pimpl->track_handles(ids);
+        }};
+}
+
+async_operation<std::vector<track> > database::find_tracks_async(
+    std::string relative_path) const
+{
+    return async_operation<std::vector<track> >{
+        *this, [pimpl = pimpl_, relative_path = std::move(relative_path)](
+                   database& connection) {
+            std::vector<int64_t> ids;
+            for (auto&& tr : connection.tracks_by_relative_path(relative_path))
+            {
+                ids.push_back(tr.id());
+            }
+
+            return pimpl->track_handles(ids);
+        }};
+}
+
+async_operation<stdx::optional<track_snapshot> > database::snapshot_async(
+    int64_t id) const
+{
+    return async_operation<stdx::optional<track_snapshot> >{
+        *this, [id](database& connection) -> stdx::optional<track_snapshot> {
+            auto tr = connection.track_by_id(id);
+            if (!tr)
+            {
+                return stdx::nullopt;
+            }
+
+            return tr->snapshot();
+        }};
+}
+
+void database::submit_async(std::function<void(database&)> operation) const
+{
+    pimpl_->submit_async(std::move(operation));
+}
+#endif
+
 database::database(std::shared_ptr<database_impl> pimpl) :
     pimpl_{std::move(pimpl)}
 {
@@ -15,9 +15,16 @@
     along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cctype>
 #include <cmath>
 #include <fstream>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
+
+#include <sqlite3.h>
 
 #include <djinterop/djinterop.hpp>
 #include "enginelibrary/el_database_impl.hpp"
@@ -37,53 +44,127 @@ std::string version_name(const semantic_version& version)
 }
 
 database create_database(
-    const std::string& directory, const semantic_version& schema_version)
+    const std::string& directory, const semantic_version& schema_version,
+    std::shared_ptr<executor> task_executor)
 {
-    auto storage = std::make_shared<el_storage>(directory, schema_version);
+    auto storage = std::make_shared<el_storage>(
+        directory, schema_version, std::move(task_executor));
     return database{std::make_shared<el_database_impl>(storage)};
 }
 
-database create_temporary_database(const semantic_version& schema_version)
+database create_temporary_database(
+    const semantic_version& schema_version,
+    std::shared_ptr<executor> task_executor)
 {
-    auto storage = std::make_shared<el_storage>(schema_version);
+    auto storage =
+        std::make_shared<el_storage>(schema_version, std::move(task_executor));
     return database{std::make_shared<el_database_impl>(storage)};
 }
 
-database create_database_from_scripts(
-    const std::string& db_directory, const std::string& script_directory)
+namespace
+{
+/// Determines whether a SQL script opens its own transaction, by checking
+/// whether any complete statement within it starts with `BEGIN`.
+bool script_begins_transaction(const std::string& script)
 {
+    std::istringstream lines{script};
+    std::string line;
     std::string stmt;
+    while (std::getline(lines, line))
+    {
+        stmt += line;
+        stmt += '\n';
+        if (!sqlite3_complete(stmt.c_str()))
+        {
+            continue;
+        }
+
+        std::istringstream words{stmt};
+        std::string keyword;
+        words >> keyword;
+        std::transform(
+            keyword.begin(), keyword.end(), keyword.begin(),
+            [](unsigned char c) { return std::toupper(c); });
+        if (keyword == "BEGIN" || keyword == "BEGIN;")
+        {
+            return true;
+        }
+
+        stmt.clear();
+    }
 
-    std::ifstream m_db_script{script_directory + "/m.db.sql"};
-    sqlite::database m_db{db_directory + "/m.db"};
-    while (std::getline(m_db_script, stmt))
+    return false;
+}
+
+/// Executes a whole SQL script against a database in a single transaction.
+///
+/// Scripts produced by the `sqlite3` shell's `.dump` command already wrap
+/// their contents in a transaction; any other script is wrapped in one here.
+void execute_script(sqlite::database& db, const std::string& script_path)
+{
+    std::ifstream file{script_path};
+    if (!file)
+    {
+        throw std::runtime_error{"Unable to open SQL script " + script_path};
+    }
+
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    auto script = contents.str();
+    if (!script_begins_transaction(script))
+    {
+        script = "BEGIN;\n" + script + "\nCOMMIT;\n";
+    }
+
+    char* error_msg = nullptr;
+    auto rc = sqlite3_exec(
+        db.connection().get(), script.c_str(), nullptr, nullptr, &error_msg);
+    if (rc != SQLITE_OK)
+    {
+        std::string message =
+            error_msg != nullptr ? error_msg : sqlite3_errstr(rc);
+        sqlite3_free(error_msg);
+        if (!sqlite3_get_autocommit(db.connection().get()))
+        {
+            db << "ROLLBACK";
+        }
+
+        throw sqlite::sqlite_exception{message.c_str(), script_path, rc};
+    }
+}
+
+}  // namespace
+
+database create_database_from_scripts(
+    const std::string& db_directory, const std::string& script_directory,
+    std::shared_ptr<executor> task_executor)
+{
     {
-        m_db << stmt;
+        sqlite::database m_db{db_directory + "/m.db"};
+        execute_script(m_db, script_directory + "/m.db.sql");
     }
 
-    std::ifstream p_db_script{script_directory + "/p.db.sql"};
-    sqlite::database p_db{db_directory + "/p.db"};
-    while (std::getline(p_db_script, stmt))
     {
-        p_db << stmt;
+        sqlite::database p_db{db_directory + "/p.db"};
+        execute_script(p_db, script_directory + "/p.db.sql");
     }
 
-    return load_database(db_directory);
+    return load_database(db_directory, std::move(task_executor));
 }
 
 database create_or_load_database(
     const std::string& directory, const semantic_version& schema_version,
-    bool& created)
+    bool& created, std::shared_ptr<executor> task_executor)
 {
     try
     {
         created = false;
-        return load_database(directory);
+        return load_database(directory, task_executor);
     }
     catch (database_not_found& e)
     {
         created = true;
-        return create_database(directory, schema_version);
+        return create_database(directory, schema_version, task_executor);
     }
 }
 
@@ -101,9 +182,11 @@ bool database_exists(const std::string& directory)
     return true;
 }
 
-database load_database(const std::string& directory)
+database load_database(
+    const std::string& directory, std::shared_ptr<executor> task_executor)
 {
-    auto storage = std::make_shared<el_storage>(directory);
+    auto storage =
+        std::make_shared<el_storage>(directory, std::move(task_executor));
     return database{std::make_shared<el_database_impl>(storage)};
 }
 
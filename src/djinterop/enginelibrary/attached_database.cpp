@@ -0,0 +1,70 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/enginelibrary/attached_database.hpp>
+
+#include <tuple>
+#include <utility>
+
+#include <djinterop/exceptions.hpp>
+#include <djinterop/util.hpp>
+
+namespace djinterop::enginelibrary
+{
+attached_database::attached_database(
+    el_storage& storage, std::string schema, const std::string& directory,
+    const std::string& filename)
+    : storage_{storage}, schema_{std::move(schema)}
+{
+    if (!dir_exists(directory))
+    {
+        throw database_not_found{directory};
+    }
+
+    storage_.db << "ATTACH ? AS " + schema_ << (directory + "/" + filename);
+}
+
+attached_database::~attached_database()
+{
+    try
+    {
+        storage_.db << "DETACH " + schema_;
+    }
+    catch (...)
+    {
+        // The database is detached when the connection is closed anyway.
+    }
+}
+
+std::string attached_database::uuid()
+{
+    std::string uuid;
+    storage_.db << "SELECT uuid FROM " + schema_ + ".Information" >> uuid;
+    return uuid;
+}
+
+semantic_version attached_database::version()
+{
+    semantic_version version;
+    storage_.db << "SELECT schemaVersionMajor, schemaVersionMinor, "
+                   "schemaVersionPatch FROM " +
+                       schema_ + ".Information" >>
+        std::tie(version.maj, version.min, version.pat);
+    return version;
+}
+
+}  // namespace djinterop::enginelibrary
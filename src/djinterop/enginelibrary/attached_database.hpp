@@ -0,0 +1,61 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "el_storage.hpp"
+
+namespace djinterop::enginelibrary
+{
+/// The `attached_database` class attaches a database file to the connection
+/// of a storage under a given schema name, for as long as it lives.
+///
+/// Databases cannot be attached or detached while a transaction is open on
+/// the connection.
+class attached_database
+{
+public:
+    /// Attach a database file.
+    ///
+    /// A `database_not_found` exception is thrown if the directory holding the
+    /// file does not exist.
+    attached_database(
+        el_storage& storage, std::string schema, const std::string& directory,
+        const std::string& filename);
+
+    ~attached_database();
+
+    attached_database(const attached_database&) = delete;
+    attached_database& operator=(const attached_database&) = delete;
+
+    /// Get the schema name of the attached database.
+    const std::string& schema() const { return schema_; }
+
+    /// Read the UUID of the attached database.
+    std::string uuid();
+
+    /// Read the schema version of the attached database.
+    semantic_version version();
+
+private:
+    el_storage& storage_;
+    std::string schema_;
+};
+
+}  // namespace djinterop::enginelibrary
@@ -0,0 +1,200 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/enginelibrary/backup.hpp>
+
+#include <limits>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sqlite_modern_cpp.h>
+
+#include <djinterop/enginelibrary.hpp>
+#include <djinterop/util.hpp>
+
+namespace djinterop::enginelibrary
+{
+namespace
+{
+/// An attached database, and the name of its file.
+struct schema_file
+{
+    const char* schema;
+    const char* filename;
+};
+
+/// The identity of a database and the state of its change log.
+struct change_log_state
+{
+    std::string uuid;
+    std::vector<std::pair<std::string, int64_t> > sequences;
+
+    friend bool operator==(
+        const change_log_state& first, const change_log_state& second) noexcept
+    {
+        return first.uuid == second.uuid &&
+               first.sequences == second.sequences;
+    }
+};
+
+/// Read the change log state of one database of a connection.
+///
+/// Updates are recorded by triggers in the `ChangeLog` table, and insertions
+/// advance the ID sequences of their tables.  Since sequences only ever
+/// increase, they identify the latest change even after old change log entries
+/// are removed.
+change_log_state read_change_log_state(
+    sqlite::database& db, const std::string& schema)
+{
+    change_log_state state;
+    db << ("SELECT uuid FROM " + schema + ".Information") >> state.uuid;
+    db << ("SELECT name, seq FROM " + schema +
+           ".sqlite_sequence ORDER BY name") >>
+        [&](std::string name, int64_t seq) {
+            state.sequences.emplace_back(std::move(name), seq);
+        };
+    return state;
+}
+
+/// Determine whether the backup in a directory is of the given storage, and
+/// has not fallen behind it.
+bool is_backup_up_to_date(el_storage& storage, const std::string& directory)
+{
+    if (storage.version < version_1_17_0 || !dir_exists(directory))
+    {
+        return false;
+    }
+
+    try
+    {
+        auto backup =
+            std::make_unique<el_storage>(directory, storage.task_executor);
+        if (backup->version != storage.version)
+        {
+            return false;
+        }
+
+        for (auto schema : {"music", "perfdata"})
+        {
+            if (!(read_change_log_state(storage.db, schema) ==
+                  read_change_log_state(backup->db, schema)))
+            {
+                return false;
+            }
+        }
+    }
+    catch (const std::exception&)
+    {
+        // A missing or unreadable backup is simply out of date.
+        return false;
+    }
+
+    return true;
+}
+
+}  // namespace
+
+void backup_schema(
+    sqlite3* source, const char* source_name, sqlite3* destination,
+    const char* destination_name, std::size_t pages_per_step,
+    std::chrono::milliseconds step_interval,
+    const std::function<void(std::size_t, std::size_t)>& on_step)
+{
+    auto backup =
+        sqlite3_backup_init(destination, destination_name, source, source_name);
+    if (!backup)
+    {
+        sqlite::errors::throw_sqlite_error(sqlite3_errcode(destination));
+    }
+
+    auto step_pages =
+        pages_per_step == 0 ||
+                pages_per_step > std::numeric_limits<int>::max()
+            ? -1
+            : static_cast<int>(pages_per_step);
+    int rc;
+    for (;;)
+    {
+        rc = sqlite3_backup_step(backup, step_pages);
+        if (rc != SQLITE_OK && rc != SQLITE_DONE && rc != SQLITE_BUSY &&
+            rc != SQLITE_LOCKED)
+        {
+            break;
+        }
+
+        if (on_step)
+        {
+            auto total = sqlite3_backup_pagecount(backup);
+            auto remaining = sqlite3_backup_remaining(backup);
+            on_step(total - remaining, total);
+        }
+
+        if (rc == SQLITE_DONE)
+        {
+            break;
+        }
+
+        std::this_thread::sleep_for(step_interval);
+    }
+
+    // Finishing releases the backup even if it failed, and reports the error
+    // of the last step, if any.
+    rc = sqlite3_backup_finish(backup);
+    if (rc != SQLITE_OK)
+    {
+        sqlite::errors::throw_sqlite_error(rc);
+    }
+}
+
+bool backup_storage(
+    el_storage& storage, const std::string& directory,
+    const backup_options& options)
+{
+    if (options.skip_if_unchanged && is_backup_up_to_date(storage, directory))
+    {
+        return false;
+    }
+
+    if (!dir_exists(directory))
+    {
+        // Note: only creates leaf directory, not entire tree.
+        create_dir(directory);
+    }
+
+    for (auto file : {schema_file{"music", "m.db"},
+                      schema_file{"perfdata", "p.db"}})
+    {
+        sqlite::database destination{directory + "/" + file.filename};
+        backup_schema(
+            storage.db.connection().get(), file.schema,
+            destination.connection().get(), "main", options.pages_per_step,
+            options.step_interval,
+            [&](std::size_t copied, std::size_t total) {
+                if (options.on_progress)
+                {
+                    options.on_progress(
+                        backup_progress{file.filename, copied, total});
+                }
+            });
+    }
+
+    return true;
+}
+
+}  // namespace djinterop::enginelibrary
@@ -0,0 +1,54 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include <sqlite3.h>
+
+#include <djinterop/database.hpp>
+
+#include "el_storage.hpp"
+
+namespace djinterop::enginelibrary
+{
+/// Copy one database of a connection into another, using the SQLite online
+/// backup API.
+///
+/// At most `pages_per_step` pages are copied at a time, or all of them if it is
+/// zero, sleeping for `step_interval` between steps.  Steps that find the
+/// source locked are retried after the same interval.  The callback, if any,
+/// is invoked after each step with the number of pages copied so far and the
+/// total number of pages.
+void backup_schema(
+    sqlite3* source, const char* source_name, sqlite3* destination,
+    const char* destination_name, std::size_t pages_per_step,
+    std::chrono::milliseconds step_interval,
+    const std::function<void(std::size_t, std::size_t)>& on_step = {});
+
+/// Copy the databases of a storage into the files of a directory.
+///
+/// See `database::backup_to()` for details.
+bool backup_storage(
+    el_storage& storage, const std::string& directory,
+    const backup_options& options);
+
+}  // namespace djinterop::enginelibrary
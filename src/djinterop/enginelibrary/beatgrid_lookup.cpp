@@ -0,0 +1,83 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/enginelibrary/beatgrid_lookup.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace djinterop::enginelibrary
+{
+namespace
+{
+/// Linearly interpolate a value in one sorted sequence to the corresponding
+/// value in another.
+double interpolate(
+    const std::vector<double>& from, const std::vector<double>& to,
+    double value)
+{
+    auto upper = std::upper_bound(from.begin() + 1, from.end() - 1, value);
+    auto i = static_cast<std::size_t>(upper - from.begin()) - 1;
+    return to[i] +
+           (value - from[i]) * (to[i + 1] - to[i]) / (from[i + 1] - from[i]);
+}
+
+}  // anonymous namespace
+
+beatgrid_lookup::beatgrid_lookup(const std::vector<beatgrid_marker>& beatgrid)
+{
+    if (beatgrid.size() < 2)
+    {
+        throw std::invalid_argument{
+            "Beatgrid must have at least two markers"};
+    }
+
+    indexes_.reserve(beatgrid.size());
+    sample_offsets_.reserve(beatgrid.size());
+    for (auto& marker : beatgrid)
+    {
+        if (!indexes_.empty() &&
+            (marker.index <= indexes_.back() ||
+             marker.sample_offset <= sample_offsets_.back()))
+        {
+            throw std::invalid_argument{
+                "Beatgrid markers must be strictly increasing"};
+        }
+
+        indexes_.push_back(marker.index);
+        sample_offsets_.push_back(marker.sample_offset);
+    }
+}
+
+double beatgrid_lookup::beat_at(double sample_offset) const
+{
+    return interpolate(sample_offsets_, indexes_, sample_offset);
+}
+
+double beatgrid_lookup::sample_offset_of(double beat) const
+{
+    return interpolate(indexes_, sample_offsets_, beat);
+}
+
+double beatgrid_lookup::quantize(double sample_offset, int beats_per_step) const
+{
+    auto steps = std::round(beat_at(sample_offset) / beats_per_step);
+    return sample_offset_of(steps * beats_per_step);
+}
+
+}  // namespace djinterop::enginelibrary
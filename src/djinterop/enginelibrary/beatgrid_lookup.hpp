@@ -0,0 +1,57 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <djinterop/performance_data.hpp>
+
+namespace djinterop::enginelibrary
+{
+/// The `beatgrid_lookup` class converts between sample offsets and beat
+/// positions on a beatgrid.
+///
+/// The markers of the beatgrid are unpacked once on construction, so that
+/// each subsequent lookup is a binary search.  Positions before the first
+/// marker or after the last are extrapolated from the nearest pair.
+class beatgrid_lookup
+{
+public:
+    /// Construct from a beatgrid.
+    ///
+    /// An `std::invalid_argument` is thrown if the beatgrid has fewer than two
+    /// markers, or if its markers are not strictly increasing in both index
+    /// and sample offset.
+    explicit beatgrid_lookup(const std::vector<beatgrid_marker>& beatgrid);
+
+    /// Get the fractional beat index at a given sample offset.
+    double beat_at(double sample_offset) const;
+
+    /// Get the sample offset of a given fractional beat index.
+    double sample_offset_of(double beat) const;
+
+    /// Snap a sample offset to the nearest beat whose index is a multiple of
+    /// `beats_per_step`.
+    double quantize(double sample_offset, int beats_per_step) const;
+
+private:
+    std::vector<double> indexes_;
+    std::vector<double> sample_offsets_;
+};
+
+}  // namespace djinterop::enginelibrary
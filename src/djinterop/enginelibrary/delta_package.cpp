@@ -0,0 +1,545 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/enginelibrary/delta_package.hpp>
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <djinterop/crate.hpp>
+#include <djinterop/database.hpp>
+#include <djinterop/enginelibrary.hpp>
+#include <djinterop/enginelibrary/attached_database.hpp>
+#include <djinterop/enginelibrary/el_database_impl.hpp>
+#include <djinterop/enginelibrary/el_transaction_guard_impl.hpp>
+#include <djinterop/enginelibrary/schema/schema_validate_utils.hpp>
+#include <djinterop/exceptions.hpp>
+#include <djinterop/util.hpp>
+
+namespace djinterop::enginelibrary
+{
+namespace
+{
+/// The membership of a track in a crate, identified by the crate's path.
+struct crate_membership
+{
+    std::string crate_path;
+    int64_t track_id;
+};
+
+/// Throw if a schema version has no change log or pack table.
+void ensure_delta_support(const semantic_version& version)
+{
+    if (version < version_1_17_0)
+    {
+        throw unsupported_database_version{
+            "Delta packages require schema version 1.17.0 or above", version};
+    }
+}
+
+/// Get the columns, other than `id`, that a table has in both of two schemas
+/// of a connection.
+std::vector<std::string> shared_columns(
+    sqlite::database& db, const std::string& table,
+    const std::string& first_schema, const std::string& second_schema)
+{
+    std::set<std::string> second_names;
+    for (auto&& column : schema::table_info{db, second_schema, table})
+    {
+        second_names.insert(column.col_name);
+    }
+
+    std::vector<std::string> columns;
+    for (auto&& column : schema::table_info{db, first_schema, table})
+    {
+        if (column.col_name != "id" && second_names.count(column.col_name))
+        {
+            columns.push_back(column.col_name);
+        }
+    }
+
+    return columns;
+}
+
+/// Join column names into a list, qualifying each with a prefix.
+std::string column_list(
+    const std::vector<std::string>& columns, const std::string& prefix = "")
+{
+    std::string list;
+    for (auto&& column : columns)
+    {
+        if (!list.empty())
+        {
+            list += ", ";
+        }
+
+        list += prefix + column;
+    }
+
+    return list;
+}
+
+/// Read the change log position recorded by the last pack of a database in
+/// another one.
+int64_t read_pack_position(
+    sqlite::database& db, const std::string& schema, const std::string& uuid)
+{
+    int64_t position;
+    db << "SELECT IFNULL(MAX(changeLogId), 0) FROM " + schema +
+              ".Pack WHERE changeLogDatabaseUuid = ?"
+       << uuid >>
+        position;
+    return position;
+}
+
+/// Find the crate with a given path, creating it and any missing ancestors if
+/// there is none.
+///
+/// A crate's path holds its own name and those of its ancestors, each followed
+/// by a semicolon.
+crate find_or_create_crate(
+    const database& db, el_storage& storage, const std::string& path)
+{
+    stdx::optional<int64_t> id;
+    storage.db << "SELECT id FROM music.Crate WHERE path = ?" << path >>
+        [&](int64_t crate_id) { id = crate_id; };
+    if (id)
+    {
+        return *db.crate_by_id(*id);
+    }
+
+    auto name_end = path.size() - 1;
+    auto parent_end =
+        name_end == 0 ? std::string::npos : path.rfind(';', name_end - 1);
+    if (parent_end == std::string::npos)
+    {
+        return db.create_root_crate(path.substr(0, name_end));
+    }
+
+    auto parent =
+        find_or_create_crate(db, storage, path.substr(0, parent_end + 1));
+    return parent.create_sub_crate(
+        path.substr(parent_end + 1, name_end - parent_end - 1));
+}
+
+/// Add tracks to crates, creating the given crates, and any others that the
+/// memberships refer to, if they do not yet exist.
+///
+/// Crates are found or created once per distinct path, and the memberships are
+/// then staged in a temporary table and added with a single statement.
+void add_crate_memberships(
+    const std::shared_ptr<el_storage>& storage,
+    const std::set<std::string>& crate_paths,
+    const std::vector<crate_membership>& memberships)
+{
+    database db{std::make_shared<el_database_impl>(storage)};
+    std::map<std::string, int64_t> crate_ids;
+    auto add_crate = [&](const std::string& path) {
+        if (path.empty() || path.back() != ';' || crate_ids.count(path))
+        {
+            return;
+        }
+
+        auto cr = find_or_create_crate(db, *storage, path);
+        crate_ids.emplace(path, cr.id());
+    };
+
+    for (auto&& path : crate_paths)
+    {
+        add_crate(path);
+    }
+
+    for (auto&& membership : memberships)
+    {
+        add_crate(membership.crate_path);
+    }
+
+    if (crate_ids.empty())
+    {
+        return;
+    }
+
+    storage->db << "CREATE TEMP TABLE delta_crate_track (crateId INTEGER, "
+                   "trackId INTEGER, PRIMARY KEY (crateId, trackId))";
+    {
+        auto insert =
+            storage->db
+            << "INSERT OR IGNORE INTO temp.delta_crate_track VALUES (?, ?)";
+        for (auto&& membership : memberships)
+        {
+            auto iter = crate_ids.find(membership.crate_path);
+            if (iter == crate_ids.end())
+            {
+                continue;
+            }
+
+            insert << iter->second << membership.track_id;
+            insert++;
+        }
+    }
+
+    storage->db << "INSERT INTO music.CrateTrackList (crateId, trackId) "
+                   "SELECT t.crateId, t.trackId FROM temp.delta_crate_track t "
+                   "WHERE NOT EXISTS (SELECT 1 FROM music.CrateTrackList l "
+                   "WHERE l.crateId = t.crateId AND l.trackId = t.trackId)";
+    storage->db << "DROP TABLE temp.delta_crate_track";
+}
+
+}  // namespace
+
+std::size_t create_delta_package(
+    const std::shared_ptr<el_storage>& source,
+    const std::string& package_directory, const std::string& target_directory)
+{
+    ensure_delta_support(source->version);
+
+    // The package is created empty, and then filled through the connection
+    // of the source.
+    auto package = std::make_shared<el_storage>(
+        package_directory, source->version, source->task_executor);
+
+    std::set<std::string> crate_paths;
+    std::vector<crate_membership> memberships;
+    int64_t track_count;
+    {
+        attached_database target{
+            *source, "delta_target", target_directory, "m.db"};
+        ensure_delta_support(target.version());
+        attached_database package_music{
+            *source, "delta_music", package_directory, "m.db"};
+        attached_database package_perfdata{
+            *source, "delta_perfdata", package_directory, "p.db"};
+
+        auto& db = source->db;
+        el_transaction_guard_impl trans{source};
+
+        std::string music_uuid;
+        std::string perfdata_uuid;
+        db << "SELECT uuid FROM music.Information" >> music_uuid;
+        db << "SELECT uuid FROM perfdata.Information" >> perfdata_uuid;
+
+        // A track is included if it has changed since the last pack from this
+        // database was applied to the target, or if the target has no copy of
+        // it.  Updates are recorded in the change logs, and insertions are
+        // found by their absence from the target.
+        db << "CREATE TEMP TABLE delta_track (id INTEGER PRIMARY KEY)";
+        db << "INSERT INTO temp.delta_track SELECT id FROM music.Track "
+              "WHERE path IS NOT NULL AND ("
+              "id IN (SELECT itemId FROM music.ChangeLog WHERE id > ?) OR "
+              "id IN (SELECT itemId FROM perfdata.ChangeLog WHERE id > ?) OR "
+              "id NOT IN ("
+              "SELECT c.idOfTrackInSourceDatabase "
+              "FROM delta_target.CopiedTrack c "
+              "JOIN delta_target.Track t ON t.id = c.trackId "
+              "WHERE c.uuidOfSourceDatabase = ? AND "
+              "c.idOfTrackInSourceDatabase IS NOT NULL))"
+           << read_pack_position(db, "delta_target", music_uuid)
+           << read_pack_position(db, "delta_target", perfdata_uuid)
+           << music_uuid;
+
+        // A crate is included if its tracks differ from those of the crate
+        // with the same path in the target, counting only tracks copied from
+        // this database.  Its ancestors are included too, and each included
+        // crate carries all of its tracks, so that applying the package can
+        // replace the crate's tracks in the target, removals included.
+        db << "WITH source_list (path, trackId) AS ("
+              "SELECT c.path, l.trackId FROM music.Crate c "
+              "JOIN music.CrateTrackList l ON l.crateId = c.id "
+              "JOIN music.Track t ON t.id = l.trackId "
+              "WHERE t.path IS NOT NULL), "
+              "target_list (path, trackId) AS ("
+              "SELECT c.path, t.idOfTrackInSourceDatabase "
+              "FROM delta_target.Crate c "
+              "JOIN delta_target.CrateTrackList l ON l.crateId = c.id "
+              "JOIN delta_target.CopiedTrack t ON t.trackId = l.trackId "
+              "WHERE t.uuidOfSourceDatabase = ?) "
+              "SELECT path FROM ("
+              "SELECT * FROM source_list EXCEPT SELECT * FROM target_list) "
+              "UNION SELECT path FROM ("
+              "SELECT * FROM target_list EXCEPT SELECT * FROM source_list) "
+              "WHERE path IN (SELECT path FROM music.Crate)"
+           << music_uuid >>
+            [&](std::string path) {
+                for (auto end = path.find(';'); end != std::string::npos;
+                     end = path.find(';', end + 1))
+                {
+                    crate_paths.insert(path.substr(0, end + 1));
+                }
+            };
+
+        db << "CREATE TEMP TABLE delta_crate (path TEXT PRIMARY KEY)";
+        {
+            auto insert = db << "INSERT INTO temp.delta_crate VALUES (?)";
+            for (auto&& path : crate_paths)
+            {
+                insert << path;
+                insert++;
+            }
+        }
+
+        db << "INSERT OR IGNORE INTO temp.delta_track SELECT l.trackId "
+              "FROM music.Crate c "
+              "JOIN music.CrateTrackList l ON l.crateId = c.id "
+              "JOIN music.Track t ON t.id = l.trackId "
+              "WHERE t.path IS NOT NULL AND "
+              "c.path IN (SELECT path FROM temp.delta_crate)";
+
+        // Tracks keep their IDs in the package.
+        for (auto&& [schema, table] :
+             {std::pair{"music", "Track"}, std::pair{"music", "MetaData"},
+              std::pair{"music", "MetaDataInteger"},
+              std::pair{"perfdata", "PerformanceData"}})
+        {
+            auto source_table = std::string{schema} + "." + table;
+            auto package_table = std::string{"delta_"} + source_table;
+            auto columns = column_list(shared_columns(
+                db, table, schema, std::string{"delta_"} + schema));
+            db << "INSERT INTO " + package_table + " (id, " + columns +
+                      ") SELECT id, " + columns + " FROM " + source_table +
+                      " WHERE id IN (SELECT id FROM temp.delta_track) "
+                      "ORDER BY id";
+        }
+
+        // Album art referenced by the packaged tracks keeps its IDs too.
+        db << "INSERT OR REPLACE INTO delta_music.AlbumArt (id, hash, "
+              "albumArt) SELECT id, hash, albumArt FROM music.AlbumArt "
+              "WHERE id IN (SELECT idAlbumArt FROM music.Track "
+              "WHERE id IN (SELECT id FROM temp.delta_track))";
+
+        db << "INSERT INTO delta_music.CopiedTrack (trackId, "
+              "uuidOfSourceDatabase, idOfTrackInSourceDatabase) "
+              "SELECT id, ?, id FROM temp.delta_track"
+           << music_uuid;
+
+        // The pack records the position of each change log of the source, from
+        // which the next package to the same target continues.
+        auto pack_id = generate_random_uuid();
+        db << "INSERT INTO delta_music.Pack (packId, changeLogDatabaseUuid, "
+              "changeLogId) SELECT ?, ?, IFNULL(MAX(id), 0) "
+              "FROM music.ChangeLog"
+           << pack_id << music_uuid;
+        db << "INSERT INTO delta_music.Pack (packId, changeLogDatabaseUuid, "
+              "changeLogId) SELECT ?, ?, IFNULL(MAX(id), 0) "
+              "FROM perfdata.ChangeLog"
+           << pack_id << perfdata_uuid;
+
+        db << "SELECT c.path, l.trackId FROM music.Crate c "
+              "JOIN music.CrateTrackList l ON l.crateId = c.id "
+              "WHERE c.path IN (SELECT path FROM temp.delta_crate) AND "
+              "l.trackId IN (SELECT id FROM temp.delta_track)" >>
+            [&](std::string path, int64_t track_id) {
+                memberships.push_back(
+                    crate_membership{std::move(path), track_id});
+            };
+
+        db << "SELECT COUNT(*) FROM temp.delta_track" >> track_count;
+        db << "DROP TABLE temp.delta_track";
+        db << "DROP TABLE temp.delta_crate";
+        trans.commit();
+    }
+
+    el_transaction_guard_impl trans{package};
+    add_crate_memberships(package, crate_paths, memberships);
+    trans.commit();
+
+    return static_cast<std::size_t>(track_count);
+}
+
+std::size_t apply_delta_package(
+    const std::shared_ptr<el_storage>& target,
+    const std::string& package_directory)
+{
+    ensure_delta_support(target->version);
+
+    attached_database package_music{
+        *target, "delta_music", package_directory, "m.db"};
+    ensure_delta_support(package_music.version());
+    attached_database package_perfdata{
+        *target, "delta_perfdata", package_directory, "p.db"};
+
+    auto& db = target->db;
+    el_transaction_guard_impl trans{target};
+
+    // Each packaged track is matched to the copy of the same source track in
+    // the target, or failing that, to a track with the same path.
+    db << "CREATE TEMP TABLE delta_map (package_id INTEGER PRIMARY KEY, "
+          "source_uuid TEXT, source_id INTEGER, target_id INTEGER)";
+    db << "INSERT INTO temp.delta_map "
+          "SELECT c.trackId, c.uuidOfSourceDatabase, "
+          "c.idOfTrackInSourceDatabase, IFNULL(MIN(tt.id), "
+          "(SELECT MIN(t.id) FROM music.Track t WHERE t.path = d.path)) "
+          "FROM delta_music.CopiedTrack c "
+          "JOIN delta_music.Track d ON d.id = c.trackId "
+          "LEFT JOIN music.CopiedTrack t "
+          "ON t.uuidOfSourceDatabase = c.uuidOfSourceDatabase AND "
+          "t.idOfTrackInSourceDatabase = c.idOfTrackInSourceDatabase "
+          "LEFT JOIN music.Track tt ON tt.id = t.trackId "
+          "GROUP BY c.trackId";
+    db << "CREATE INDEX temp.delta_map_target_id ON delta_map (target_id)";
+
+    // Album art referenced by packaged tracks is matched to identical art in
+    // the target, or failing that, inserted, recording the ID of each row as
+    // it is inserted.
+    db << "CREATE TEMP TABLE delta_art (package_id INTEGER PRIMARY KEY, "
+          "target_id INTEGER)";
+    db << "INSERT INTO temp.delta_art "
+          "SELECT a.id, (SELECT MIN(t.id) FROM music.AlbumArt t "
+          "WHERE t.hash IS a.hash AND t.albumArt IS a.albumArt) "
+          "FROM delta_music.AlbumArt a "
+          "WHERE a.id IN (SELECT idAlbumArt FROM delta_music.Track)";
+    std::vector<int64_t> unmatched_art_ids;
+    db << "SELECT package_id FROM temp.delta_art WHERE target_id IS NULL "
+          "ORDER BY package_id" >>
+        [&](int64_t package_id) { unmatched_art_ids.push_back(package_id); };
+    if (!unmatched_art_ids.empty())
+    {
+        auto insert = db << "INSERT INTO music.AlbumArt (hash, albumArt) "
+                            "SELECT hash, albumArt FROM delta_music.AlbumArt "
+                            "WHERE id = ?";
+        auto update_map = db << "UPDATE temp.delta_art SET target_id = ? "
+                                "WHERE package_id = ?";
+        for (auto package_id : unmatched_art_ids)
+        {
+            insert << package_id;
+            insert++;
+            update_map << db.last_insert_rowid() << package_id;
+            update_map++;
+        }
+    }
+
+    // Matched tracks are updated in place, so as to keep their IDs, and the
+    // others are inserted.  Album art IDs are mapped to those of the target,
+    // with art missing from the package replaced by the "no art" row.
+    auto track_columns = shared_columns(db, "Track", "music", "delta_music");
+    std::vector<std::string> track_values;
+    for (auto&& column : track_columns)
+    {
+        track_values.push_back(
+            column == "idAlbumArt"
+                ? "CASE WHEN d.idAlbumArt IS NULL THEN NULL ELSE IFNULL(("
+                  "SELECT a.target_id FROM temp.delta_art a "
+                  "WHERE a.package_id = d.idAlbumArt), 1) END"
+                : "d." + column);
+    }
+
+    std::string assignments;
+    for (std::size_t i = 0; i < track_columns.size(); ++i)
+    {
+        if (!assignments.empty())
+        {
+            assignments += ", ";
+        }
+
+        assignments += track_columns[i] + " = (SELECT " + track_values[i] +
+                       " FROM delta_music.Track d "
+                       "JOIN temp.delta_map m ON m.package_id = d.id "
+                       "WHERE m.target_id = Track.id)";
+    }
+
+    db << "UPDATE music.Track SET " + assignments +
+              " WHERE id IN (SELECT target_id FROM temp.delta_map)";
+
+    // The ID of each inserted track is recorded as it is inserted, as several
+    // packaged tracks may share a path.
+    std::vector<int64_t> unmatched_ids;
+    db << "SELECT package_id FROM temp.delta_map WHERE target_id IS NULL "
+          "ORDER BY package_id" >>
+        [&](int64_t package_id) { unmatched_ids.push_back(package_id); };
+    if (!unmatched_ids.empty())
+    {
+        auto insert = db << "INSERT INTO music.Track (" +
+                                column_list(track_columns) + ") SELECT " +
+                                column_list(track_values) +
+                                " FROM delta_music.Track d WHERE d.id = ?";
+        auto update_map = db << "UPDATE temp.delta_map SET target_id = ? "
+                                "WHERE package_id = ?";
+        for (auto package_id : unmatched_ids)
+        {
+            insert << package_id;
+            insert++;
+            update_map << db.last_insert_rowid() << package_id;
+            update_map++;
+        }
+    }
+
+    for (auto&& [schema, table] :
+         {std::pair{"music", "MetaData"}, std::pair{"music", "MetaDataInteger"},
+          std::pair{"perfdata", "PerformanceData"}})
+    {
+        auto target_table = std::string{schema} + "." + table;
+        auto package_table = std::string{"delta_"} + target_table;
+        auto columns = shared_columns(
+            db, table, schema, std::string{"delta_"} + schema);
+        db << "DELETE FROM " + target_table +
+                  " WHERE id IN (SELECT target_id FROM temp.delta_map)";
+        db << "INSERT INTO " + target_table + " (id, " + column_list(columns) +
+                  ") SELECT m.target_id, " + column_list(columns, "d.") +
+                  " FROM " + package_table +
+                  " d JOIN temp.delta_map m ON m.package_id = d.id";
+    }
+
+    // Replaced performance data is not recorded by the triggers of the schema.
+    db << "INSERT INTO perfdata.ChangeLog (itemId) "
+          "SELECT target_id FROM temp.delta_map";
+
+    db << "INSERT OR REPLACE INTO music.CopiedTrack (trackId, "
+          "uuidOfSourceDatabase, idOfTrackInSourceDatabase) "
+          "SELECT target_id, source_uuid, source_id FROM temp.delta_map";
+    db << "INSERT INTO music.Pack (packId, changeLogDatabaseUuid, changeLogId) "
+          "SELECT packId, changeLogDatabaseUuid, changeLogId "
+          "FROM delta_music.Pack";
+
+    // Each packaged crate carries all of its tracks, and so its tracks from
+    // the source database are replaced, removing any it no longer has.
+    std::set<std::string> crate_paths;
+    db << "SELECT path FROM delta_music.Crate" >>
+        [&](std::string path) { crate_paths.insert(std::move(path)); };
+    db << "DELETE FROM music.CrateTrackList WHERE crateId IN ("
+          "SELECT id FROM music.Crate "
+          "WHERE path IN (SELECT path FROM delta_music.Crate)) AND "
+          "trackId IN (SELECT trackId FROM music.CopiedTrack "
+          "WHERE uuidOfSourceDatabase IN ("
+          "SELECT changeLogDatabaseUuid FROM delta_music.Pack))";
+
+    std::vector<crate_membership> memberships;
+    db << "SELECT c.path, m.target_id FROM delta_music.Crate c "
+          "JOIN delta_music.CrateTrackList l ON l.crateId = c.id "
+          "JOIN temp.delta_map m ON m.package_id = l.trackId" >>
+        [&](std::string path, int64_t track_id) {
+            memberships.push_back(crate_membership{std::move(path), track_id});
+        };
+
+    std::vector<int64_t> ids;
+    db << "SELECT target_id FROM temp.delta_map" >>
+        [&](int64_t id) { ids.push_back(id); };
+    db << "DROP TABLE temp.delta_map";
+    db << "DROP TABLE temp.delta_art";
+
+    add_crate_memberships(target, crate_paths, memberships);
+    trans.commit();
+
+    for (auto id : ids)
+    {
+        target->invalidate_prefetched(id);
+    }
+
+    return ids.size();
+}
+
+}  // namespace djinterop::enginelibrary
@@ -0,0 +1,43 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "el_storage.hpp"
+
+namespace djinterop::enginelibrary
+{
+/// Write the tracks of a storage that have changed since they were last
+/// copied to the database in a target directory into a new delta package.
+///
+/// See `database::create_delta_package()` for details.
+std::size_t create_delta_package(
+    const std::shared_ptr<el_storage>& source,
+    const std::string& package_directory, const std::string& target_directory);
+
+/// Apply the delta package in a directory to a storage.
+///
+/// See `database::apply_delta_package()` for details.
+std::size_t apply_delta_package(
+    const std::shared_ptr<el_storage>& target,
+    const std::string& package_directory);
+
+}  // namespace djinterop::enginelibrary
@@ -0,0 +1,113 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "el_async_runner.hpp"
+
+#include <utility>
+
+#include <sqlite_modern_cpp.h>
+
+#include <djinterop/enginelibrary/el_database_impl.hpp>
+
+#include "el_prefetcher.hpp"
+#include "el_storage.hpp"
+
+namespace djinterop::enginelibrary
+{
+namespace
+{
+/// The time, in milliseconds, for which the runner's connection will wait on
+/// a lock held by another connection before giving up.
+constexpr int busy_timeout_ms = 5000;
+
+}  // anonymous namespace
+
+el_async_runner::el_async_runner(
+    std::string directory, std::shared_ptr<executor> exec,
+    el_prefetcher& prefetcher) :
+    directory_{std::move(directory)}, exec_{std::move(exec)},
+    prefetcher_{prefetcher}, task_{exec_, [this] { drain(); }}
+{
+}
+
+el_async_runner::~el_async_runner()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        stopping_ = true;
+    }
+
+    task_.stop();
+}
+
+void el_async_runner::submit(std::function<void(database&)> operation)
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (!connection_)
+        {
+            auto storage = std::make_shared<el_storage>(directory_, exec_);
+            sqlite3_busy_timeout(
+                storage->db.connection().get(), busy_timeout_ms);
+            connection_ = database{std::make_shared<el_database_impl>(storage)};
+        }
+
+        queue_.push_back(std::move(operation));
+    }
+
+    task_.wake();
+}
+
+void el_async_runner::drain()
+{
+    std::function<void(database&)> operation;
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (stopping_ || queue_.empty())
+        {
+            return;
+        }
+
+        operation = std::move(queue_.front());
+        queue_.pop_front();
+    }
+
+    // Nothing may be prefetched while the operation runs, as it could be
+    // read part-way through a write.
+    prefetcher_.begin_transaction();
+    try
+    {
+        operation(*connection_);
+    }
+    catch (...)
+    {
+        // Operations report their own errors.
+    }
+
+    prefetcher_.clear();
+    prefetcher_.end_transaction();
+
+    // Run any other queued operations separately, so that other tasks on the
+    // executor get a turn in between.
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (!queue_.empty())
+    {
+        task_.wake();
+    }
+}
+
+}  // namespace djinterop::enginelibrary
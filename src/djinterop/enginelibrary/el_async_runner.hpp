@@ -0,0 +1,86 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <djinterop/database.hpp>
+#include <djinterop/executor.hpp>
+#include <djinterop/optional.hpp>
+
+#include "../parallel.hpp"
+
+namespace djinterop::enginelibrary
+{
+class el_prefetcher;
+
+/// The `el_async_runner` class runs the asynchronous operations of a database
+/// one at a time on an executor.
+///
+/// Operations are run through their own connection to the database files in
+/// the given directory, and so are never absorbed into, or rolled back with,
+/// a transaction open on the connection owned by `el_storage`.  They contend
+/// with that connection for nothing other than file locks.  Anything
+/// prefetched for the owning storage is discarded after each operation, as
+/// the operation may have written to any track.
+class el_async_runner
+{
+public:
+    /// Construct a runner for the Engine DB in the given directory.
+    ///
+    /// No connection is opened until the first call to `submit()`.
+    el_async_runner(
+        std::string directory, std::shared_ptr<executor> exec,
+        el_prefetcher& prefetcher);
+
+    /// Stop background work, abandoning any queued operations.
+    ~el_async_runner();
+
+    el_async_runner(const el_async_runner&) = delete;
+    el_async_runner& operator=(const el_async_runner&) = delete;
+
+    /// Queue an operation, to be run with a database object for the runner's
+    /// connection.
+    ///
+    /// Throws if the connection cannot be opened.
+    void submit(std::function<void(database&)> operation);
+
+private:
+    /// Run the operation at the front of the queue, if any.
+    void drain();
+
+    const std::string directory_;
+    const std::shared_ptr<executor> exec_;
+    el_prefetcher& prefetcher_;
+
+    std::mutex mutex_;
+
+    /// The runner's connection, opened on first use, and only ever used by
+    /// `drain()` once opened.
+    stdx::optional<database> connection_;
+
+    std::deque<std::function<void(database&)> > queue_;
+    bool stopping_ = false;
+    serial_task task_;
+};
+
+}  // namespace djinterop::enginelibrary
@@ -0,0 +1,114 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "el_checkpointer.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace djinterop::enginelibrary
+{
+namespace
+{
+/// The time, in milliseconds, for which a background connection will wait on
+/// a lock held by another connection before giving up.
+constexpr int busy_timeout_ms = 5000;
+
+}  // anonymous namespace
+
+int to_sqlite_checkpoint_mode(checkpoint_mode mode)
+{
+    switch (mode)
+    {
+        case checkpoint_mode::passive: return SQLITE_CHECKPOINT_PASSIVE;
+        case checkpoint_mode::full: return SQLITE_CHECKPOINT_FULL;
+        case checkpoint_mode::restart: return SQLITE_CHECKPOINT_RESTART;
+        case checkpoint_mode::truncate: return SQLITE_CHECKPOINT_TRUNCATE;
+    }
+
+    return SQLITE_CHECKPOINT_PASSIVE;
+}
+
+el_checkpointer::el_checkpointer(
+    std::string directory, checkpoint_mode mode,
+    std::shared_ptr<executor> exec) :
+    directory_{std::move(directory)}, mode_{mode},
+    task_{std::move(exec), [this] { drain(); }}
+{
+}
+
+el_checkpointer::~el_checkpointer()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        stopping_ = true;
+    }
+
+    task_.stop();
+}
+
+void el_checkpointer::request(const std::string& filename)
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (std::find(pending_.begin(), pending_.end(), filename) !=
+            pending_.end())
+        {
+            return;
+        }
+
+        pending_.push_back(filename);
+    }
+
+    task_.wake();
+}
+
+void el_checkpointer::drain()
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+    while (!stopping_ && !pending_.empty())
+    {
+        auto filename = std::move(pending_.front());
+        pending_.erase(pending_.begin());
+        lock.unlock();
+
+        try
+        {
+            auto& connection = connections_[filename];
+            if (!connection)
+            {
+                connection = std::make_unique<sqlite::database>(
+                    directory_ + "/" + filename);
+                sqlite3_busy_timeout(
+                    connection->connection().get(), busy_timeout_ms);
+            }
+
+            // A busy or failed checkpoint leaves the log as it is, and it
+            // will be checkpointed again on a later request.
+            sqlite3_wal_checkpoint_v2(
+                connection->connection().get(), nullptr,
+                to_sqlite_checkpoint_mode(mode_), nullptr, nullptr);
+        }
+        catch (...)
+        {
+        }
+
+        lock.lock();
+    }
+}
+
+}  // namespace djinterop::enginelibrary
@@ -0,0 +1,85 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sqlite_modern_cpp.h>
+
+#include <djinterop/database.hpp>
+#include <djinterop/executor.hpp>
+
+#include "../parallel.hpp"
+
+namespace djinterop::enginelibrary
+{
+/// Get the SQLite checkpoint mode corresponding to a given `checkpoint_mode`.
+int to_sqlite_checkpoint_mode(checkpoint_mode mode);
+
+/// The `el_checkpointer` class runs checkpoints of write-ahead logs in the
+/// background on an executor, so that they do not add to the latency of the
+/// commits that trigger them.
+///
+/// Background checkpoints are run through separate connections to the
+/// database files in the given directory, and so never contends with the
+/// connection owned by `el_storage` for anything other than file locks.
+/// Checkpoints are best-effort: any that fail are simply left for the next
+/// request.
+class el_checkpointer
+{
+public:
+    /// Construct a checkpointer for the Engine DB in the given directory.
+    ///
+    /// No work is submitted to the executor until the first call to
+    /// `request()`.
+    el_checkpointer(
+        std::string directory, checkpoint_mode mode,
+        std::shared_ptr<executor> exec);
+
+    /// Stop background work, abandoning any outstanding requests.
+    ~el_checkpointer();
+
+    el_checkpointer(const el_checkpointer&) = delete;
+    el_checkpointer& operator=(const el_checkpointer&) = delete;
+
+    /// Request a checkpoint of the given database file, such as `m.db`.
+    ///
+    /// Requests for a file that is already awaiting a checkpoint are merged.
+    void request(const std::string& filename);
+
+private:
+    /// Checkpoint each file with an outstanding request.
+    void drain();
+
+    const std::string directory_;
+    const checkpoint_mode mode_;
+
+    /// Connections opened on first use, and only ever used by `drain()`.
+    std::map<std::string, std::unique_ptr<sqlite::database> > connections_;
+
+    std::mutex mutex_;
+    std::vector<std::string> pending_;
+    bool stopping_ = false;
+    serial_task task_;
+};
+
+}  // namespace djinterop::enginelibrary
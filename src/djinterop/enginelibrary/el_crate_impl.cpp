@@ -349,6 +349,34 @@ stdx::optional<crate> el_crate_impl::sub_crate_by_name(const std::string& name)
     return cr;
 }
 
+std::size_t el_crate_impl::track_count()
+{
+    int64_t count = 0;
+    if (storage_->version >= version_1_11_1)
+    {
+        // The `List` table holds a count of each list's tracks, maintained by
+        // triggers on `ListTrackList`.
+        stdx::optional<int64_t> list_count;
+        storage_->db << "SELECT trackCount FROM List WHERE id = ? AND type = 4"
+                     << id() >>
+            [&](int64_t track_count) { list_count = track_count; };
+        if (!list_count)
+        {
+            throw crate_deleted{id()};
+        }
+
+        count = *list_count;
+    }
+    else
+    {
+        storage_->db << "SELECT COUNT(*) FROM CrateTrackList WHERE crateId = ?"
+                     << id() >>
+            count;
+    }
+
+    return static_cast<std::size_t>(count);
+}
+
 std::vector<track> el_crate_impl::tracks()
 {
     std::vector<track> results;
@@ -46,6 +46,7 @@ public:
     void set_name(std::string name) override;
     void set_parent(stdx::optional<crate> parent) override;
     stdx::optional<crate> sub_crate_by_name(const std::string& name) override;
+    std::size_t track_count() override;
     std::vector<track> tracks() override;
 
 private:
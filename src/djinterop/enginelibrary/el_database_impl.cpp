@@ -16,11 +16,27 @@
  */
 #include <djinterop/enginelibrary/el_database_impl.hpp>
 
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+
+#include <djinterop/enginelibrary/backup.hpp>
+#include <djinterop/enginelibrary/beatgrid_lookup.hpp>
+#include <djinterop/enginelibrary/delta_package.hpp>
 #include <djinterop/enginelibrary/el_crate_impl.hpp>
 #include <djinterop/enginelibrary/el_storage.hpp>
 #include <djinterop/enginelibrary/el_track_impl.hpp>
 #include <djinterop/enginelibrary/el_transaction_guard_impl.hpp>
+#include <djinterop/enginelibrary/folder_import.hpp>
+#include <djinterop/enginelibrary/import_links.hpp>
+#include <djinterop/enginelibrary/performance_data_format.hpp>
+#include <djinterop/enginelibrary/relink.hpp>
 #include <djinterop/enginelibrary/schema/schema.hpp>
+#include <djinterop/enginelibrary/track_analysis.hpp>
+#include <djinterop/enginelibrary/track_columns.hpp>
+#include <djinterop/enginelibrary/track_export.hpp>
+#include <djinterop/enginelibrary/track_utils.hpp>
+#include <djinterop/parallel.hpp>
 #include <djinterop/transaction_guard.hpp>
 #include <djinterop/util.hpp>
 
@@ -47,6 +63,251 @@ void ensure_valid_crate_name(const std::string& name)
     }
 }
 
+/// A track whose overview waveform is to be regenerated.
+struct overview_job
+{
+    int64_t id;
+    std::vector<char> track_data;
+    std::vector<char> high_res_waveform_data;
+    std::vector<char> overview_waveform_data;
+    bool changed;
+};
+
+/// Recalculate the overview waveform for a track, replacing the encoded
+/// overview in the job if it has changed.
+void regenerate_overview(overview_job& job)
+{
+    auto sampling = track_data::decode(job.track_data).sampling;
+    auto sample_rate = sampling ? sampling->sample_rate : 0;
+    auto sample_count = sampling ? sampling->sample_count : 0;
+    auto high_res_waveform_d =
+        high_res_waveform_data::decode(job.high_res_waveform_data);
+
+    overview_waveform_data overview_waveform_d;
+    overview_waveform_d.samples_per_entry =
+        util::calculate_overview_waveform_samples_per_entry(
+            sample_rate, sample_count);
+    overview_waveform_d.waveform =
+        calculate_overview_waveform(high_res_waveform_d.waveform);
+
+    auto encoded = overview_waveform_d.encode();
+    job.changed = encoded != job.overview_waveform_data;
+    job.overview_waveform_data = std::move(encoded);
+}
+
+/// A track whose beatgrids are to be transformed.
+struct beatgrid_job
+{
+    int64_t id;
+    std::vector<char> beat_data;
+    bool changed;
+};
+
+/// Transform the beatgrids of a track, replacing the encoded beat data in the
+/// job if it has changed.
+void transform_beatgrid(beatgrid_job& job, const beatgrid_transform& transform)
+{
+    auto beat_d = beat_data::decode(job.beat_data);
+    transform(
+        beat_d.sampling, beat_d.default_beatgrid, beat_d.adjusted_beatgrid);
+
+    auto encoded = beat_d.encode();
+    if (!(beat_data::decode(encoded) == beat_d))
+    {
+        throw std::invalid_argument{
+            "Transformed beatgrid is not invariant under encoding and "
+            "subsequent decoding"};
+    }
+
+    job.changed = encoded != job.beat_data;
+    job.beat_data = std::move(encoded);
+}
+
+/// A track whose cues and loops are to be quantized.
+struct quantize_job
+{
+    int64_t id;
+    std::vector<char> beat_data;
+    std::vector<char> quick_cues_data;
+    std::vector<char> loops_data;
+    bool quick_cues_changed;
+    bool loops_changed;
+};
+
+/// Quantize the hot cues, adjusted main cue and loops of a track to its
+/// adjusted beatgrid, replacing the encoded data in the job if they have
+/// changed.
+void quantize_cues(quantize_job& job, int beats_per_step)
+{
+    auto adjusted_beatgrid = beat_data::decode(job.beat_data).adjusted_beatgrid;
+    if (adjusted_beatgrid.size() < 2)
+    {
+        return;
+    }
+
+    beatgrid_lookup lookup{adjusted_beatgrid};
+    auto quick_cues_d = quick_cues_data::decode(job.quick_cues_data);
+    for (auto& hot_cue : quick_cues_d.hot_cues)
+    {
+        if (hot_cue)
+        {
+            hot_cue->sample_offset =
+                lookup.quantize(hot_cue->sample_offset, beats_per_step);
+        }
+    }
+
+    // A main cue of zero denotes that none is set.
+    if (quick_cues_d.adjusted_main_cue != 0)
+    {
+        quick_cues_d.adjusted_main_cue =
+            lookup.quantize(quick_cues_d.adjusted_main_cue, beats_per_step);
+    }
+
+    auto loops_d = loops_data::decode(job.loops_data);
+    for (auto& loop : loops_d.loops)
+    {
+        if (loop)
+        {
+            // Loops shorter than one step keep their length, rather than
+            // collapsing to nothing.
+            auto start_beat = lookup.beat_at(loop->start_sample_offset);
+            auto end_beat = lookup.beat_at(loop->end_sample_offset);
+            auto length = loop->end_sample_offset - loop->start_sample_offset;
+            loop->start_sample_offset =
+                lookup.quantize(loop->start_sample_offset, beats_per_step);
+            if (end_beat - start_beat < beats_per_step)
+            {
+                loop->end_sample_offset = loop->start_sample_offset + length;
+            }
+            else
+            {
+                loop->end_sample_offset =
+                    lookup.quantize(loop->end_sample_offset, beats_per_step);
+            }
+        }
+    }
+
+    auto encoded_quick_cues = quick_cues_d.encode();
+    job.quick_cues_changed = encoded_quick_cues != job.quick_cues_data;
+    job.quick_cues_data = std::move(encoded_quick_cues);
+
+    auto encoded_loops = loops_d.encode();
+    job.loops_changed = encoded_loops != job.loops_data;
+    job.loops_data = std::move(encoded_loops);
+}
+
+/// Prepare a query over the next batch of track IDs.
+///
+/// A parenthesised list of placeholders is appended to the query, and bound
+/// to up to `batch_size` IDs, starting from the one at index `next`, which is
+/// advanced accordingly.
+sqlite::database_binder bind_id_batch(
+    sqlite::database& db, const std::string& query,
+    const std::vector<int64_t>& ids, std::size_t& next, std::size_t batch_size)
+{
+    // Keep within SQLite's default limit on the number of bound parameters.
+    batch_size = std::clamp<std::size_t>(batch_size, 1, 999);
+    auto end = std::min(ids.size(), next + batch_size);
+    auto sql = query + " (?";
+    for (auto i = next + 1; i < end; ++i)
+    {
+        sql += ", ?";
+    }
+
+    sql += ")";
+    auto binder = db << sql;
+    for (; next < end; ++next)
+    {
+        binder << ids[next];
+    }
+
+    return binder;
+}
+
+/// Run a bulk update over batches of jobs.
+///
+/// Each batch returned by `fetch` is processed job-by-job by `process`, spread
+/// across up to `thread_count` threads of the storage's executor, while the
+/// next batch is fetched alongside.  Each processed batch is then passed to
+/// `write` within a transaction on the calling thread.  The update ends when
+/// `fetch` returns an empty batch.
+template <typename Fetch, typename Process, typename Write>
+void run_bulk_update(
+    const std::shared_ptr<el_storage>& storage, std::size_t thread_count,
+    Fetch&& fetch, Process&& process, Write&& write)
+{
+    auto batch = fetch();
+    while (!batch.empty())
+    {
+        // Index zero fetches the next batch, and the rest process this one.
+        decltype(batch) next_batch;
+        parallel_for(
+            *storage->task_executor, batch.size() + 1, thread_count,
+            [&](std::size_t i) {
+                if (i == 0)
+                {
+                    next_batch = fetch();
+                }
+                else
+                {
+                    process(batch[i - 1]);
+                }
+            });
+
+        el_transaction_guard_impl trans{storage};
+        write(batch);
+        trans.commit();
+        batch = std::move(next_batch);
+    }
+}
+
+/// Determine which of the given IDs are present in a table.
+///
+/// The IDs are loaded into a temporary table, so that they can all be checked
+/// by a single join.
+std::vector<bool> ids_exist(
+    const std::shared_ptr<el_storage>& storage, const std::vector<int64_t>& ids,
+    const std::string& table)
+{
+    if (ids.empty())
+    {
+        return {};
+    }
+
+    std::unordered_set<int64_t> found;
+    el_transaction_guard_impl trans{storage};
+
+    // The table may be left over from an earlier call that failed within an
+    // outer transaction, which a nested guard does not roll back.
+    storage->db << "CREATE TEMP TABLE IF NOT EXISTS requested_id "
+                   "(id INTEGER PRIMARY KEY)";
+    storage->db << "DELETE FROM temp.requested_id";
+    {
+        auto insert = storage->db
+                      << "INSERT OR IGNORE INTO temp.requested_id VALUES (?)";
+        for (auto id : ids)
+        {
+            insert << id;
+            insert++;
+        }
+    }
+
+    storage->db << "SELECT r.id FROM temp.requested_id r JOIN " + table +
+                       " t ON t.id = r.id" >>
+        [&](int64_t id) { found.insert(id); };
+    storage->db << "DROP TABLE temp.requested_id";
+    trans.commit();
+
+    std::vector<bool> results;
+    results.reserve(ids.size());
+    for (auto id : ids)
+    {
+        results.push_back(found.count(id) != 0);
+    }
+
+    return results;
+}
+
 }  // namespace
 
 el_database_impl::el_database_impl(std::shared_ptr<el_storage> storage) :
@@ -54,12 +315,42 @@ el_database_impl::el_database_impl(std::shared_ptr<el_storage> storage) :
 {
 }
 
+std::size_t el_database_impl::apply_delta_package(
+    const std::string& package_directory)
+{
+    return enginelibrary::apply_delta_package(storage_, package_directory);
+}
+
+bool el_database_impl::backup_to(
+    const std::string& directory, const backup_options& options)
+{
+    return backup_storage(*storage_, directory, options);
+}
+
 transaction_guard el_database_impl::begin_transaction()
 {
     return transaction_guard{
         std::make_unique<el_transaction_guard_impl>(storage_)};
 }
 
+std::vector<checkpoint_result> el_database_impl::checkpoint(
+    checkpoint_mode mode)
+{
+    return storage_->checkpoint(mode);
+}
+
+database el_database_impl::clone_to_memory()
+{
+    return database{
+        std::make_shared<el_database_impl>(storage_->clone_to_memory())};
+}
+
+track_columns el_database_impl::columns(
+    const std::vector<track_column>& columns)
+{
+    return fetch_track_columns(*storage_, columns);
+}
+
 stdx::optional<crate> el_database_impl::crate_by_id(int64_t id)
 {
     stdx::optional<crate> cr;
@@ -99,6 +390,19 @@ std::vector<crate> el_database_impl::crates_by_name(const std::string& name)
     return results;
 }
 
+std::vector<bool> el_database_impl::crates_exist(
+    const std::vector<int64_t>& ids)
+{
+    return ids_exist(storage_, ids, "music.Crate");
+}
+
+std::size_t el_database_impl::create_delta_package(
+    const std::string& package_directory, const std::string& target_directory)
+{
+    return enginelibrary::create_delta_package(
+        storage_, package_directory, target_directory);
+}
+
 crate el_database_impl::create_root_crate(std::string name)
 {
     ensure_valid_crate_name(name);
@@ -145,11 +449,214 @@ std::string el_database_impl::directory()
     return storage_->directory;
 }
 
+std::vector<export_target_result> el_database_impl::export_to(
+    const std::vector<std::string>& directories,
+    const std::vector<int64_t>& ids, const export_options& options)
+{
+    return export_tracks(storage_, directories, ids, options);
+}
+
+folder_import_result el_database_impl::import_folder_tree(
+    const std::string& root_directory, const folder_import_options& options)
+{
+    return enginelibrary::import_folder_tree(storage_, root_directory, options);
+}
+
+std::vector<imported_track_link> el_database_impl::imported_tracks(
+    const std::string& source_directory)
+{
+    return resolve_imported_tracks(storage_, source_directory);
+}
+
 bool el_database_impl::is_supported()
 {
     return schema::is_supported(version());
 }
 
+std::size_t el_database_impl::link_imported_tracks(
+    const std::string& source_directory)
+{
+    return enginelibrary::link_imported_tracks(storage_, source_directory);
+}
+
+void el_database_impl::prefetch(
+    const std::vector<int64_t>& ids, prefetch_fields fields)
+{
+    storage_->prefetch(ids, fields);
+}
+
+std::size_t el_database_impl::regenerate_overviews(
+    const bulk_update_options& options)
+{
+    auto batch_size = std::max<std::size_t>(1, options.batch_size);
+    auto last_id = std::numeric_limits<int64_t>::min();
+    auto exhausted = false;
+    auto fetch_batch = [&] {
+        std::vector<overview_job> batch;
+        if (exhausted)
+        {
+            return batch;
+        }
+
+        storage_->db << "SELECT id, trackData, highResolutionWaveFormData, "
+                        "overviewWaveFormData FROM PerformanceData "
+                        "WHERE id > ? AND highResolutionWaveFormData "
+                        "IS NOT NULL ORDER BY id LIMIT ?"
+                     << last_id << static_cast<int64_t>(batch_size) >>
+            [&](int64_t id, std::vector<char> track_d,
+                std::vector<char> high_res_waveform_d,
+                std::vector<char> overview_waveform_d) {
+                batch.push_back(overview_job{
+                    id, std::move(track_d), std::move(high_res_waveform_d),
+                    std::move(overview_waveform_d), false});
+            };
+
+        exhausted = batch.size() < batch_size;
+        if (!batch.empty())
+        {
+            last_id = batch.back().id;
+        }
+
+        return batch;
+    };
+
+    std::size_t changed_count = 0;
+    run_bulk_update(
+        storage_, options.thread_count, fetch_batch, regenerate_overview,
+        [&](const std::vector<overview_job>& batch) {
+            for (auto& job : batch)
+            {
+                if (job.changed)
+                {
+                    storage_->db << "UPDATE PerformanceData SET "
+                                    "overviewWaveFormData = ? WHERE id = ?"
+                                 << job.overview_waveform_data << job.id;
+                    storage_->invalidate_prefetched(job.id);
+                    ++changed_count;
+                }
+            }
+        });
+
+    return changed_count;
+}
+
+relink_result el_database_impl::relink_tracks(
+    const std::vector<std::string>& directories, const relink_options& options)
+{
+    return enginelibrary::relink_tracks(storage_, directories, options);
+}
+
+std::size_t el_database_impl::transform_beatgrids(
+    const std::vector<int64_t>& ids, const beatgrid_transform& transform,
+    const bulk_update_options& options)
+{
+    std::size_t next = 0;
+    auto fetch_batch = [&] {
+        std::vector<beatgrid_job> batch;
+        while (batch.empty() && next < ids.size())
+        {
+            bind_id_batch(
+                storage_->db,
+                "SELECT id, beatData FROM PerformanceData "
+                "WHERE beatData IS NOT NULL AND id IN",
+                ids, next, options.batch_size) >>
+                [&](int64_t id, std::vector<char> beat_d) {
+                    batch.push_back(
+                        beatgrid_job{id, std::move(beat_d), false});
+                };
+        }
+
+        return batch;
+    };
+
+    std::size_t changed_count = 0;
+    run_bulk_update(
+        storage_, options.thread_count, fetch_batch,
+        [&transform](beatgrid_job& job) { transform_beatgrid(job, transform); },
+        [&](const std::vector<beatgrid_job>& batch) {
+            for (auto& job : batch)
+            {
+                if (job.changed)
+                {
+                    storage_->db << "UPDATE PerformanceData SET "
+                                    "beatData = ? WHERE id = ?"
+                                 << job.beat_data << job.id;
+                    storage_->invalidate_prefetched(job.id);
+                    ++changed_count;
+                }
+            }
+        });
+
+    return changed_count;
+}
+
+std::size_t el_database_impl::quantize_cues(
+    const std::vector<int64_t>& ids, quantize_resolution resolution,
+    const bulk_update_options& options)
+{
+    std::size_t next = 0;
+    auto fetch_batch = [&] {
+        std::vector<quantize_job> batch;
+        while (batch.empty() && next < ids.size())
+        {
+            bind_id_batch(
+                storage_->db,
+                "SELECT id, beatData, quickCues, loops FROM PerformanceData "
+                "WHERE beatData IS NOT NULL AND quickCues IS NOT NULL AND "
+                "loops IS NOT NULL AND id IN",
+                ids, next, options.batch_size) >>
+                [&](int64_t id, std::vector<char> beat_d,
+                    std::vector<char> quick_cues_d,
+                    std::vector<char> loops_d) {
+                    batch.push_back(quantize_job{
+                        id, std::move(beat_d), std::move(quick_cues_d),
+                        std::move(loops_d), false, false});
+                };
+        }
+
+        return batch;
+    };
+
+    auto beats_per_step = resolution == quantize_resolution::bar ? 4 : 1;
+    std::size_t changed_count = 0;
+    run_bulk_update(
+        storage_, options.thread_count, fetch_batch,
+        [beats_per_step](quantize_job& job) {
+            enginelibrary::quantize_cues(job, beats_per_step);
+        },
+        [&](const std::vector<quantize_job>& batch) {
+            for (auto& job : batch)
+            {
+                if (job.quick_cues_changed)
+                {
+                    storage_->db << "UPDATE PerformanceData SET "
+                                    "quickCues = ? WHERE id = ?"
+                                 << job.quick_cues_data << job.id;
+                }
+
+                if (job.loops_changed)
+                {
+                    storage_->db << "UPDATE PerformanceData SET "
+                                    "loops = ? WHERE id = ?"
+                                 << job.loops_data << job.id;
+                }
+
+                if (job.quick_cues_changed || job.loops_changed)
+                {
+                    storage_->invalidate_prefetched(job.id);
+                    ++changed_count;
+                }
+            }
+        });
+
+    return changed_count;
+}
+
+std::vector<analysis_job> el_database_impl::unanalyzed_tracks()
+{
+    return find_unanalyzed_tracks(*storage_);
+}
+
 void el_database_impl::verify()
 {
     auto schema_creator_validator =
@@ -165,6 +672,7 @@ void el_database_impl::remove_crate(crate cr)
 void el_database_impl::remove_track(track tr)
 {
     storage_->db << "DELETE FROM Track WHERE id = ?" << tr.id();
+    storage_->invalidate_prefetched(tr.id());
     // All other references to the track should automatically be cleared by
     // "ON DELETE CASCADE"
 }
@@ -198,6 +706,27 @@ stdx::optional<crate> el_database_impl::root_crate_by_name(
     return cr;
 }
 
+void el_database_impl::set_checkpoint_options(
+    const checkpoint_options& options)
+{
+    storage_->set_checkpoint_options(options);
+}
+
+void el_database_impl::set_wal_mode(bool enabled)
+{
+    storage_->set_wal_mode(enabled);
+}
+
+void el_database_impl::submit_async(std::function<void(database&)> operation)
+{
+    storage_->submit_async(std::move(operation));
+}
+
+std::shared_ptr<executor> el_database_impl::task_executor()
+{
+    return storage_->task_executor;
+}
+
 stdx::optional<track> el_database_impl::track_by_id(int64_t id)
 {
     stdx::optional<track> tr;
@@ -216,6 +745,26 @@ stdx::optional<track> el_database_impl::track_by_id(int64_t id)
     return tr;
 }
 
+std::size_t el_database_impl::track_count()
+{
+    int64_t count;
+    storage_->db << "SELECT COUNT(*) FROM Track" >> count;
+    return static_cast<std::size_t>(count);
+}
+
+std::vector<track> el_database_impl::track_handles(
+    const std::vector<int64_t>& ids)
+{
+    std::vector<track> results;
+    results.reserve(ids.size());
+    for (auto id : ids)
+    {
+        results.push_back(track{std::make_shared<el_track_impl>(storage_, id)});
+    }
+
+    return results;
+}
+
 std::vector<track> el_database_impl::tracks()
 {
     std::vector<track> results;
@@ -225,6 +774,12 @@ std::vector<track> el_database_impl::tracks()
     return results;
 }
 
+std::vector<bool> el_database_impl::tracks_exist(
+    const std::vector<int64_t>& ids)
+{
+    return ids_exist(storage_, ids, "music.Track");
+}
+
 std::vector<track> el_database_impl::tracks_by_relative_path(
     const std::string& relative_path)
 {
@@ -255,5 +810,13 @@ std::string el_database_impl::version_name()
     return storage_->schema_creator_validator->name();
 }
 
+std::size_t el_database_impl::write_analysis_results(
+    const std::vector<analysis_results>& results,
+    bool replace_adjusted_beatgrids)
+{
+    return enginelibrary::write_analysis_results(
+        storage_, results, replace_adjusted_beatgrids);
+}
+
 }  // namespace enginelibrary
 }  // namespace djinterop
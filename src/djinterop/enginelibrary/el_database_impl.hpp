@@ -31,28 +31,75 @@ class el_database_impl : public database_impl
 public:
     el_database_impl(std::shared_ptr<el_storage> storage);
 
+    std::size_t apply_delta_package(
+        const std::string& package_directory) override;
+    bool backup_to(
+        const std::string& directory, const backup_options& options) override;
     transaction_guard begin_transaction() override;
+    std::vector<checkpoint_result> checkpoint(checkpoint_mode mode) override;
+    database clone_to_memory() override;
+    track_columns columns(const std::vector<track_column>& columns) override;
     stdx::optional<djinterop::crate> crate_by_id(int64_t id) override;
     std::vector<djinterop::crate> crates() override;
     std::vector<djinterop::crate> crates_by_name(
         const std::string& name) override;
+    std::vector<bool> crates_exist(const std::vector<int64_t>& ids) override;
+    std::size_t create_delta_package(
+        const std::string& package_directory,
+        const std::string& target_directory) override;
     djinterop::crate create_root_crate(std::string name) override;
     track create_track(const track_snapshot& snapshot) override;
     std::string directory() override;
+    std::vector<export_target_result> export_to(
+        const std::vector<std::string>& directories,
+        const std::vector<int64_t>& ids,
+        const export_options& options) override;
+    folder_import_result import_folder_tree(
+        const std::string& root_directory,
+        const folder_import_options& options) override;
+    std::vector<imported_track_link> imported_tracks(
+        const std::string& source_directory) override;
     bool is_supported() override;
+    std::size_t link_imported_tracks(
+        const std::string& source_directory) override;
+    void prefetch(
+        const std::vector<int64_t>& ids, prefetch_fields fields) override;
+    std::size_t quantize_cues(
+        const std::vector<int64_t>& ids, quantize_resolution resolution,
+        const bulk_update_options& options) override;
+    std::size_t regenerate_overviews(
+        const bulk_update_options& options) override;
+    relink_result relink_tracks(
+        const std::vector<std::string>& directories,
+        const relink_options& options) override;
+    std::size_t transform_beatgrids(
+        const std::vector<int64_t>& ids, const beatgrid_transform& transform,
+        const bulk_update_options& options) override;
+    std::vector<analysis_job> unanalyzed_tracks() override;
     void verify() override;
     void remove_crate(djinterop::crate cr) override;
     void remove_track(djinterop::track tr) override;
     std::vector<djinterop::crate> root_crates() override;
     stdx::optional<djinterop::crate> root_crate_by_name(
         const std::string& name) override;
+    void set_checkpoint_options(const checkpoint_options& options) override;
+    void set_wal_mode(bool enabled) override;
+    void submit_async(std::function<void(database&)> operation) override;
+    std::shared_ptr<executor> task_executor() override;
     stdx::optional<djinterop::track> track_by_id(int64_t id) override;
+    std::size_t track_count() override;
+    std::vector<track> track_handles(
+        const std::vector<int64_t>& ids) override;
     std::vector<djinterop::track> tracks() override;
+    std::vector<bool> tracks_exist(const std::vector<int64_t>& ids) override;
     std::vector<djinterop::track> tracks_by_relative_path(
         const std::string& relative_path) override;
     std::string uuid() override;
     semantic_version version() override;
     std::string version_name() override;
+    std::size_t write_analysis_results(
+        const std::vector<analysis_results>& results,
+        bool replace_adjusted_beatgrids) override;
 
 private:
     std::shared_ptr<el_storage> storage_;
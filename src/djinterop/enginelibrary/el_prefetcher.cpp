@@ -0,0 +1,272 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "el_prefetcher.hpp"
+
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include <sqlite_modern_cpp.h>
+
+namespace djinterop::enginelibrary
+{
+namespace
+{
+/// The maximum number of tracks for which prefetched data is held.
+constexpr std::size_t max_entries = 4096;
+
+/// The maximum number of requests handled by one run of the background task.
+constexpr std::size_t max_requests_per_run = 64;
+
+/// The time, in milliseconds, for which the background connection will wait
+/// on a lock held by another connection before giving up.
+constexpr int busy_timeout_ms = 5000;
+
+bool has_field(prefetch_fields fields, prefetch_fields field)
+{
+    return (fields & field) != prefetch_fields::none;
+}
+
+}  // anonymous namespace
+
+el_prefetcher::el_prefetcher(
+    std::string directory, std::shared_ptr<executor> exec) :
+    directory_{std::move(directory)}, exec_{std::move(exec)},
+    task_{exec_, [this] { drain(); }}
+{
+}
+
+el_prefetcher::~el_prefetcher()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        stopping_ = true;
+    }
+
+    task_.stop();
+}
+
+void el_prefetcher::enqueue(
+    const std::vector<int64_t>& ids, prefetch_fields fields)
+{
+    if (fields == prefetch_fields::none || ids.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        for (auto id : ids)
+        {
+            queue_.push_back(request{id, fields});
+        }
+    }
+
+    task_.wake();
+}
+
+stdx::optional<track_row> el_prefetcher::track(int64_t id)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto iter = entries_.find(id);
+    return iter != entries_.end() ? iter->second.track : stdx::nullopt;
+}
+
+stdx::optional<std::vector<meta_data_row> > el_prefetcher::meta_data(
+    int64_t id)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto iter = entries_.find(id);
+    return iter != entries_.end() ? iter->second.meta_data : stdx::nullopt;
+}
+
+stdx::optional<std::vector<meta_data_integer_row> >
+el_prefetcher::meta_data_integer(int64_t id)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto iter = entries_.find(id);
+    return iter != entries_.end() ? iter->second.meta_data_integer
+                                  : stdx::nullopt;
+}
+
+stdx::optional<overview_waveform_data> el_prefetcher::overview_waveform(
+    int64_t id)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto iter = entries_.find(id);
+    return iter != entries_.end() ? iter->second.overview_waveform
+                                  : stdx::nullopt;
+}
+
+void el_prefetcher::invalidate(int64_t id)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    ++generation_;
+    auto iter = entries_.find(id);
+    if (iter != entries_.end())
+    {
+        insertion_order_.erase(iter->second.position);
+        entries_.erase(iter);
+    }
+}
+
+void el_prefetcher::clear()
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    ++generation_;
+    insertion_order_.clear();
+    entries_.clear();
+}
+
+void el_prefetcher::begin_transaction()
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    ++generation_;
+    ++transaction_depth_;
+}
+
+void el_prefetcher::end_transaction()
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    ++generation_;
+    --transaction_depth_;
+}
+
+void el_prefetcher::drain()
+{
+    // Prefetching is a best-effort optimisation: if the background connection
+    // cannot be opened, requests are simply dropped, and data will be read on
+    // demand as usual.
+    if (!reader_opened_)
+    {
+        reader_opened_ = true;
+        try
+        {
+            reader_ = std::make_unique<el_storage>(directory_, exec_);
+            sqlite3_busy_timeout(
+                reader_->db.connection().get(), busy_timeout_ms);
+        }
+        catch (...)
+        {
+        }
+    }
+
+    std::unique_lock<std::mutex> lock{mutex_};
+    for (std::size_t handled = 0; !stopping_ && !queue_.empty(); ++handled)
+    {
+        if (handled == max_requests_per_run)
+        {
+            lock.unlock();
+            task_.wake();
+            return;
+        }
+
+        auto req = queue_.front();
+        queue_.pop_front();
+        if (!reader_)
+        {
+            continue;
+        }
+
+        // Work out what is still to be loaded for this track.
+        auto want_row = has_field(req.fields, prefetch_fields::row);
+        auto want_overview =
+            has_field(req.fields, prefetch_fields::overview_waveform);
+        auto iter = entries_.find(req.id);
+        if (iter != entries_.end())
+        {
+            want_row = want_row && !iter->second.track;
+            want_overview = want_overview && !iter->second.overview_waveform;
+        }
+
+        if (!want_row && !want_overview)
+        {
+            continue;
+        }
+
+        auto generation = generation_;
+        lock.unlock();
+
+        entry loaded;
+        try
+        {
+            if (want_row)
+            {
+                loaded.track = reader_->get_track(req.id);
+                loaded.meta_data = reader_->get_all_meta_data(req.id);
+                loaded.meta_data_integer =
+                    reader_->get_all_meta_data_integer(req.id);
+            }
+
+            if (want_overview)
+            {
+                loaded.overview_waveform =
+                    reader_->get_performance_data_column<
+                        overview_waveform_data>(
+                        req.id, "overviewWaveFormData");
+            }
+        }
+        catch (...)
+        {
+            // The track may have been removed, or the database may be locked
+            // for longer than we are prepared to wait.  Either way, the data
+            // will be read on demand instead.
+            lock.lock();
+            continue;
+        }
+
+        // Give way to foreground threads between tracks.
+        std::this_thread::yield();
+
+        lock.lock();
+        if (generation != generation_ || transaction_depth_ > 0)
+        {
+            // A write or transaction may have overlapped with the read, so
+            // the loaded data cannot be trusted.
+            continue;
+        }
+
+        auto [pos, inserted] = entries_.try_emplace(req.id);
+        auto& cached = pos->second;
+        if (inserted)
+        {
+            cached.position =
+                insertion_order_.insert(insertion_order_.end(), req.id);
+        }
+
+        if (loaded.track)
+        {
+            cached.track = std::move(loaded.track);
+            cached.meta_data = std::move(loaded.meta_data);
+            cached.meta_data_integer = std::move(loaded.meta_data_integer);
+        }
+
+        if (loaded.overview_waveform)
+        {
+            cached.overview_waveform = std::move(loaded.overview_waveform);
+        }
+
+        while (entries_.size() > max_entries)
+        {
+            entries_.erase(insertion_order_.front());
+            insertion_order_.pop_front();
+        }
+    }
+}
+
+}  // namespace djinterop::enginelibrary
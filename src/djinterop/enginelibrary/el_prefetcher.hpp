@@ -0,0 +1,129 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <djinterop/database.hpp>
+#include <djinterop/executor.hpp>
+#include <djinterop/optional.hpp>
+
+#include "../parallel.hpp"
+#include "el_storage.hpp"
+#include "performance_data_format.hpp"
+
+namespace djinterop::enginelibrary
+{
+/// The `el_prefetcher` class loads track data in the background ahead of it
+/// being requested, and holds the results in a cache that `el_storage`
+/// consults before querying the database.
+///
+/// Background work is run on an executor, and reads through its own connection
+/// to the database files in the given directory, and so never contends with
+/// the connection owned by `el_storage` for anything other than file locks.
+/// Results that may have been read concurrently with a write, or while a
+/// transaction is open, are discarded rather than cached.
+class el_prefetcher
+{
+public:
+    /// Construct a prefetcher for the Engine DB in the given directory.
+    ///
+    /// No work is submitted to the executor until the first call to
+    /// `enqueue()`.
+    el_prefetcher(std::string directory, std::shared_ptr<executor> exec);
+
+    /// Stop background work, abandoning any outstanding requests.
+    ~el_prefetcher();
+
+    el_prefetcher(const el_prefetcher&) = delete;
+    el_prefetcher& operator=(const el_prefetcher&) = delete;
+
+    /// Queue the given tracks for loading in the background.
+    void enqueue(const std::vector<int64_t>& ids, prefetch_fields fields);
+
+    /// Get a prefetched row from the `Track` table, if available.
+    stdx::optional<track_row> track(int64_t id);
+
+    /// Get prefetched rows from the `MetaData` table, if available.
+    stdx::optional<std::vector<meta_data_row> > meta_data(int64_t id);
+
+    /// Get prefetched rows from the `MetaDataInteger` table, if available.
+    stdx::optional<std::vector<meta_data_integer_row> > meta_data_integer(
+        int64_t id);
+
+    /// Get a prefetched, decoded overview waveform, if available.
+    stdx::optional<overview_waveform_data> overview_waveform(int64_t id);
+
+    /// Discard anything prefetched for the given track.
+    void invalidate(int64_t id);
+
+    /// Discard everything prefetched.
+    void clear();
+
+    /// Notify the prefetcher that a transaction has begun.
+    void begin_transaction();
+
+    /// Notify the prefetcher that a transaction has been committed or rolled
+    /// back.
+    void end_transaction();
+
+private:
+    struct entry
+    {
+        stdx::optional<track_row> track;
+        stdx::optional<std::vector<meta_data_row> > meta_data;
+        stdx::optional<std::vector<meta_data_integer_row> > meta_data_integer;
+        stdx::optional<overview_waveform_data> overview_waveform;
+        std::list<int64_t>::iterator position;
+    };
+
+    struct request
+    {
+        int64_t id;
+        prefetch_fields fields;
+    };
+
+    /// Load data for queued requests until the queue is empty, or until
+    /// enough have been loaded that other tasks should get a turn.
+    void drain();
+
+    const std::string directory_;
+    const std::shared_ptr<executor> exec_;
+
+    /// The background connection, only ever used by `drain()`.
+    std::unique_ptr<el_storage> reader_;
+    bool reader_opened_ = false;
+
+    std::mutex mutex_;
+    std::deque<request> queue_;
+    std::unordered_map<int64_t, entry> entries_;
+    std::list<int64_t> insertion_order_;
+    uint64_t generation_ = 0;
+    int64_t transaction_depth_ = 0;
+    bool stopping_ = false;
+    serial_task task_;
+};
+
+}  // namespace djinterop::enginelibrary
@@ -20,9 +20,16 @@
 #include <djinterop/database.hpp>
 #include <djinterop/enginelibrary.hpp>
 #include <djinterop/exceptions.hpp>
+#include <chrono>
+#include <stdexcept>
+#include <string>
 #include <utility>
 
 #include "../util.hpp"
+#include "backup.hpp"
+#include "el_async_runner.hpp"
+#include "el_checkpointer.hpp"
+#include "el_prefetcher.hpp"
 #include "schema/schema.hpp"
 
 namespace djinterop::enginelibrary
@@ -50,6 +57,11 @@ sqlite::database make_attached_db(const std::string& directory, bool must_exist)
     return db;
 }
 
+std::shared_ptr<executor> or_default(std::shared_ptr<executor> exec)
+{
+    return exec ? std::move(exec) : default_executor();
+}
+
 sqlite::database make_temporary_db()
 {
     sqlite::database db{":memory:"};
@@ -58,6 +70,16 @@ sqlite::database make_temporary_db()
     return db;
 }
 
+/// The schema name and filename of each database attached to storage.
+struct attached_file
+{
+    const char* schema;
+    const char* filename;
+};
+
+constexpr attached_file attached_files[] = {
+    {"music", "m.db"}, {"perfdata", "p.db"}};
+
 semantic_version get_version(sqlite::database& db)
 {
     // Check that the `Information` table has been created.
@@ -101,30 +123,171 @@ semantic_version get_version(sqlite::database& db)
 
 }  // anonymous namespace
 
-el_storage::el_storage(const std::string& directory) :
+el_storage::el_storage(
+    const std::string& directory, std::shared_ptr<executor> task_executor) :
     directory{directory}, db{make_attached_db(directory, true)},
     version{get_version(db)},
-    schema_creator_validator{schema::make_schema_creator_validator(version)}
+    task_executor{or_default(std::move(task_executor))},
+    schema_creator_validator{schema::make_schema_creator_validator(version)},
+    prefetcher_{
+        std::make_unique<el_prefetcher>(directory, this->task_executor)},
+    async_runner_{std::make_unique<el_async_runner>(
+        directory, this->task_executor, *prefetcher_)}
 {
 }
 
-el_storage::el_storage(const std::string& directory, semantic_version version) :
+el_storage::el_storage(
+    const std::string& directory, semantic_version version,
+    std::shared_ptr<executor> task_executor) :
     directory{directory}, db{make_attached_db(directory, false)},
-    version{version}, schema_creator_validator{
-                          schema::make_schema_creator_validator(version)}
+    version{version},
+    task_executor{or_default(std::move(task_executor))},
+    schema_creator_validator{schema::make_schema_creator_validator(version)},
+    prefetcher_{
+        std::make_unique<el_prefetcher>(directory, this->task_executor)},
+    async_runner_{std::make_unique<el_async_runner>(
+        directory, this->task_executor, *prefetcher_)}
 {
     // Create the desired schema on the new database.
     schema_creator_validator->create(db);
 }
 
-el_storage::el_storage(semantic_version version) :
+el_storage::el_storage(
+    semantic_version version, std::shared_ptr<executor> task_executor) :
     directory{":memory:"}, db{make_temporary_db()}, version{version},
-    schema_creator_validator{schema::make_schema_creator_validator(version)}
+    task_executor{or_default(std::move(task_executor))},
+    schema_creator_validator{schema::make_schema_creator_validator(version)},
+    prefetcher_{
+        std::make_unique<el_prefetcher>(directory, this->task_executor)},
+    async_runner_{std::make_unique<el_async_runner>(
+        directory, this->task_executor, *prefetcher_)}
 {
     // Create the desired schema on the new database.
     schema_creator_validator->create(db);
 }
 
+el_storage::el_storage(
+    sqlite::database db, semantic_version version,
+    std::shared_ptr<executor> task_executor) :
+    directory{":memory:"}, db{std::move(db)}, version{version},
+    task_executor{or_default(std::move(task_executor))},
+    schema_creator_validator{schema::make_schema_creator_validator(version)},
+    prefetcher_{
+        std::make_unique<el_prefetcher>(directory, this->task_executor)},
+    async_runner_{std::make_unique<el_async_runner>(
+        directory, this->task_executor, *prefetcher_)}
+{
+}
+
+el_storage::~el_storage()
+{
+    // Stop handing checkpoints to the checkpointer before it is destroyed.
+    if (checkpointer_)
+    {
+        sqlite3_wal_hook(db.connection().get(), nullptr, nullptr);
+    }
+}
+
+std::shared_ptr<el_storage> el_storage::clone_to_memory()
+{
+    auto clone_db = make_temporary_db();
+    for (std::string schema : {"music", "perfdata"})
+    {
+        // The page size of an in-memory DB cannot be changed by a backup, and
+        // so it must be set to match before anything is written to it.
+        int64_t page_size;
+        db << ("PRAGMA " + schema + ".page_size") >> page_size;
+        clone_db << ("PRAGMA " + schema +
+                     ".page_size = " + std::to_string(page_size));
+        backup_schema(
+            db.connection().get(), schema.c_str(),
+            clone_db.connection().get(), schema.c_str(), 0,
+            std::chrono::milliseconds{0});
+    }
+
+    return std::shared_ptr<el_storage>{
+        new el_storage{std::move(clone_db), version, task_executor}};
+}
+
+std::vector<checkpoint_result> el_storage::checkpoint(checkpoint_mode mode)
+{
+    std::vector<checkpoint_result> results;
+    for (auto&& file : attached_files)
+    {
+        int log_frames = -1;
+        int checkpointed_frames = -1;
+        auto rc = sqlite3_wal_checkpoint_v2(
+            db.connection().get(), file.schema, to_sqlite_checkpoint_mode(mode),
+            &log_frames, &checkpointed_frames);
+        if (rc != SQLITE_OK && rc != SQLITE_BUSY)
+        {
+            sqlite::errors::throw_sqlite_error(rc);
+        }
+
+        results.push_back(checkpoint_result{
+            file.filename, log_frames, checkpointed_frames, rc == SQLITE_BUSY});
+    }
+
+    return results;
+}
+
+void el_storage::set_checkpoint_options(const checkpoint_options& options)
+{
+    // Any existing checkpointer is replaced, finishing its current checkpoint
+    // first.  Setting the auto-checkpoint threshold removes any WAL hook.
+    auto connection = db.connection().get();
+    sqlite3_wal_autocheckpoint(connection, 0);
+    checkpointer_.reset();
+    if (!options.background)
+    {
+        sqlite3_wal_autocheckpoint(connection, options.auto_checkpoint_frames);
+        return;
+    }
+
+    if (options.auto_checkpoint_frames <= 0 || directory == ":memory:")
+    {
+        return;
+    }
+
+    auto_checkpoint_frames_ = options.auto_checkpoint_frames;
+    checkpointer_ = std::make_unique<el_checkpointer>(
+        directory, options.background_mode, task_executor);
+    sqlite3_wal_hook(connection, &el_storage::on_wal_commit, this);
+}
+
+void el_storage::set_wal_mode(bool enabled)
+{
+    std::string journal_mode = enabled ? "WAL" : "DELETE";
+    for (auto&& file : attached_files)
+    {
+        // The resulting journal mode is returned as a row, which is ignored
+        // here: in-memory databases remain in memory journal mode.
+        db << ("PRAGMA " + std::string{file.schema} +
+               ".journal_mode = " + journal_mode) >>
+            [](std::string) {};
+    }
+}
+
+int el_storage::on_wal_commit(
+    void* context, sqlite3*, const char* schema, int frames)
+{
+    auto& self = *static_cast<el_storage*>(context);
+    if (frames < self.auto_checkpoint_frames_)
+    {
+        return SQLITE_OK;
+    }
+
+    for (auto&& file : attached_files)
+    {
+        if (std::string{file.schema} == schema)
+        {
+            self.checkpointer_->request(file.filename);
+        }
+    }
+
+    return SQLITE_OK;
+}
+
 int64_t el_storage::create_track(
     stdx::optional<int64_t> play_order, stdx::optional<int64_t> length,
     stdx::optional<int64_t> length_calculated, stdx::optional<int64_t> bpm,
@@ -225,7 +388,12 @@ int64_t el_storage::create_track(
 
 track_row el_storage::get_track(int64_t id)
 {
-    stdx::optional<track_row> result;
+    auto result = prefetcher_->track(id);
+    if (result)
+    {
+        return *result;
+    }
+
     if (version >= version_1_18_0)
     {
         db << ("SELECT playOrder, length, lengthCalculated, bpm, year, path, "
@@ -323,7 +491,8 @@ track_row el_storage::get_track(int64_t id)
                     album_art_id,
                     file_bytes,
                     pdb_import_key,
-                    std::move(uri)};
+                    std::move(uri),
+                    stdx::nullopt};  // is_beatgrid_locked
             };
     }
     else if (version >= version_1_7_1)
@@ -369,7 +538,9 @@ track_row el_storage::get_track(int64_t id)
                     id_track_in_external_database,
                     album_art_id,
                     stdx::nullopt,  // file_bytes
-                    pdb_import_key};
+                    pdb_import_key,
+                    stdx::nullopt,  // uri
+                    stdx::nullopt};  // is_beatgrid_locked
             };
     }
     else
@@ -411,7 +582,11 @@ track_row el_storage::get_track(int64_t id)
                     is_external_track,
                     std::move(uuid_of_external_database),
                     id_track_in_external_database,
-                    album_art_id};
+                    album_art_id,
+                    stdx::nullopt,  // file_bytes
+                    stdx::nullopt,  // pdb_import_key
+                    stdx::nullopt,  // uri
+                    stdx::nullopt};  // is_beatgrid_locked
             };
     }
 
@@ -505,10 +680,17 @@ void el_storage::update_track(
            << is_external_track << uuid_of_external_database
            << id_track_in_external_database << album_art_id << id;
     }
+
+    invalidate_prefetched(id);
 }
 
 std::vector<meta_data_row> el_storage::get_all_meta_data(int64_t id)
 {
+    if (auto prefetched = prefetcher_->meta_data(id))
+    {
+        return std::move(*prefetched);
+    }
+
     std::vector<meta_data_row> results;
     db << "SELECT id, type, text FROM MetaData "
           "WHERE id = ? AND text IS NOT NULL"
@@ -525,6 +707,19 @@ stdx::optional<std::string> el_storage::get_meta_data(
     int64_t id, metadata_str_type type)
 {
     stdx::optional<std::string> result;
+    if (auto prefetched = prefetcher_->meta_data(id))
+    {
+        for (auto& row : *prefetched)
+        {
+            if (row.type == type)
+            {
+                result = std::move(row.value);
+            }
+        }
+
+        return result;
+    }
+
     db << "SELECT text FROM MetaData WHERE id = ? AND "
           "type = ? AND text IS NOT NULL"
        << id << static_cast<int64_t>(type) >>
@@ -555,7 +750,10 @@ void el_storage::set_meta_data(
     {
         db << "REPLACE INTO MetaData (id, type, text) VALUES (?, ?, ?)" << id
            << static_cast<int64_t>(type) << nullptr;
+        log_change("music", id);
     }
+
+    invalidate_prefetched(id);
 }
 
 void el_storage::set_meta_data(
@@ -563,6 +761,9 @@ void el_storage::set_meta_data(
 {
     db << "REPLACE INTO MetaData (id, type, text) VALUES (?, ?, ?)" << id
        << static_cast<int64_t>(type) << content;
+    log_change("music", id);
+
+    invalidate_prefetched(id);
 }
 
 void el_storage::set_meta_data(
@@ -610,11 +811,19 @@ void el_storage::set_meta_data(
        << file_extension << id
        << static_cast<int64_t>(metadata_str_type::unknown_15) << "1" << id
        << static_cast<int64_t>(metadata_str_type::unknown_16) << "1";
+    log_change("music", id);
+
+    invalidate_prefetched(id);
 }
 
 std::vector<meta_data_integer_row> el_storage::get_all_meta_data_integer(
     int64_t id)
 {
+    if (auto prefetched = prefetcher_->meta_data_integer(id))
+    {
+        return std::move(*prefetched);
+    }
+
     std::vector<meta_data_integer_row> results;
     db << "SELECT id, type, value FROM MetaDataInteger "
           "WHERE id = ? AND value IS NOT NULL"
@@ -631,6 +840,19 @@ stdx::optional<int64_t> el_storage::get_meta_data_integer(
     int64_t id, metadata_int_type type)
 {
     stdx::optional<int64_t> result;
+    if (auto prefetched = prefetcher_->meta_data_integer(id))
+    {
+        for (auto& row : *prefetched)
+        {
+            if (row.type == type)
+            {
+                result = row.value;
+            }
+        }
+
+        return result;
+    }
+
     db << "SELECT value FROM MetaDataInteger WHERE id = "
           "? AND type = ? AND value IS NOT NULL"
        << id << static_cast<int64_t>(type) >>
@@ -655,6 +877,9 @@ void el_storage::set_meta_data_integer(
 {
     db << "REPLACE INTO MetaDataInteger (id, type, value) VALUES (?, ?, ?)"
        << id << static_cast<int64_t>(type) << content;
+    log_change("music", id);
+
+    invalidate_prefetched(id);
 }
 
 void el_storage::set_meta_data_integer(
@@ -699,12 +924,18 @@ void el_storage::set_meta_data_integer(
        << static_cast<int64_t>(metadata_int_type::last_play_hash)
        << last_play_hash << id
        << static_cast<int64_t>(metadata_int_type::unknown_11) << 1;
+    log_change("music", id);
+
+    invalidate_prefetched(id);
 }
 
 /// Remove an existing entry in the `PerformanceData` table, if it exists.
 void el_storage::clear_performance_data(int64_t id)
 {
     db << "DELETE FROM PerformanceData WHERE id = ?" << id;
+    log_change("perfdata", id);
+
+    invalidate_prefetched(id);
 }
 
 performance_data_row el_storage::get_performance_data(int64_t id)
@@ -782,6 +1013,7 @@ performance_data_row el_storage::get_performance_data(int64_t id)
                     loops_data::decode(loops_data_blob),
                     has_serato_values,
                     has_rekordbox_values,
+                    0,  // has_traktor_values
                 };
             };
     }
@@ -817,7 +1049,9 @@ performance_data_row el_storage::get_performance_data(int64_t id)
                     beat_data::decode(beat_data_blob),
                     quick_cues_data::decode(quick_cues_data_blob),
                     loops_data::decode(loops_data_blob),
-                    has_serato_values};
+                    has_serato_values,
+                    0,  // has_rekordbox_values
+                    0};  // has_traktor_values
             };
     }
 
@@ -826,11 +1060,45 @@ performance_data_row el_storage::get_performance_data(int64_t id)
         // It is a legitimate scenario for a track to not have any performance
         // data recorded - it normally means that the track has not been
         // fully analysed.  In such a case, we can return default data here.
-        return performance_data_row{id};
+        return performance_data_row{
+            id, 0, 0, stdx::nullopt, stdx::nullopt, stdx::nullopt,
+            stdx::nullopt, stdx::nullopt, stdx::nullopt, 0, 0, 0};
     }
     return *result;
 }
 
+stdx::optional<performance_data_blobs> el_storage::get_performance_data_blobs(
+    int64_t id)
+{
+    stdx::optional<performance_data_blobs> result;
+    db << "SELECT trackData, highResolutionWaveFormData, "
+          "overviewWaveFormData, beatData, quickCues, loops "
+          "FROM PerformanceData WHERE id = ?"
+       << id >>
+        [&](std::vector<char> track_data_blob,
+            std::vector<char> high_res_waveform_data_blob,
+            std::vector<char> overview_waveform_data_blob,
+            std::vector<char> beat_data_blob,
+            std::vector<char> quick_cues_data_blob,
+            std::vector<char> loops_data_blob) {
+            if (result)
+            {
+                throw track_database_inconsistency{
+                    "More than one PerformanceData entry for the same track",
+                    id};
+            }
+
+            result = performance_data_blobs{
+                std::move(track_data_blob),
+                std::move(high_res_waveform_data_blob),
+                std::move(overview_waveform_data_blob),
+                std::move(beat_data_blob),
+                std::move(quick_cues_data_blob),
+                std::move(loops_data_blob)};
+        };
+    return result;
+}
+
 void el_storage::set_performance_data(
     int64_t id, int64_t is_analyzed, int64_t is_rendered,
     const track_data& track_data,
@@ -842,6 +1110,20 @@ void el_storage::set_performance_data(
 {
     // TODO (mr-smidge): check encoding/decoding invariants.
 
+    set_performance_data(
+        id, is_analyzed, is_rendered,
+        performance_data_blobs{
+            track_data.encode(), high_res_waveform_data.encode(),
+            overview_waveform_data.encode(), beat_data.encode(),
+            quick_cues_data.encode(), loops_data.encode()},
+        has_serato_values, has_rekordbox_values, has_traktor_values);
+}
+
+void el_storage::set_performance_data(
+    int64_t id, int64_t is_analyzed, int64_t is_rendered,
+    const performance_data_blobs& blobs, int64_t has_serato_values,
+    int64_t has_rekordbox_values, int64_t has_traktor_values)
+{
     if (version >= version_1_11_1)
     {
         db << "INSERT OR REPLACE INTO PerformanceData ("
@@ -853,11 +1135,10 @@ void el_storage::set_performance_data(
               "?, ?, "
               "?, ?, ?, ?, "
               "?, ?, ?)"
-           << id << is_analyzed << is_rendered << track_data.encode()
-           << high_res_waveform_data.encode() << overview_waveform_data.encode()
-           << beat_data.encode() << quick_cues_data.encode()
-           << loops_data.encode() << has_serato_values << has_rekordbox_values
-           << has_traktor_values;
+           << id << is_analyzed << is_rendered << blobs.track_data
+           << blobs.high_res_waveform_data << blobs.overview_waveform_data
+           << blobs.beat_data << blobs.quick_cues_data << blobs.loops_data
+           << has_serato_values << has_rekordbox_values << has_traktor_values;
     }
     else if (version >= version_1_7_1)
     {
@@ -870,10 +1151,10 @@ void el_storage::set_performance_data(
               "?, ?, "
               "?, ?, ?, ?, "
               "?, ?)"
-           << id << is_analyzed << is_rendered << track_data.encode()
-           << high_res_waveform_data.encode() << overview_waveform_data.encode()
-           << beat_data.encode() << quick_cues_data.encode()
-           << loops_data.encode() << has_serato_values << has_rekordbox_values;
+           << id << is_analyzed << is_rendered << blobs.track_data
+           << blobs.high_res_waveform_data << blobs.overview_waveform_data
+           << blobs.beat_data << blobs.quick_cues_data << blobs.loops_data
+           << has_serato_values << has_rekordbox_values;
     }
     else
     {
@@ -886,11 +1167,90 @@ void el_storage::set_performance_data(
               "?, ?, "
               "?, ?, ?, ?, "
               "?)"
-           << id << is_analyzed << is_rendered << track_data.encode()
-           << high_res_waveform_data.encode() << overview_waveform_data.encode()
-           << beat_data.encode() << quick_cues_data.encode()
-           << loops_data.encode() << has_serato_values;
+           << id << is_analyzed << is_rendered << blobs.track_data
+           << blobs.high_res_waveform_data << blobs.overview_waveform_data
+           << blobs.beat_data << blobs.quick_cues_data << blobs.loops_data
+           << has_serato_values;
+    }
+
+    log_change("perfdata", id);
+    invalidate_prefetched(id);
+}
+
+void el_storage::prefetch(
+    const std::vector<int64_t>& ids, prefetch_fields fields)
+{
+    if (directory == ":memory:")
+    {
+        // There is no way for a second connection to read a temporary
+        // database, and nothing to gain from prefetching it anyway.
+        return;
     }
+
+    if (!prefetch_started_)
+    {
+        // The background connection will hold short-lived read locks, which
+        // writes on this connection must be prepared to wait for.
+        sqlite3_busy_timeout(db.connection().get(), 5000);
+        prefetch_started_ = true;
+    }
+
+    prefetcher_->enqueue(ids, fields);
+}
+
+stdx::optional<track_row> el_storage::get_prefetched_track(int64_t id)
+{
+    return prefetcher_->track(id);
+}
+
+stdx::optional<overview_waveform_data>
+el_storage::get_prefetched_overview_waveform(int64_t id)
+{
+    return prefetcher_->overview_waveform(id);
+}
+
+void el_storage::submit_async(std::function<void(database&)> operation)
+{
+    if (directory == ":memory:")
+    {
+        // There is no way for a second connection to reach a temporary
+        // database.
+        throw std::logic_error{
+            "Asynchronous operations need a database stored on disk"};
+    }
+
+    // The runner's connection will hold locks, which operations on this
+    // connection must be prepared to wait for.
+    std::call_once(async_started_, [this] {
+        sqlite3_busy_timeout(db.connection().get(), 5000);
+    });
+
+    async_runner_->submit(std::move(operation));
+}
+
+void el_storage::invalidate_prefetched(int64_t id)
+{
+    prefetcher_->invalidate(id);
+}
+
+void el_storage::log_change(const char* schema, int64_t id)
+{
+    if (version >= version_1_17_0)
+    {
+        db << (std::string{"INSERT INTO "} + schema +
+               ".ChangeLog (itemId) VALUES (?)")
+           << id;
+    }
+}
+
+void el_storage::on_transaction_begin()
+{
+    prefetcher_->begin_transaction();
+}
+
+void el_storage::on_transaction_end()
+{
+    prefetcher_->end_transaction();
 }
 
 }  // namespace djinterop::enginelibrary
@@ -18,12 +18,18 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <type_traits>
 
 #include <sqlite_modern_cpp.h>
 
+#include <djinterop/database.hpp>
 #include <djinterop/enginelibrary.hpp>
 #include <djinterop/exceptions.hpp>
+#include <djinterop/executor.hpp>
 #include <djinterop/optional.hpp>
 #include <djinterop/semantic_version.hpp>
 
@@ -33,6 +39,10 @@
 
 namespace djinterop::enginelibrary
 {
+class el_async_runner;
+class el_checkpointer;
+class el_prefetcher;
+
 /// The `track_row` struct represents a row from the `Track` table.
 struct track_row
 {
@@ -91,22 +101,55 @@ struct performance_data_row
     int64_t has_traktor_values;
 };
 
+/// The `performance_data_blobs` struct holds the raw, still-encoded blob
+/// columns of a row from the `PerformanceData` table.
+struct performance_data_blobs
+{
+    std::vector<char> track_data;
+    std::vector<char> high_res_waveform_data;
+    std::vector<char> overview_waveform_data;
+    std::vector<char> beat_data;
+    std::vector<char> quick_cues_data;
+    std::vector<char> loops_data;
+};
+
 /// The `el_storage` class provides access to persistent storage for Engine
 /// data.
 class el_storage
 {
 public:
     /// Construct by loading from an existing DB directory.
-    el_storage(const std::string& directory);
+    el_storage(
+        const std::string& directory, std::shared_ptr<executor> task_executor);
 
     /// Construct by making a new, empty DB of a given version.
-    el_storage(const std::string& directory, semantic_version version);
+    el_storage(
+        const std::string& directory, semantic_version version,
+        std::shared_ptr<executor> task_executor);
 
     /// Construct by making a new, empty in-memory DB of a given version.
     ///
     /// Any changes made to the database will not persist beyond destruction
     /// of the class instance.
-    explicit el_storage(semantic_version version);
+    explicit el_storage(
+        semantic_version version, std::shared_ptr<executor> task_executor);
+
+    ~el_storage();
+
+    /// Make an in-memory copy of this storage.
+    ///
+    /// Changes made to the copy do not persist beyond its destruction, and do
+    /// not affect this storage.  The copy shares this storage's executor.
+    std::shared_ptr<el_storage> clone_to_memory();
+
+    /// Checkpoint the write-ahead log of each attached database.
+    std::vector<checkpoint_result> checkpoint(checkpoint_mode mode);
+
+    /// Set how write-ahead logs are checkpointed automatically.
+    void set_checkpoint_options(const checkpoint_options& options);
+
+    /// Switch each attached database into or out of WAL mode.
+    void set_wal_mode(bool enabled);
 
     /// Create an entry in the `Track` table.
     int64_t create_track(
@@ -181,6 +224,7 @@ public:
         db << (std::string{"UPDATE Track SET "} + column_name +
                " = ? WHERE id = ?")
            << content << id;
+        invalidate_prefetched(id);
     }
 
     /// Get all string meta-data for a track from the `MetaData` table.
@@ -238,10 +282,25 @@ public:
     /// Get a row from the `PerformanceData` table.
     performance_data_row get_performance_data(int64_t id);
 
+    /// Get the raw blob columns of a row from the `PerformanceData` table,
+    /// without decoding them.
+    ///
+    /// If the track has no performance data, `stdx::nullopt` is returned.
+    stdx::optional<performance_data_blobs> get_performance_data_blobs(
+        int64_t id);
+
     /// Get the value of a given column in the `PerformanceData` table.
     template <typename T>
     T get_performance_data_column(int64_t id, const char* column_name)
     {
+        if constexpr (std::is_same_v<T, overview_waveform_data>)
+        {
+            if (auto prefetched = get_prefetched_overview_waveform(id))
+            {
+                return std::move(*prefetched);
+            }
+        }
+
         stdx::optional<T> result;
         db << (std::string{"SELECT "} + column_name +
                " FROM PerformanceData WHERE id = ?")
@@ -272,6 +331,13 @@ public:
         const loops_data& loops_data, int64_t has_serato_values,
         int64_t has_rekordbox_values, int64_t has_traktor_values);
 
+    /// Set (create or update) an entry in the `PerformanceData` table, given
+    /// blob columns that have already been encoded.
+    void set_performance_data(
+        int64_t id, int64_t is_analyzed, int64_t is_rendered,
+        const performance_data_blobs& blobs, int64_t has_serato_values,
+        int64_t has_rekordbox_values, int64_t has_traktor_values);
+
     /// Set the value of a given column in the `PerformanceData` table.
     template <typename T>
     void set_performance_data_column(
@@ -336,8 +402,39 @@ public:
         db << (std::string{"UPDATE PerformanceData SET "} + column_name +
                " = ?, isAnalyzed = 1 WHERE id = ?")
            << encoded_content << id;
+        invalidate_prefetched(id);
     }
 
+    /// Asynchronously load data for the given tracks into the prefetch cache.
+    ///
+    /// This has no effect on temporary in-memory databases.
+    void prefetch(const std::vector<int64_t>& ids, prefetch_fields fields);
+
+    /// Get a prefetched row from the `Track` table, if there is one.
+    stdx::optional<track_row> get_prefetched_track(int64_t id);
+
+    /// Get a prefetched overview waveform, if there is one.
+    stdx::optional<overview_waveform_data> get_prefetched_overview_waveform(
+        int64_t id);
+
+    /// Queue an operation to run on the executor, through a connection of
+    /// its own, after any operations queued before it.
+    ///
+    /// Throws `std::logic_error` for temporary in-memory databases, which no
+    /// other connection can reach.
+    void submit_async(std::function<void(database&)> operation);
+
+    /// Discard any prefetched data for a track.
+    ///
+    /// This must be called after any write to the track's data.
+    void invalidate_prefetched(int64_t id);
+
+    /// Notify the storage that a transaction has begun.
+    void on_transaction_begin();
+
+    /// Notify the storage that a transaction has been committed or rolled back.
+    void on_transaction_end();
+
     /// The directory in which the Engine DB files reside.
     const std::string directory;
 
@@ -348,11 +445,41 @@ public:
     /// The schema version of the storage databases.
     const semantic_version version;
 
+    /// The executor on which all parallel and background work is run.
+    const std::shared_ptr<executor> task_executor;
+
     /// Pointer to the schema creator/validator.
     const std::unique_ptr<schema::schema_creator_validator>
         schema_creator_validator;
 
     int64_t last_savepoint = 0;
+
+private:
+    /// Construct from an in-memory DB that already has the given version.
+    el_storage(
+        sqlite::database db, semantic_version version,
+        std::shared_ptr<executor> task_executor);
+
+    /// Record a write to a track's data in the change log of one of the
+    /// attached databases.
+    ///
+    /// The triggers of the schema only record updated rows, and so this must
+    /// be called after any write that replaces or deletes rows instead.
+    void log_change(const char* schema, int64_t id);
+
+    /// Callback registered with SQLite to hand automatic checkpoints to the
+    /// background checkpointer.
+    static int on_wal_commit(
+        void* context, sqlite3* connection, const char* schema, int frames);
+
+    const std::unique_ptr<el_prefetcher> prefetcher_;
+    bool prefetch_started_ = false;
+
+    const std::unique_ptr<el_async_runner> async_runner_;
+    std::once_flag async_started_;
+
+    std::unique_ptr<el_checkpointer> checkpointer_;
+    int auto_checkpoint_frames_ = 0;
 };
 
 }  // namespace djinterop::enginelibrary
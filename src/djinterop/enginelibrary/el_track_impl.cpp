@@ -26,6 +26,8 @@
 #include <djinterop/enginelibrary/el_track_impl.hpp>
 #include <djinterop/enginelibrary/el_transaction_guard_impl.hpp>
 #include <djinterop/enginelibrary/track_utils.hpp>
+#include <djinterop/parallel.hpp>
+#include <djinterop/playback_data.hpp>
 #include <djinterop/util.hpp>
 
 namespace djinterop::enginelibrary
@@ -60,23 +62,6 @@ stdx::optional<int64_t> to_timestamp(
     return result;
 }
 
-/// Calculate the samples-per-entry in an overview waveform.
-///
-/// An overview waveform always has 1024 entries, and the number of samples
-/// that each one represents must be calculated from the true sample count by
-/// rounding the number of samples to the quantisation number first.
-int64_t calculate_overview_waveform_samples_per_entry(
-    int64_t sample_rate, int64_t sample_count)
-{
-    auto qn = util::waveform_quantisation_number(sample_rate);
-    if (qn == 0)
-    {
-        return 0;
-    }
-
-    return ((sample_count / qn) * qn) / 1024;
-}
-
 const int64_t default_track_type = 1;
 
 const int64_t default_is_external_track = 0;
@@ -264,23 +249,12 @@ overview_waveform_data to_overview_waveform_data(
 {
     auto sample_count = sampling ? sampling->sample_count : 0;
     auto sample_rate = sampling ? sampling->sample_rate : 0;
-    double samples_per_entry = calculate_overview_waveform_samples_per_entry(
-        sample_rate, sample_count);
+    double samples_per_entry =
+        util::calculate_overview_waveform_samples_per_entry(
+            sample_rate, sample_count);
 
-    std::vector<waveform_entry> overview_waveform;
-    if (!waveform.empty())
-    {
-        // Calculate an overview waveform automatically.
-        // Note that the overview waveform always has 1024 entries in it.
-        overview_waveform.reserve(1024);
-        for (int32_t i = 0; i < 1024; ++i)
-        {
-            auto entry = waveform[waveform.size() * (2 * i + 1) / 2048];
-            overview_waveform.push_back(entry);
-        }
-    }
-
-    return overview_waveform_data{samples_per_entry, overview_waveform};
+    return overview_waveform_data{
+        samples_per_entry, calculate_overview_waveform(waveform)};
 }
 
 high_res_waveform_data to_high_res_waveform_data(
@@ -703,6 +677,11 @@ void el_track_impl::set_average_loudness(
 
 stdx::optional<int64_t> el_track_impl::bitrate()
 {
+    if (auto row = storage_->get_prefetched_track(id()))
+    {
+        return row->bitrate;
+    }
+
     return storage_->get_track_column<stdx::optional<int64_t> >(
         id(), "bitrate");
 }
@@ -714,6 +693,11 @@ void el_track_impl::set_bitrate(stdx::optional<int64_t> bitrate)
 
 stdx::optional<double> el_track_impl::bpm()
 {
+    if (auto row = storage_->get_prefetched_track(id()))
+    {
+        return row->bpm_analyzed;
+    }
+
     return storage_->get_track_column<stdx::optional<double> >(
         id(), "bpmAnalyzed");
 }
@@ -1021,6 +1005,68 @@ void el_track_impl::set_last_played_at(
     }
 }
 
+playback_data el_track_impl::load_for_playback()
+{
+    auto blobs = storage_->get_performance_data_blobs(id());
+    if (!blobs)
+    {
+        // The track has not been analysed, so there is nothing to decode.
+        auto empty_waveform =
+            std::make_shared<const std::vector<waveform_entry> >();
+        return playback_data{
+            id(), {}, {}, {}, {}, {}, {}, {}, {}, {}, empty_waveform,
+            empty_waveform};
+    }
+
+    // The waveforms are by far the largest blobs, and so are each decoded in
+    // parallel with the remaining smaller blobs.
+    high_res_waveform_data high_res_waveform_d;
+    overview_waveform_data overview_waveform_d;
+    track_data track_d;
+    beat_data beat_d;
+    quick_cues_data quick_cues_d;
+    loops_data loops_d;
+    parallel_for(*storage_->task_executor, 3, 0, [&](std::size_t i) {
+        switch (i)
+        {
+            case 0:
+                high_res_waveform_d = high_res_waveform_data::decode(
+                    blobs->high_res_waveform_data);
+                break;
+            case 1:
+                overview_waveform_d = overview_waveform_data::decode(
+                    blobs->overview_waveform_data);
+                break;
+            default:
+                track_d = track_data::decode(blobs->track_data);
+                beat_d = beat_data::decode(blobs->beat_data);
+                quick_cues_d = quick_cues_data::decode(blobs->quick_cues_data);
+                loops_d = loops_data::decode(blobs->loops_data);
+                break;
+        }
+    });
+
+    auto waveform = std::make_shared<const std::vector<waveform_entry> >(
+        std::move(high_res_waveform_d.waveform));
+    auto overview_waveform =
+        std::make_shared<const std::vector<waveform_entry> >(
+            std::move(overview_waveform_d.waveform));
+
+    return playback_data{
+        id(),
+        track_d.sampling,
+        std::move(beat_d.default_beatgrid),
+        std::move(beat_d.adjusted_beatgrid),
+        quick_cues_d.default_main_cue,
+        quick_cues_d.adjusted_main_cue,
+        std::move(quick_cues_d.hot_cues),
+        std::move(loops_d.loops),
+        track_d.average_loudness,
+        track_d.key,
+        std::move(waveform),
+        std::move(overview_waveform)};
+}
+
 stdx::optional<loop> el_track_impl::loop_at(int32_t index)
 {
     auto loops_d = get_loops_data();
@@ -1086,6 +1132,11 @@ void el_track_impl::set_rating(stdx::optional<int32_t> rating)
 
 std::string el_track_impl::relative_path()
 {
+    if (auto row = storage_->get_prefetched_track(id()))
+    {
+        return row->relative_path.value_or(std::string{});
+    }
+
     return storage_->get_track_column<std::string>(id(), "path");
 }
 
@@ -1169,7 +1220,7 @@ void el_track_impl::set_sampling(stdx::optional<sampling_info> sampling)
         // The overview waveform has a varying number of samples per entry, as
         // the number of entries is always fixed.
         overview_waveform_d.samples_per_entry =
-            calculate_overview_waveform_samples_per_entry(
+            util::calculate_overview_waveform_samples_per_entry(
                 sample_rate, sample_count);
         set_overview_waveform_data(std::move(overview_waveform_d));
     }
@@ -1189,6 +1240,11 @@ void el_track_impl::set_title(stdx::optional<std::string> title)
 
 stdx::optional<int32_t> el_track_impl::track_number()
 {
+    if (auto row = storage_->get_prefetched_track(id()))
+    {
+        return row->play_order;
+    }
+
     return storage_->get_track_column<stdx::optional<int32_t> >(
         id(), "playOrder");
 }
@@ -1218,16 +1274,10 @@ void el_track_impl::set_waveform(std::vector<waveform_entry> waveform)
         int64_t sample_rate = smp ? smp->sample_rate : 0;
 
         // Calculate an overview waveform automatically.
-        // Note that the overview waveform always has 1024 entries in it.
         overview_waveform_d.samples_per_entry =
-            calculate_overview_waveform_samples_per_entry(
+            util::calculate_overview_waveform_samples_per_entry(
                 sample_rate, sample_count);
-        overview_waveform_d.waveform.reserve(1024);
-        for (int32_t i = 0; i < 1024; ++i)
-        {
-            auto entry = waveform[waveform.size() * (2 * i + 1) / 2048];
-            overview_waveform_d.waveform.push_back(entry);
-        }
+        overview_waveform_d.waveform = calculate_overview_waveform(waveform);
 
         // Make the assumption that the client has respected the required number
         // of samples per entry when constructing the waveform.
@@ -1244,6 +1294,11 @@ void el_track_impl::set_waveform(std::vector<waveform_entry> waveform)
 
 stdx::optional<int32_t> el_track_impl::year()
 {
+    if (auto row = storage_->get_prefetched_track(id()))
+    {
+        return row->year;
+    }
+
     return storage_->get_track_column<stdx::optional<int32_t> >(id(), "year");
 }
 
@@ -1252,103 +1307,148 @@ void el_track_impl::set_year(stdx::optional<int32_t> year)
     storage_->set_track_column(id(), "year", year);
 }
 
-track create_track(
-    std::shared_ptr<el_storage> storage, const track_snapshot& snapshot)
+encoded_track encode_track(const track_snapshot& snapshot)
 {
-    if (snapshot.id)
-    {
-        throw invalid_track_snapshot{
-            "Snapshot already pertains to a persisted track, and so it cannot "
-            "be created again"};
-    }
-    else if (!snapshot.relative_path)
+    if (!snapshot.relative_path)
     {
         throw invalid_track_snapshot{
             "Snapshot does not contain a populated `relative_path` field, "
             "which is required to create a track"};
     }
 
+    encoded_track result;
+
     auto length_fields = to_length_fields(snapshot.duration, snapshot.sampling);
     auto bpm_fields = to_bpm_fields(
         snapshot.bpm, snapshot.sampling, snapshot.adjusted_beatgrid);
     auto filename = get_filename(*snapshot.relative_path);
-    auto extension = get_file_extension(filename);
-    auto track_number =
-        snapshot.track_number
-            ? stdx::make_optional(static_cast<int64_t>(*snapshot.track_number))
-            : stdx::nullopt;
-    auto year = snapshot.year
-                    ? stdx::make_optional(static_cast<int64_t>(*snapshot.year))
-                    : stdx::nullopt;
     auto timestamp_fields = to_timestamp_fields(
         snapshot.last_played_at, snapshot.last_modified_at,
         snapshot.last_accessed_at);
-    auto key_num = to_key_num(snapshot.key);
-    auto clamped_rating = snapshot.rating
-                              ? stdx::make_optional(static_cast<int64_t>(
-                                    std::clamp(*snapshot.rating, 0, 100)))
-                              : stdx::nullopt;
-    stdx::optional<int64_t> last_play_hash;
-    auto track_data = to_track_data(
-        snapshot.sampling, snapshot.average_loudness, snapshot.key);
-    auto overview_waveform_data =
-        to_overview_waveform_data(snapshot.sampling, snapshot.waveform);
-    auto high_res_waveform_data =
-        to_high_res_waveform_data(snapshot.sampling, snapshot.waveform);
-    auto beat_data = to_beat_data(
-        snapshot.sampling, snapshot.default_beatgrid,
-        snapshot.adjusted_beatgrid);
-    auto cues_data = to_cues_data(
-        snapshot.hot_cues, snapshot.adjusted_main_cue,
-        snapshot.default_main_cue);
-    auto loops_data = to_loops_data(snapshot.loops);
 
-    el_transaction_guard_impl trans{storage};
+    result.track_number =
+        snapshot.track_number
+            ? stdx::make_optional(static_cast<int64_t>(*snapshot.track_number))
+            : stdx::nullopt;
+    result.length = length_fields.length;
+    result.length_calculated = length_fields.length_calculated;
+    result.bpm = bpm_fields.bpm;
+    result.year = snapshot.year ? stdx::make_optional(
+                                      static_cast<int64_t>(*snapshot.year))
+                                : stdx::nullopt;
+    result.relative_path = snapshot.relative_path;
+    result.filename = filename;
+    result.bitrate = snapshot.bitrate;
+    result.bpm_analyzed = bpm_fields.bpm_analyzed;
+    result.file_bytes = snapshot.file_bytes;
+
+    result.title = snapshot.title;
+    result.artist = snapshot.artist;
+    result.album = snapshot.album;
+    result.genre = snapshot.genre;
+    result.comment = snapshot.comment;
+    result.publisher = snapshot.publisher;
+    result.composer = snapshot.composer;
+    result.length_mm_ss = length_fields.length_mm_ss;
+    result.ever_played = timestamp_fields.ever_played;
+    result.extension = get_file_extension(filename);
+
+    result.key_num = to_key_num(snapshot.key);
+    result.rating = snapshot.rating
+                        ? stdx::make_optional(static_cast<int64_t>(
+                              std::clamp(*snapshot.rating, 0, 100)))
+                        : stdx::nullopt;
+    result.last_played_at_ts = timestamp_fields.last_played_at_ts;
+    result.last_modified_at_ts = timestamp_fields.last_modified_at_ts;
+    result.last_accessed_at_ts = timestamp_fields.last_accessed_at_ts;
+
+    // Encode performance data, if any.
+    auto any_hot_cues = std::any_of(
+        snapshot.hot_cues.begin(), snapshot.hot_cues.end(),
+        [](auto hc) { return hc; });
+    auto any_loops = std::any_of(
+        snapshot.loops.begin(), snapshot.loops.end(), [](auto l) { return l; });
+    auto has_perf_data = snapshot.sampling || snapshot.average_loudness ||
+                         !snapshot.adjusted_beatgrid.empty() ||
+                         !snapshot.default_beatgrid.empty() || any_hot_cues ||
+                         any_loops;
+    if (has_perf_data)
+    {
+        result.performance_data = performance_data_blobs{
+            to_track_data(
+                snapshot.sampling, snapshot.average_loudness, snapshot.key)
+                .encode(),
+            to_high_res_waveform_data(snapshot.sampling, snapshot.waveform)
+                .encode(),
+            to_overview_waveform_data(snapshot.sampling, snapshot.waveform)
+                .encode(),
+            to_beat_data(
+                snapshot.sampling, snapshot.default_beatgrid,
+                snapshot.adjusted_beatgrid)
+                .encode(),
+            to_cues_data(
+                snapshot.hot_cues, snapshot.adjusted_main_cue,
+                snapshot.default_main_cue)
+                .encode(),
+            to_loops_data(snapshot.loops).encode()};
+    }
+
+    return result;
+}
 
+int64_t create_track(el_storage& storage, const encoded_track& encoded)
+{
     // Firstly, create the `Track` table entry.
-    auto id = storage->create_track(
-        track_number, length_fields.length, length_fields.length_calculated,
-        bpm_fields.bpm, year, snapshot.relative_path, filename,
-        snapshot.bitrate, bpm_fields.bpm_analyzed, default_track_type,
+    auto id = storage.create_track(
+        encoded.track_number, encoded.length, encoded.length_calculated,
+        encoded.bpm, encoded.year, encoded.relative_path, encoded.filename,
+        encoded.bitrate, encoded.bpm_analyzed, default_track_type,
         default_is_external_track, default_uuid_of_external_database,
         default_id_track_in_external_database, no_album_art_id,
-        snapshot.file_bytes, default_pdb_import_key, default_uri,
+        encoded.file_bytes, default_pdb_import_key, default_uri,
         default_is_beatgrid_locked);
 
     // Set string-based metadata.
-    storage->set_meta_data(
-        id, snapshot.title, snapshot.artist, snapshot.album, snapshot.genre,
-        snapshot.comment, snapshot.publisher, snapshot.composer,
-        length_fields.length_mm_ss, timestamp_fields.ever_played, extension);
+    storage.set_meta_data(
+        id, encoded.title, encoded.artist, encoded.album, encoded.genre,
+        encoded.comment, encoded.publisher, encoded.composer,
+        encoded.length_mm_ss, encoded.ever_played, encoded.extension);
 
     // Set integer-based metadata.
-    storage->set_meta_data_integer(
-        id, key_num, clamped_rating, timestamp_fields.last_played_at_ts,
-        timestamp_fields.last_modified_at_ts,
-        timestamp_fields.last_accessed_at_ts, last_play_hash);
+    stdx::optional<int64_t> last_play_hash;
+    storage.set_meta_data_integer(
+        id, encoded.key_num, encoded.rating, encoded.last_played_at_ts,
+        encoded.last_modified_at_ts, encoded.last_accessed_at_ts,
+        last_play_hash);
 
     // Set performance data, if any.
-    auto any_hot_cues = std::any_of(
-        snapshot.hot_cues.begin(), snapshot.hot_cues.end(),
-        [](auto hc) { return hc; });
-    auto any_loops = std::any_of(
-        snapshot.loops.begin(), snapshot.loops.end(), [](auto l) { return l; });
-    auto has_perf_data = snapshot.sampling || snapshot.average_loudness ||
-                         !snapshot.adjusted_beatgrid.empty() ||
-                         !snapshot.default_beatgrid.empty() || any_hot_cues ||
-                         any_loops;
-    auto is_analysed = 1;
-    if (has_perf_data)
+    if (encoded.performance_data)
     {
-        storage->set_performance_data(
-            id, is_analysed, default_is_rendered, track_data,
-            high_res_waveform_data, overview_waveform_data, beat_data,
-            cues_data, loops_data, default_has_serato_values,
-            default_has_rekordbox_values, default_has_traktor_values);
+        auto is_analysed = 1;
+        storage.set_performance_data(
+            id, is_analysed, default_is_rendered, *encoded.performance_data,
+            default_has_serato_values, default_has_rekordbox_values,
+            default_has_traktor_values);
     }
 
-    track tr{std::make_shared<el_track_impl>(storage, id)};
+    return id;
+}
 
+track create_track(
+    std::shared_ptr<el_storage> storage, const track_snapshot& snapshot)
+{
+    if (snapshot.id)
+    {
+        throw invalid_track_snapshot{
+            "Snapshot already pertains to a persisted track, and so it cannot "
+            "be created again"};
+    }
+
+    auto encoded = encode_track(snapshot);
+
+    el_transaction_guard_impl trans{storage};
+    auto id = create_track(*storage, encoded);
+    track tr{std::make_shared<el_track_impl>(storage, id)};
     trans.commit();
 
     return tr;
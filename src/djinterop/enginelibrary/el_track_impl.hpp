@@ -119,6 +119,7 @@ public:
     void set_last_played_at(
         stdx::optional<std::chrono::system_clock::time_point> played_at)
         override;
+    playback_data load_for_playback() override;
     stdx::optional<loop> loop_at(int32_t index) override;
     void set_loop_at(int32_t index, stdx::optional<loop> l) override;
     std::array<stdx::optional<loop>, 8> loops() override;
@@ -145,6 +146,54 @@ private:
     std::shared_ptr<el_storage> storage_;
 };
 
+/// The `encoded_track` struct holds the rows of a track that is yet to be
+/// created, with its performance data already encoded.
+///
+/// Encoded tracks do not depend on the database to which they are written, and
+/// so one may be written to many databases.
+struct encoded_track
+{
+    stdx::optional<int64_t> track_number;
+    stdx::optional<int64_t> length;
+    stdx::optional<int64_t> length_calculated;
+    stdx::optional<int64_t> bpm;
+    stdx::optional<int64_t> year;
+    stdx::optional<std::string> relative_path;
+    stdx::optional<std::string> filename;
+    stdx::optional<int64_t> bitrate;
+    stdx::optional<double> bpm_analyzed;
+    stdx::optional<int64_t> file_bytes;
+
+    stdx::optional<std::string> title;
+    stdx::optional<std::string> artist;
+    stdx::optional<std::string> album;
+    stdx::optional<std::string> genre;
+    stdx::optional<std::string> comment;
+    stdx::optional<std::string> publisher;
+    stdx::optional<std::string> composer;
+    stdx::optional<std::string> length_mm_ss;
+    stdx::optional<std::string> ever_played;
+    stdx::optional<std::string> extension;
+
+    stdx::optional<int64_t> key_num;
+    stdx::optional<int64_t> rating;
+    stdx::optional<int64_t> last_played_at_ts;
+    stdx::optional<int64_t> last_modified_at_ts;
+    stdx::optional<int64_t> last_accessed_at_ts;
+
+    stdx::optional<performance_data_blobs> performance_data;
+};
+
+/// Encode a snapshot of a track, so that a new track can be created from it.
+///
+/// The ID of the snapshot, if any, is ignored.
+encoded_track encode_track(const track_snapshot& snapshot);
+
+/// Create a track from its encoded rows, returning its ID.
+///
+/// The caller is responsible for wrapping this in a transaction.
+int64_t create_track(el_storage& storage, const encoded_track& encoded);
+
 track create_track(
     std::shared_ptr<el_storage> storage, const track_snapshot& snapshot);
 
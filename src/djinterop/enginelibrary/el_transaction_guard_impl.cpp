@@ -29,6 +29,7 @@ el_transaction_guard_impl::el_transaction_guard_impl(
     // TODO (haslersn): Should el_storage::last_savepoint be atomic such that
     // this is thread-safe?
     storage_->db << ("SAVEPOINT s" + std::to_string(savepoint_));
+    storage_->on_transaction_begin();
 }
 
 el_transaction_guard_impl::~el_transaction_guard_impl()
@@ -48,6 +49,8 @@ el_transaction_guard_impl::~el_transaction_guard_impl()
             //
             // TODO (haslersn): We could still issue a warning
         }
+
+        storage_->on_transaction_end();
     }
 }
 
@@ -55,7 +58,17 @@ void el_transaction_guard_impl::commit()
 {
     auto savepoint = savepoint_;
     savepoint_ = 0;
-    storage_->db << ("RELEASE s" + std::to_string(savepoint));
+    try
+    {
+        storage_->db << ("RELEASE s" + std::to_string(savepoint));
+    }
+    catch (...)
+    {
+        storage_->on_transaction_end();
+        throw;
+    }
+
+    storage_->on_transaction_end();
 }
 
 }  // namespace enginelibrary
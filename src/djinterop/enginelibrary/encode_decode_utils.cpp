@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <stdexcept>
 #include <system_error>
+#include <utility>
 #include <vector>
 
 #include <djinterop/enginelibrary/encode_decode_utils.hpp>
@@ -31,14 +32,21 @@ namespace enginelibrary
 std::vector<char> zlib_uncompress(
     const std::vector<char>& compressed, std::vector<char> uncompressed)
 {
-    if (compressed.size() > 0 && compressed.size() < 4)
-        throw std::length_error(
+    return zlib_uncompress(
+        compressed.data(), compressed.size(), std::move(uncompressed));
+}
+
+// Uncompress a zlib'ed BLOB held in a raw buffer
+std::vector<char> zlib_uncompress(
+    const char* data, std::size_t size, std::vector<char> uncompressed)
+{
+    if (size > 0 && size < 4)
+        throw std::invalid_argument(
             "Compressed data is less than the minimum size of 4 bytes");
 
     uncompressed.clear();
 
-    auto apparent_size =
-        compressed.size() == 0 ? 0 : decode_int32_be(compressed.data()).first;
+    auto apparent_size = size == 0 ? 0 : decode_int32_be(data).first;
 
     if (apparent_size == 0)
     {
@@ -48,8 +56,8 @@ std::vector<char> zlib_uncompress(
 
     uncompressed.reserve(apparent_size);
 
-    const char* ptr = &compressed[4];
-    const char* end = ptr + compressed.size();
+    const char* ptr = data + 4;
+    const char* end = data + size;
     const int chunk_size = 16384;
     int ret;
     unsigned int have;
@@ -83,8 +91,11 @@ std::vector<char> zlib_uncompress(
             ret = inflate(&strm, Z_NO_FLUSH);
             switch (ret)
             {
-                case Z_NEED_DICT: ret = Z_DATA_ERROR;  // Fall through
+                case Z_NEED_DICT:
                 case Z_DATA_ERROR:
+                    inflateEnd(&strm);
+                    throw std::invalid_argument{
+                        "Compressed data is corrupt"};
                 case Z_MEM_ERROR:
                     inflateEnd(&strm);
                     throw std::system_error{ret, std::system_category(),
@@ -95,16 +106,19 @@ std::vector<char> zlib_uncompress(
             uncompressed.insert(uncompressed.end(), out, out + have);
         } while (strm.avail_out == 0);
 
+        // Input that runs out before the end of the stream is truncated, and
+        // inflate() would otherwise make no further progress.
+        if (ret != Z_STREAM_END && ptr == end && strm.avail_in == 0)
+        {
+            inflateEnd(&strm);
+            throw std::invalid_argument{"Compressed data is truncated"};
+        }
+
         // done when inflate() says it's done
     } while (ret != Z_STREAM_END);
 
     // Clean up
     inflateEnd(&strm);
-    if (ret != Z_STREAM_END)
-    {
-        throw std::system_error{Z_DATA_ERROR, std::system_category(),
-                                "Error at end of inflation"};
-    }
 
     return uncompressed;  // Named RVO
 }
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <tuple>
@@ -30,6 +31,10 @@ namespace enginelibrary
 std::vector<char> zlib_uncompress(
     const std::vector<char>& compressed, std::vector<char> uncompressed = {});
 
+// Uncompress a zlib'ed BLOB held in a raw buffer
+std::vector<char> zlib_uncompress(
+    const char* data, std::size_t size, std::vector<char> uncompressed = {});
+
 // Compress a byte array using zlib
 std::vector<char> zlib_compress(
     const std::vector<char>& uncompressed, std::vector<char> compressed = {});
@@ -0,0 +1,393 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/enginelibrary/folder_import.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <djinterop/enginelibrary.hpp>
+#include <djinterop/enginelibrary/el_track_impl.hpp>
+#include <djinterop/enginelibrary/el_transaction_guard_impl.hpp>
+#include <djinterop/exceptions.hpp>
+#include <djinterop/parallel.hpp>
+#include <djinterop/track_snapshot.hpp>
+#include <djinterop/util.hpp>
+
+namespace djinterop::enginelibrary
+{
+namespace
+{
+namespace fs = std::filesystem;
+
+/// A music file found in the folder tree.
+struct folder_file
+{
+    /// The path of the file, relative to the root folder.
+    fs::path path;
+
+    /// The size of the file in bytes, or -1 if it could not be determined.
+    int64_t size;
+};
+
+/// A crate to be created, identified by its path.
+struct new_crate
+{
+    int64_t id;
+    std::string title;
+    std::string path;
+    int64_t parent_id;
+};
+
+bool is_valid_crate_name(const std::string& name)
+{
+    return !name.empty() && name.find_first_of(';') == std::string::npos;
+}
+
+bool has_wanted_extension(
+    const fs::path& path, const std::vector<std::string>& extensions)
+{
+    if (extensions.empty())
+    {
+        return true;
+    }
+
+    auto extension = get_file_extension(path.filename().string());
+    if (!extension)
+    {
+        return false;
+    }
+
+    std::transform(
+        extension->begin(), extension->end(), extension->begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return std::find(extensions.begin(), extensions.end(), *extension) !=
+           extensions.end();
+}
+
+/// Add a file to a list of files, if it has a wanted extension.
+void add_file(
+    const fs::directory_entry& entry, const fs::path& root,
+    const std::vector<std::string>& extensions,
+    std::vector<folder_file>& files)
+{
+    std::error_code ec;
+    if (!entry.is_regular_file(ec) ||
+        !has_wanted_extension(entry.path(), extensions))
+    {
+        return;
+    }
+
+    auto size = entry.file_size(ec);
+    files.push_back(folder_file{
+        entry.path().lexically_relative(root),
+        ec ? -1 : static_cast<int64_t>(size)});
+}
+
+/// Add the music files in a folder and its subfolders to a list of files.
+///
+/// Subfolders whose names are not valid crate names are not descended into.
+/// Errors in reading individual folders are ignored, so that an unreadable
+/// part of the tree does not prevent the rest from being imported.
+void scan_folder(
+    const fs::path& root, const fs::path& folder,
+    const std::vector<std::string>& extensions,
+    std::vector<folder_file>& files)
+{
+    std::error_code ec;
+    fs::recursive_directory_iterator it{
+        folder, fs::directory_options::skip_permission_denied, ec};
+    for (fs::recursive_directory_iterator end; !ec && it != end;
+         it.increment(ec))
+    {
+        std::error_code entry_ec;
+        if (it->is_directory(entry_ec))
+        {
+            if (!is_valid_crate_name(it->path().filename().string()))
+            {
+                it.disable_recursion_pending();
+            }
+
+            continue;
+        }
+
+        add_file(*it, root, extensions, files);
+    }
+}
+
+/// Find the music files in a folder tree, scanning each folder directly
+/// beneath the root in parallel.
+std::vector<folder_file> scan_folder_tree(
+    executor& exec, const fs::path& root, const folder_import_options& options)
+{
+    std::vector<fs::path> subfolders;
+    std::vector<std::vector<folder_file>> files(1);
+    std::error_code ec;
+    fs::directory_iterator it{
+        root, fs::directory_options::skip_permission_denied, ec};
+    for (fs::directory_iterator end; !ec && it != end; it.increment(ec))
+    {
+        std::error_code entry_ec;
+        if (it->is_directory(entry_ec))
+        {
+            if (is_valid_crate_name(it->path().filename().string()))
+            {
+                subfolders.push_back(it->path());
+            }
+
+            continue;
+        }
+
+        add_file(*it, root, options.extensions, files[0]);
+    }
+
+    files.resize(subfolders.size() + 1);
+    parallel_for(
+        exec, subfolders.size(), options.thread_count, [&](std::size_t i) {
+            scan_folder(root, subfolders[i], options.extensions, files[i + 1]);
+        });
+
+    std::vector<folder_file> all_files;
+    for (auto&& task_files : files)
+    {
+        std::move(
+            task_files.begin(), task_files.end(),
+            std::back_inserter(all_files));
+    }
+
+    std::sort(
+        all_files.begin(), all_files.end(),
+        [](const folder_file& a, const folder_file& b) {
+            return a.path < b.path;
+        });
+    return all_files;
+}
+
+}  // namespace
+
+folder_import_result import_folder_tree(
+    const std::shared_ptr<el_storage>& storage,
+    const std::string& root_directory, const folder_import_options& options)
+{
+    auto root = fs::absolute(fs::path{root_directory}).lexically_normal();
+    if (!root.has_filename())
+    {
+        root = root.parent_path();
+    }
+
+    std::error_code ec;
+    if (!fs::is_directory(root, ec))
+    {
+        throw std::invalid_argument{
+            "Folder to import does not exist: " + root_directory};
+    }
+
+    auto root_name = root.filename().string();
+    if (!is_valid_crate_name(root_name))
+    {
+        throw crate_invalid_name{
+            "Folder name is not a valid crate name", root_name};
+    }
+
+    auto files = scan_folder_tree(*storage->task_executor, root, options);
+    auto database_directory =
+        fs::absolute(fs::path{storage->directory}).lexically_normal();
+
+    // The crate of each folder is identified by its path, and its title and
+    // parent are recorded against it.  Parents sort before their children.
+    auto root_path = root_name + ";";
+    std::map<std::string, std::pair<std::string, std::string>> crates;
+    crates[root_path] = {root_name, ""};
+    std::vector<std::string> file_crate_paths;
+    file_crate_paths.reserve(files.size());
+    for (auto&& file : files)
+    {
+        auto path = root_path;
+        for (auto&& part : file.path.parent_path())
+        {
+            auto parent_path = path;
+            auto title = part.string();
+            path += title + ";";
+            crates.emplace(
+                path, std::make_pair(std::move(title), parent_path));
+        }
+
+        file_crate_paths.push_back(std::move(path));
+    }
+
+    folder_import_result result{};
+
+    // Match each file to an existing track, or else create a track for it.
+    std::unordered_map<std::string, int64_t> track_ids;
+    storage->db << "SELECT id, path FROM Track WHERE path IS NOT NULL "
+                   "ORDER BY id" >>
+        [&](int64_t id, std::string path) {
+            track_ids.emplace(std::move(path), id);
+        };
+
+    std::vector<int64_t> file_track_ids;
+    file_track_ids.reserve(files.size());
+    auto batch_size = std::max<std::size_t>(1, options.batch_size);
+    for (std::size_t begin = 0; begin < files.size(); begin += batch_size)
+    {
+        auto end = std::min(files.size(), begin + batch_size);
+        el_transaction_guard_impl trans{storage};
+        for (auto i = begin; i < end; ++i)
+        {
+            auto absolute_path = root / files[i].path;
+            auto relative =
+                absolute_path.lexically_relative(database_directory);
+            auto relative_path = relative.empty()
+                                     ? absolute_path.generic_string()
+                                     : relative.generic_string();
+
+            auto it = track_ids.find(relative_path);
+            if (it != track_ids.end())
+            {
+                ++result.matched_track_count;
+                file_track_ids.push_back(it->second);
+                continue;
+            }
+
+            track_snapshot snapshot{};
+            snapshot.relative_path = relative_path;
+            if (files[i].size >= 0)
+            {
+                snapshot.file_bytes = files[i].size;
+            }
+
+            auto id = create_track(*storage, encode_track(snapshot));
+            track_ids.emplace(std::move(relative_path), id);
+            result.created_track_ids.push_back(id);
+            file_track_ids.push_back(id);
+        }
+
+        trans.commit();
+    }
+
+    el_transaction_guard_impl trans{storage};
+
+    // Assign IDs to the crates that do not already exist.  Newer schemas
+    // store crates in the `List` table, which does not assign IDs itself, and
+    // so IDs are always chosen in advance.
+    std::unordered_map<std::string, int64_t> crate_ids;
+    storage->db << "SELECT id, path FROM Crate ORDER BY id" >>
+        [&](int64_t id, std::string path) {
+            crate_ids.emplace(std::move(path), id);
+        };
+
+    int64_t next_id;
+    storage->db << "SELECT IFNULL(MAX(id), 0) + 1 FROM Crate" >> next_id;
+
+    std::vector<new_crate> new_crates;
+    std::vector<std::pair<int64_t, int64_t>> new_hierarchy;
+    for (auto&& [path, title_and_parent] : crates)
+    {
+        if (crate_ids.count(path) != 0)
+        {
+            continue;
+        }
+
+        auto id = next_id++;
+        crate_ids[path] = id;
+        auto& parent_path = title_and_parent.second;
+        auto parent_id = parent_path.empty() ? id : crate_ids.at(parent_path);
+        new_crates.push_back(
+            new_crate{id, title_and_parent.first, path, parent_id});
+
+        // Every ancestor of the crate is identified by a prefix of its path.
+        for (auto pos = path.find(';'); pos + 1 < path.size();
+             pos = path.find(';', pos + 1))
+        {
+            new_hierarchy.emplace_back(
+                crate_ids.at(path.substr(0, pos + 1)), id);
+        }
+    }
+
+    storage->db << "CREATE TEMP TABLE folder_crate (id INTEGER PRIMARY KEY, "
+                   "title TEXT, path TEXT, parentId INTEGER)";
+    storage->db << "CREATE TEMP TABLE folder_crate_hierarchy "
+                   "(crateId INTEGER, crateIdChild INTEGER)";
+    storage->db << "CREATE TEMP TABLE folder_crate_track (crateId INTEGER, "
+                   "trackId INTEGER, PRIMARY KEY (crateId, trackId))";
+
+    if (!new_crates.empty())
+    {
+        auto insert = storage->db
+                      << "INSERT INTO temp.folder_crate VALUES (?, ?, ?, ?)";
+        for (auto&& cr : new_crates)
+        {
+            insert << cr.id << cr.title << cr.path << cr.parent_id;
+            insert++;
+        }
+    }
+
+    if (!new_hierarchy.empty())
+    {
+        auto insert =
+            storage->db
+            << "INSERT INTO temp.folder_crate_hierarchy VALUES (?, ?)";
+        for (auto&& [crate_id, child_id] : new_hierarchy)
+        {
+            insert << crate_id << child_id;
+            insert++;
+        }
+    }
+
+    if (!files.empty())
+    {
+        auto insert =
+            storage->db
+            << "INSERT OR IGNORE INTO temp.folder_crate_track VALUES (?, ?)";
+        for (std::size_t i = 0; i < files.size(); ++i)
+        {
+            insert << crate_ids.at(file_crate_paths[i]) << file_track_ids[i];
+            insert++;
+        }
+    }
+
+    storage->db << "INSERT INTO Crate (id, title, path) "
+                   "SELECT id, title, path FROM temp.folder_crate ORDER BY id";
+    storage->db << "INSERT INTO CrateParentList (crateOriginId, crateParentId) "
+                   "SELECT id, parentId FROM temp.folder_crate";
+    storage->db << "INSERT INTO CrateHierarchy (crateId, crateIdChild) "
+                   "SELECT crateId, crateIdChild "
+                   "FROM temp.folder_crate_hierarchy";
+    storage->db << "INSERT INTO CrateTrackList (crateId, trackId) "
+                   "SELECT t.crateId, t.trackId FROM temp.folder_crate_track t "
+                   "WHERE NOT EXISTS (SELECT 1 FROM CrateTrackList l "
+                   "WHERE l.crateId = t.crateId AND l.trackId = t.trackId)";
+
+    storage->db << "DROP TABLE temp.folder_crate";
+    storage->db << "DROP TABLE temp.folder_crate_hierarchy";
+    storage->db << "DROP TABLE temp.folder_crate_track";
+    trans.commit();
+
+    result.root_crate_id = crate_ids.at(root_path);
+    result.created_crate_count = new_crates.size();
+    return result;
+}
+
+}  // namespace djinterop::enginelibrary
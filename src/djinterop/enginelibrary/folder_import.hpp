@@ -0,0 +1,36 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <djinterop/database.hpp>
+
+#include "el_storage.hpp"
+
+namespace djinterop::enginelibrary
+{
+/// Mirror a folder tree of music files as a tree of crates of a storage.
+///
+/// See `database::import_folder_tree()` for details.
+folder_import_result import_folder_tree(
+    const std::shared_ptr<el_storage>& storage,
+    const std::string& root_directory, const folder_import_options& options);
+
+}  // namespace djinterop::enginelibrary
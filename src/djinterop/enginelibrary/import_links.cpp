@@ -0,0 +1,95 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/enginelibrary/import_links.hpp>
+
+#include <memory>
+
+#include <djinterop/enginelibrary/attached_database.hpp>
+
+namespace djinterop::enginelibrary
+{
+namespace
+{
+/// The ID of the source track with the same path as a track of the storage.
+const std::string source_id_sql =
+    "(SELECT MIN(s.id) FROM import_source.Track s WHERE s.path = Track.path)";
+
+/// Condition selecting the tracks with a counterpart in the source database
+/// that are not yet linked to it, given the UUID of the source database.
+const std::string unlinked_sql =
+    "Track.path IN (SELECT s.path FROM import_source.Track s) AND "
+    "(Track.isExternalTrack IS NOT 1 OR "
+    "Track.uuidOfExternalDatabase IS NOT ? OR "
+    "Track.idTrackInExternalDatabase IS NOT " +
+    source_id_sql + ")";
+
+}  // namespace
+
+std::size_t link_imported_tracks(
+    const std::shared_ptr<el_storage>& storage,
+    const std::string& source_directory)
+{
+    attached_database source{
+        *storage, "import_source", source_directory, "m.db"};
+    auto source_uuid = source.uuid();
+
+    // The tracks to be linked are read first, only so that any prefetched
+    // data for them can be discarded.
+    std::vector<int64_t> ids;
+    storage->db << "SELECT id FROM music.Track WHERE " + unlinked_sql
+                << source_uuid >>
+        [&](int64_t id) { ids.push_back(id); };
+    if (ids.empty())
+    {
+        return 0;
+    }
+
+    storage->db << "UPDATE music.Track SET isExternalTrack = 1, "
+                   "uuidOfExternalDatabase = ?, idTrackInExternalDatabase = " +
+                       source_id_sql + " WHERE " + unlinked_sql
+                << source_uuid << source_uuid;
+
+    for (auto id : ids)
+    {
+        storage->invalidate_prefetched(id);
+    }
+
+    return ids.size();
+}
+
+std::vector<imported_track_link> resolve_imported_tracks(
+    const std::shared_ptr<el_storage>& storage,
+    const std::string& source_directory)
+{
+    attached_database source{
+        *storage, "import_source", source_directory, "m.db"};
+
+    std::vector<imported_track_link> links;
+    storage->db << "SELECT t.id, s.id FROM music.Track t "
+                   "JOIN import_source.Track s "
+                   "ON s.id = t.idTrackInExternalDatabase "
+                   "WHERE t.isExternalTrack = 1 AND "
+                   "t.uuidOfExternalDatabase = ? ORDER BY t.id"
+                << source.uuid() >>
+        [&](int64_t id, int64_t source_id) {
+            links.push_back(imported_track_link{id, source_id});
+        };
+    return links;
+}
+
+}  // namespace djinterop::enginelibrary
@@ -0,0 +1,47 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <djinterop/database.hpp>
+
+#include "el_storage.hpp"
+
+namespace djinterop::enginelibrary
+{
+/// Link the tracks of a storage to the tracks with the same paths in the
+/// database in another directory.
+///
+/// See `database::link_imported_tracks()` for details.
+std::size_t link_imported_tracks(
+    const std::shared_ptr<el_storage>& storage,
+    const std::string& source_directory);
+
+/// Resolve the links of the tracks of a storage to the database in another
+/// directory.
+///
+/// See `database::imported_tracks()` for details.
+std::vector<imported_track_link> resolve_imported_tracks(
+    const std::shared_ptr<el_storage>& storage,
+    const std::string& source_directory);
+
+}  // namespace djinterop::enginelibrary
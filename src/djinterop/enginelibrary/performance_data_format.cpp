@@ -16,14 +16,17 @@
  */
 
 #include <chrono>
+#include <cstddef>
 #include <iomanip>
 #include <numeric>
+#include <utility>
 #include <vector>
 
 #include <djinterop/enginelibrary/encode_decode_utils.hpp>
 #include <djinterop/enginelibrary/performance_data_format.hpp>
 #include <djinterop/musical_key.hpp>
 #include <djinterop/optional.hpp>
+#include <djinterop/util.hpp>
 
 namespace djinterop
 {
@@ -70,14 +73,15 @@ char* encode_beatgrid(const std::vector<beatgrid_marker>& beatgrid, char* ptr)
     return ptr;
 }
 
-std::pair<std::vector<beatgrid_marker>, const char*> decode_beatgrid(
-    const char* ptr, const char* end)
+const char* decode_beatgrid(
+    const char* ptr, const char* end, std::vector<beatgrid_marker>& result)
 {
     int64_t count;
     std::tie(count, ptr) = decode_int64_be(ptr);
     if (count == 0)
     {
-        return {{}, ptr};
+        result.clear();
+        return ptr;
     }
     if (count < 2)
     {
@@ -93,7 +97,7 @@ std::pair<std::vector<beatgrid_marker>, const char*> decode_beatgrid(
     {
         throw std::invalid_argument{"Beat data grid is missing data"};
     }
-    std::vector<beatgrid_marker> result(count);
+    result.resize(count);
     int32_t beats_until_next_marker;
     typedef std::vector<beatgrid_marker>::size_type vec_size_t;
     for (vec_size_t i = 0; i < result.size(); ++i)
@@ -127,7 +131,14 @@ std::pair<std::vector<beatgrid_marker>, const char*> decode_beatgrid(
         throw std::invalid_argument{
             "Beat data grid promised non-existent marker"};
     }
-    return {std::move(result), ptr};
+    return ptr;
+}
+
+// Scratch buffer for uncompressed data, reused across calls on each thread
+std::vector<char>& scratch_buffer()
+{
+    thread_local std::vector<char> buffer;
+    return buffer;
 }
 
 }  // namespace
@@ -135,8 +146,17 @@ std::pair<std::vector<beatgrid_marker>, const char*> decode_beatgrid(
 // Encode beat data into a byte array
 std::vector<char> beat_data::encode() const
 {
-    std::vector<char> uncompressed(
-        33 + 24 * (default_beatgrid.size() + adjusted_beatgrid.size()));
+    std::vector<char> blob;
+    encode(blob);
+    return blob;
+}
+
+// Encode beat data into a byte array, reusing its storage
+void beat_data::encode(std::vector<char>& blob) const
+{
+    auto& uncompressed = scratch_buffer();
+    uncompressed.assign(
+        33 + 24 * (default_beatgrid.size() + adjusted_beatgrid.size()), 0);
     auto ptr = uncompressed.data();
     const auto end = ptr + uncompressed.size();
 
@@ -160,14 +180,23 @@ std::vector<char> beat_data::encode() const
         // TODO (haslersn): This shouldn't be possible to happen. How to handle?
     }
 
-    return zlib_compress(uncompressed);
+    blob = zlib_compress(uncompressed, std::move(blob));
 }
 
 // Extract beat data from a byte array
 beat_data beat_data::decode(const std::vector<char>& compressed_data)
 {
-    const auto raw_data = zlib_uncompress(compressed_data);
-    auto ptr = raw_data.data();
+    beat_data result;
+    decode(compressed_data.data(), compressed_data.size(), result);
+    return result;
+}
+
+// Extract beat data from a raw buffer, reusing storage
+void beat_data::decode(const char* data, std::size_t size, beat_data& result)
+{
+    auto& raw_data = scratch_buffer();
+    raw_data = zlib_uncompress(data, size, std::move(raw_data));
+    const char* ptr = raw_data.data();
     const auto end = ptr + raw_data.size();
 
     if (raw_data.size() < 33)
@@ -176,8 +205,6 @@ beat_data beat_data::decode(const std::vector<char>& compressed_data)
             "Beat data has less than the minimum length of 33 bytes"};
     }
 
-    beat_data result;
-
     sampling_info sampling;
     std::tie(sampling.sample_rate, ptr) = decode_double_be(ptr);
     std::tie(sampling.sample_count, ptr) = decode_double_be(ptr);
@@ -193,18 +220,17 @@ beat_data beat_data::decode(const std::vector<char>& compressed_data)
 
     try
     {
-        std::vector<beatgrid_marker> default_beatgrid;
-        std::vector<beatgrid_marker> adjusted_beatgrid;
-        std::tie(default_beatgrid, ptr) = decode_beatgrid(ptr, end);
-        std::tie(adjusted_beatgrid, ptr) = decode_beatgrid(ptr, end);
+        auto grid_ptr = decode_beatgrid(ptr, end, result.default_beatgrid);
+        grid_ptr = decode_beatgrid(grid_ptr, end, result.adjusted_beatgrid);
         // If there's an exception, then the following will intentionally not be
         // executed.
-        result.default_beatgrid = std::move(default_beatgrid);
-        result.adjusted_beatgrid = std::move(adjusted_beatgrid);
+        ptr = grid_ptr;
     }
     catch (const std::invalid_argument& e)
     {
         // TODO (haslersn): print a warning with e.what().
+        result.default_beatgrid.clear();
+        result.adjusted_beatgrid.clear();
     }
 
     // Beat data has known to be encoded with 9 additional zero bytes at the
@@ -220,14 +246,21 @@ beat_data beat_data::decode(const std::vector<char>& compressed_data)
 
         ptr++;
     }
-
-    return result;
 }
 
 // Encode high-resolution waveform data into a byte array
 std::vector<char> high_res_waveform_data::encode() const
 {
-    std::vector<char> uncompressed(30 + 6 * waveform.size());
+    std::vector<char> blob;
+    encode(blob);
+    return blob;
+}
+
+// Encode high-resolution waveform data into a byte array, reusing its storage
+void high_res_waveform_data::encode(std::vector<char>& blob) const
+{
+    auto& uncompressed = scratch_buffer();
+    uncompressed.assign(30 + 6 * waveform.size(), 0);
     auto ptr = uncompressed.data();
     const auto end = ptr + uncompressed.size();
 
@@ -272,15 +305,25 @@ std::vector<char> high_res_waveform_data::encode() const
         // TODO (haslersn): This shouldn't be possible to happen. How to handle?
     }
 
-    return zlib_compress(uncompressed);
+    blob = zlib_compress(uncompressed, std::move(blob));
 }
 
 // Extract high-resolution waveform from a byte array
 high_res_waveform_data high_res_waveform_data::decode(
     const std::vector<char>& compressed_data)
 {
-    const auto raw_data = zlib_uncompress(compressed_data);
-    auto ptr = raw_data.data();
+    high_res_waveform_data result;
+    decode(compressed_data.data(), compressed_data.size(), result);
+    return result;
+}
+
+// Extract high-resolution waveform from a raw buffer, reusing storage
+void high_res_waveform_data::decode(
+    const char* data, std::size_t size, high_res_waveform_data& result)
+{
+    auto& raw_data = scratch_buffer();
+    raw_data = zlib_uncompress(data, size, std::move(raw_data));
+    const char* ptr = raw_data.data();
     const auto end = ptr + raw_data.size();
 
     if (raw_data.size() < 30)
@@ -291,7 +334,6 @@ high_res_waveform_data high_res_waveform_data::decode(
     }
 
     // Work out how many entries we have
-    high_res_waveform_data result;
     int64_t num_entries_1, num_entries_2;
     std::tie(num_entries_1, ptr) = decode_int64_be(ptr);
     std::tie(num_entries_2, ptr) = decode_int64_be(ptr);
@@ -330,12 +372,18 @@ high_res_waveform_data high_res_waveform_data::decode(
             "Internal error in high_res_waveform_data::decode()"};
         // TODO (haslersn): This shouldn't be possible to happen. How to handle?
     }
-
-    return result;
 }
 
 // Encode loops into a byte array
 std::vector<char> loops_data::encode() const
+{
+    std::vector<char> blob;
+    encode(blob);
+    return blob;
+}
+
+// Encode loops into a byte array, reusing its storage
+void loops_data::encode(std::vector<char>& blob) const
 {
     auto total_label_length = std::accumulate(
         loops.begin(), loops.end(), int64_t{0},
@@ -343,9 +391,9 @@ std::vector<char> loops_data::encode() const
             return x + (loop ? loop->label.length() : 0);
         });
 
-    std::vector<char> uncompressed(192 + total_label_length);
-    auto ptr = uncompressed.data();
-    const auto end = ptr + uncompressed.size();
+    blob.assign(192 + total_label_length, 0);
+    auto ptr = blob.data();
+    const auto end = ptr + blob.size();
 
     ptr = encode_int64_le(loops.size(), ptr);  // 8
 
@@ -390,17 +438,24 @@ std::vector<char> loops_data::encode() const
     }
 
     // Note that 'loops' is not compressed
-    return uncompressed;
 }
 
 // Extract loops from a byte array
 loops_data loops_data::decode(const std::vector<char>& raw_data)
+{
+    loops_data result;
+    decode(raw_data.data(), raw_data.size(), result);
+    return result;
+}
+
+// Extract loops from a raw buffer, reusing storage
+void loops_data::decode(const char* data, std::size_t size, loops_data& result)
 {
     // Note that loops are not compressed, unlike all the other fields
-    auto ptr = raw_data.data();
-    const auto end = ptr + raw_data.size();
+    auto ptr = data;
+    const auto end = ptr + size;
 
-    if (raw_data.size() < 192)
+    if (size < 192)
     {
         throw std::invalid_argument{
             "Loops data has less than the minimum length of 192 bytes"};
@@ -416,7 +471,6 @@ loops_data loops_data::decode(const std::vector<char>& raw_data)
         }
     }
 
-    loops_data result;
     for (auto& loop : result.loops)
     {
         uint8_t label_length;
@@ -458,6 +512,7 @@ loops_data loops_data::decode(const std::vector<char>& raw_data)
         }
         else
         {
+            loop.reset();
             ptr += 22;
         }
     }
@@ -466,14 +521,21 @@ loops_data loops_data::decode(const std::vector<char>& raw_data)
     {
         throw std::invalid_argument{"Loops data has too much data"};
     }
-
-    return result;
 }
 
 // Encode overview waveform data into a byte array
 std::vector<char> overview_waveform_data::encode() const
 {
-    std::vector<char> uncompressed(27 + 3 * waveform.size());
+    std::vector<char> blob;
+    encode(blob);
+    return blob;
+}
+
+// Encode overview waveform data into a byte array, reusing its storage
+void overview_waveform_data::encode(std::vector<char>& blob) const
+{
+    auto& uncompressed = scratch_buffer();
+    uncompressed.assign(27 + 3 * waveform.size(), 0);
     auto ptr = uncompressed.data();
     const auto end = ptr + uncompressed.size();
 
@@ -507,15 +569,25 @@ std::vector<char> overview_waveform_data::encode() const
         // TODO (haslersn): This shouldn't be possible to happen. How to handle?
     }
 
-    return zlib_compress(uncompressed);
+    blob = zlib_compress(uncompressed, std::move(blob));
 }
 
 // Extract overview waveform from a byte array
 overview_waveform_data overview_waveform_data::decode(
     const std::vector<char>& compressed_data)
 {
-    const auto raw_data = zlib_uncompress(compressed_data);
-    auto ptr = raw_data.data();
+    overview_waveform_data result;
+    decode(compressed_data.data(), compressed_data.size(), result);
+    return result;
+}
+
+// Extract overview waveform from a raw buffer, reusing storage
+void overview_waveform_data::decode(
+    const char* data, std::size_t size, overview_waveform_data& result)
+{
+    auto& raw_data = scratch_buffer();
+    raw_data = zlib_uncompress(data, size, std::move(raw_data));
+    const char* ptr = raw_data.data();
     const auto end = ptr + raw_data.size();
 
     if (raw_data.size() < 27)
@@ -526,7 +598,6 @@ overview_waveform_data overview_waveform_data::decode(
     }
 
     // Work out how many entries we have
-    overview_waveform_data result;
     int64_t num_entries_1, num_entries_2;
     std::tie(num_entries_1, ptr) = decode_int64_be(ptr);
     std::tie(num_entries_2, ptr) = decode_int64_be(ptr);
@@ -562,12 +633,18 @@ overview_waveform_data overview_waveform_data::decode(
             "Internal error in overview_waveform_data::decode()"};
         // TODO (haslersn): This shouldn't be possible to happen. How to handle?
     }
-
-    return result;
 }
 
 // Encode quick cues data into a byte array
 std::vector<char> quick_cues_data::encode() const
+{
+    std::vector<char> blob;
+    encode(blob);
+    return blob;
+}
+
+// Encode quick cues data into a byte array, reusing its storage
+void quick_cues_data::encode(std::vector<char>& blob) const
 {
     auto total_label_length = std::accumulate(
         hot_cues.begin(), hot_cues.end(), int64_t{0},
@@ -576,7 +653,8 @@ std::vector<char> quick_cues_data::encode() const
         });
 
     // Work out total length of all cue labels
-    std::vector<char> uncompressed(129 + total_label_length);
+    auto& uncompressed = scratch_buffer();
+    uncompressed.assign(129 + total_label_length, 0);
     auto ptr = uncompressed.data();
     const auto end = ptr + uncompressed.size();
 
@@ -622,15 +700,25 @@ std::vector<char> quick_cues_data::encode() const
         // TODO (haslersn): This shouldn't be possible to happen. How to handle?
     }
 
-    return zlib_compress(uncompressed);
+    blob = zlib_compress(uncompressed, std::move(blob));
 }
 
 // Extract quick cues data from a byte array
 quick_cues_data quick_cues_data::decode(
     const std::vector<char>& compressed_data)
 {
-    const auto raw_data = zlib_uncompress(compressed_data);
-    auto ptr = raw_data.data();
+    quick_cues_data result;
+    decode(compressed_data.data(), compressed_data.size(), result);
+    return result;
+}
+
+// Extract quick cues data from a raw buffer, reusing storage
+void quick_cues_data::decode(
+    const char* data, std::size_t size, quick_cues_data& result)
+{
+    auto& raw_data = scratch_buffer();
+    raw_data = zlib_uncompress(data, size, std::move(raw_data));
+    const char* ptr = raw_data.data();
     const auto end = ptr + raw_data.size();
 
     if (raw_data.size() < 129)
@@ -649,7 +737,6 @@ quick_cues_data quick_cues_data::decode(
         }
     }
 
-    quick_cues_data result;
     for (auto& hot_cue : result.hot_cues)
     {
         uint8_t label_length;
@@ -676,6 +763,7 @@ quick_cues_data quick_cues_data::decode(
         }
         else
         {
+            hot_cue.reset();
             ptr += 12;
         }
     }
@@ -698,14 +786,21 @@ quick_cues_data quick_cues_data::decode(
         throw std::invalid_argument{"Quick cues data has too much data"};
         // TODO (haslersn): This shouldn't be possible to happen. How to handle?
     }
-
-    return result;
 }
 
 // Encode track data into a byte array
 std::vector<char> track_data::encode() const
 {
-    std::vector<char> uncompressed(28);  // Track data has fixed size
+    std::vector<char> blob;
+    encode(blob);
+    return blob;
+}
+
+// Encode track data into a byte array, reusing its storage
+void track_data::encode(std::vector<char>& blob) const
+{
+    auto& uncompressed = scratch_buffer();
+    uncompressed.assign(28, 0);  // Track data has fixed size
     auto ptr = uncompressed.data();
     const auto end = ptr + uncompressed.size();
 
@@ -728,14 +823,23 @@ std::vector<char> track_data::encode() const
         // TODO (haslersn): This shouldn't be possible to happen. How to handle?
     }
 
-    return zlib_compress(uncompressed);
+    blob = zlib_compress(uncompressed, std::move(blob));
 }
 
 // Extract track data from a byte array
-track_data track_data::decode(const std::vector<char>& compressed_track_data)
+track_data track_data::decode(const std::vector<char>& compressed_data)
 {
-    const auto raw_data = zlib_uncompress(compressed_track_data);
-    auto ptr = raw_data.data();
+    track_data result;
+    decode(compressed_data.data(), compressed_data.size(), result);
+    return result;
+}
+
+// Extract track data from a raw buffer, reusing storage
+void track_data::decode(const char* data, std::size_t size, track_data& result)
+{
+    auto& raw_data = scratch_buffer();
+    raw_data = zlib_uncompress(data, size, std::move(raw_data));
+    const char* ptr = raw_data.data();
     const auto end = ptr + raw_data.size();
 
     if (raw_data.size() != 28)
@@ -744,8 +848,6 @@ track_data track_data::decode(const std::vector<char>& compressed_track_data)
             "Track data doesn't have expected length of 28 bytes"};
     }
 
-    track_data result;
-
     sampling_info sampling;
     std::tie(sampling.sample_rate, ptr) = decode_double_be(ptr);
     std::tie(sampling.sample_count, ptr) = decode_int64_be(ptr);
@@ -765,8 +867,41 @@ track_data track_data::decode(const std::vector<char>& compressed_track_data)
         throw std::runtime_error{"Internal error in track_data::decode()"};
         // TODO (haslersn): This shouldn't be possible to happen. How to handle?
     }
+}
 
-    return result;
+/// Calculate an overview waveform from a high-resolution waveform.
+///
+/// An overview waveform always has 1024 entries.  Each one is the maximum of
+/// the high-resolution entries in the corresponding bucket, so that short
+/// transients are preserved.  If the high-resolution waveform has fewer than
+/// 1024 entries, some of them are repeated instead.
+std::vector<waveform_entry> calculate_overview_waveform(
+    const std::vector<waveform_entry>& waveform)
+{
+    std::vector<waveform_entry> overview_waveform;
+    if (waveform.empty())
+    {
+        return overview_waveform;
+    }
+
+    overview_waveform.reserve(1024);
+    auto size = waveform.size();
+    for (std::size_t i = 0; i < 1024; ++i)
+    {
+        auto begin = size * i / 1024;
+        auto end = size * (i + 1) / 1024;
+        if (begin == end)
+        {
+            overview_waveform.push_back(waveform[size * (2 * i + 1) / 2048]);
+        }
+        else
+        {
+            overview_waveform.push_back(max_waveform_entry(
+                waveform.data() + begin, waveform.data() + end));
+        }
+    }
+
+    return overview_waveform;
 }
 
 }  // namespace enginelibrary
@@ -0,0 +1,285 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/enginelibrary/relink.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include <djinterop/enginelibrary.hpp>
+#include <djinterop/enginelibrary/el_transaction_guard_impl.hpp>
+#include <djinterop/optional.hpp>
+#include <djinterop/parallel.hpp>
+#include <djinterop/util.hpp>
+
+namespace djinterop::enginelibrary
+{
+namespace
+{
+namespace fs = std::filesystem;
+
+/// A track with a recorded path.
+struct track_location
+{
+    int64_t id;
+    std::string path;
+    std::string filename;
+    stdx::optional<int64_t> file_bytes;
+};
+
+/// A file that may be the file of a missing track.
+struct candidate_file
+{
+    fs::path path;
+    std::string filename;
+
+    /// The size of the file in bytes, or -1 if it could not be determined.
+    int64_t size;
+
+    bool operator<(const candidate_file& other) const
+    {
+        return path < other.path;
+    }
+
+    bool operator==(const candidate_file& other) const
+    {
+        return path == other.path;
+    }
+};
+
+/// Read the location of every track with a recorded path.
+std::vector<track_location> get_track_locations(el_storage& storage)
+{
+    // The file size is only recorded from schema 1.15.0 onwards.
+    std::string file_bytes_column =
+        storage.version >= version_1_15_0 ? "fileBytes" : "NULL";
+
+    std::vector<track_location> tracks;
+    storage.db << "SELECT id, path, filename, " + file_bytes_column +
+                      " FROM Track WHERE path IS NOT NULL ORDER BY id" >>
+        [&](int64_t id, std::string path,
+            stdx::optional<std::string> filename,
+            stdx::optional<int64_t> file_bytes) {
+            auto name = filename ? std::move(*filename) : get_filename(path);
+            if (file_bytes && *file_bytes <= 0)
+            {
+                file_bytes = stdx::nullopt;
+            }
+
+            tracks.push_back(track_location{
+                id, std::move(path), std::move(name), file_bytes});
+        };
+    return tracks;
+}
+
+/// Add the files in a directory and its subdirectories whose names are wanted
+/// to a list of candidates.
+///
+/// Errors in reading individual directories are ignored, so that an
+/// unreadable part of a drive does not prevent the rest from being scanned.
+void scan_directory(
+    const fs::path& directory,
+    const std::unordered_set<std::string>& wanted_filenames,
+    std::vector<candidate_file>& candidates)
+{
+    std::error_code ec;
+    fs::recursive_directory_iterator it{
+        directory, fs::directory_options::skip_permission_denied, ec};
+    for (fs::recursive_directory_iterator end; !ec && it != end;
+         it.increment(ec))
+    {
+        std::error_code entry_ec;
+        if (!it->is_regular_file(entry_ec))
+        {
+            continue;
+        }
+
+        auto filename = it->path().filename().string();
+        if (wanted_filenames.count(filename) == 0)
+        {
+            continue;
+        }
+
+        auto size = it->file_size(entry_ec);
+        candidates.push_back(candidate_file{
+            it->path(), std::move(filename),
+            entry_ec ? -1 : static_cast<int64_t>(size)});
+    }
+}
+
+}  // namespace
+
+relink_result relink_tracks(
+    const std::shared_ptr<el_storage>& storage,
+    const std::vector<std::string>& directories,
+    const relink_options& options)
+{
+    auto& exec = *storage->task_executor;
+    auto database_directory =
+        fs::absolute(fs::path{storage->directory}).lexically_normal();
+
+    // Find the tracks whose files do not exist at their recorded paths.
+    auto tracks = get_track_locations(*storage);
+    std::vector<char> is_missing(tracks.size());
+    parallel_for(exec, tracks.size(), options.thread_count, [&](std::size_t i) {
+        std::error_code ec;
+        is_missing[i] = !fs::exists(
+            database_directory / fs::path{tracks[i].path}, ec);
+    });
+
+    std::vector<track_location> missing;
+    std::unordered_set<std::string> wanted_filenames;
+    for (std::size_t i = 0; i < tracks.size(); ++i)
+    {
+        if (is_missing[i])
+        {
+            wanted_filenames.insert(tracks[i].filename);
+            missing.push_back(std::move(tracks[i]));
+        }
+    }
+
+    relink_result result;
+    if (missing.empty())
+    {
+        return result;
+    }
+
+    // Split the candidate directories into their immediate subdirectories,
+    // which are scanned in parallel, and the files directly within them.
+    std::vector<fs::path> subdirectories;
+    std::vector<std::vector<candidate_file>> candidates(1);
+    for (auto&& directory : directories)
+    {
+        auto root = fs::absolute(fs::path{directory}).lexically_normal();
+        std::error_code ec;
+        fs::directory_iterator it{
+            root, fs::directory_options::skip_permission_denied, ec};
+        for (fs::directory_iterator end; !ec && it != end; it.increment(ec))
+        {
+            std::error_code entry_ec;
+            if (it->is_directory(entry_ec))
+            {
+                subdirectories.push_back(it->path());
+                continue;
+            }
+
+            auto filename = it->path().filename().string();
+            if (it->is_regular_file(entry_ec) &&
+                wanted_filenames.count(filename) != 0)
+            {
+                auto size = it->file_size(entry_ec);
+                candidates[0].push_back(candidate_file{
+                    it->path(), std::move(filename),
+                    entry_ec ? -1 : static_cast<int64_t>(size)});
+            }
+        }
+    }
+
+    candidates.resize(subdirectories.size() + 1);
+    parallel_for(
+        exec, subdirectories.size(), options.thread_count,
+        [&](std::size_t i) {
+            scan_directory(
+                subdirectories[i], wanted_filenames, candidates[i + 1]);
+        });
+
+    // Index the candidates by filename.  Directories that overlap may yield
+    // the same file more than once.
+    std::unordered_map<std::string, std::vector<candidate_file>> index;
+    for (auto&& task_candidates : candidates)
+    {
+        for (auto&& candidate : task_candidates)
+        {
+            index[candidate.filename].push_back(std::move(candidate));
+        }
+    }
+
+    for (auto&& entry : index)
+    {
+        auto& files = entry.second;
+        std::sort(files.begin(), files.end());
+        files.erase(std::unique(files.begin(), files.end()), files.end());
+    }
+
+    auto to_relative_path = [&](const fs::path& path) {
+        auto relative = path.lexically_relative(database_directory);
+        return relative.empty() ? path.generic_string()
+                                : relative.generic_string();
+    };
+
+    for (auto&& track : missing)
+    {
+        std::vector<std::string> matches;
+        auto it = index.find(track.filename);
+        if (it != index.end())
+        {
+            for (auto&& candidate : it->second)
+            {
+                if (!track.file_bytes || candidate.size < 0 ||
+                    candidate.size == *track.file_bytes)
+                {
+                    matches.push_back(to_relative_path(candidate.path));
+                }
+            }
+        }
+
+        if (matches.empty())
+        {
+            result.unmatched.push_back(track.id);
+        }
+        else if (matches.size() == 1)
+        {
+            result.relinked.push_back(
+                relinked_track{track.id, std::move(matches.front())});
+        }
+        else
+        {
+            result.ambiguous.push_back(
+                ambiguous_relink{track.id, std::move(matches)});
+        }
+    }
+
+    if (result.relinked.empty())
+    {
+        return result;
+    }
+
+    {
+        el_transaction_guard_impl trans{storage};
+        auto update = storage->db << "UPDATE Track SET path = ? WHERE id = ?";
+        for (auto&& relinked : result.relinked)
+        {
+            update << relinked.relative_path << relinked.id;
+            update++;
+        }
+
+        trans.commit();
+    }
+
+    for (auto&& relinked : result.relinked)
+    {
+        storage->invalidate_prefetched(relinked.id);
+    }
+
+    return result;
+}
+
+}  // namespace djinterop::enginelibrary
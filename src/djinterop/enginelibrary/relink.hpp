@@ -0,0 +1,39 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <djinterop/database.hpp>
+
+#include "el_storage.hpp"
+
+namespace djinterop::enginelibrary
+{
+/// Relink the tracks of a storage whose files are missing to files found in
+/// the given directories.
+///
+/// See `database::relink_tracks()` for details.
+relink_result relink_tracks(
+    const std::shared_ptr<el_storage>& storage,
+    const std::vector<std::string>& directories,
+    const relink_options& options);
+
+}  // namespace djinterop::enginelibrary
@@ -0,0 +1,161 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/enginelibrary/track_analysis.hpp>
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include <djinterop/enginelibrary/el_transaction_guard_impl.hpp>
+#include <djinterop/enginelibrary/track_utils.hpp>
+#include <djinterop/optional.hpp>
+
+namespace djinterop::enginelibrary
+{
+std::vector<analysis_job> find_unanalyzed_tracks(el_storage& storage)
+{
+    std::vector<analysis_job> jobs;
+    storage.db << "SELECT t.id, IFNULL(t.path, ''), p.trackData FROM Track t "
+                  "LEFT JOIN PerformanceData p ON p.id = t.id ORDER BY t.id" >>
+        [&](int64_t id, std::string path, std::vector<char> track_blob) {
+            if (!track_blob.empty() &&
+                track_data::decode(track_blob).sampling)
+            {
+                return;
+            }
+
+            jobs.push_back(analysis_job{id, std::move(path)});
+        };
+    return jobs;
+}
+
+std::size_t write_analysis_results(
+    const std::shared_ptr<el_storage>& storage,
+    const std::vector<analysis_results>& results,
+    bool replace_adjusted_beatgrids)
+{
+    if (results.empty())
+    {
+        return 0;
+    }
+
+    std::size_t written = 0;
+    el_transaction_guard_impl trans{storage};
+    auto update_track = storage->db
+                        << "UPDATE Track SET length = ?, lengthCalculated = ?, "
+                           "bpm = IFNULL(?, bpm), "
+                           "bpmAnalyzed = IFNULL(?, bpmAnalyzed) WHERE id = ?";
+    for (auto&& result : results)
+    {
+        auto sample_rate = static_cast<int64_t>(result.sampling.sample_rate);
+        auto sample_count = result.sampling.sample_count;
+        stdx::optional<int64_t> secs;
+        if (sample_rate != 0)
+        {
+            secs = static_cast<int64_t>(
+                result.sampling.sample_count / result.sampling.sample_rate);
+        }
+
+        stdx::optional<int64_t> ceiled_bpm;
+        if (result.bpm)
+        {
+            ceiled_bpm = static_cast<int64_t>(std::ceil(*result.bpm));
+        }
+
+        // Tracks removed since their files were analysed are not updated.
+        update_track << secs << secs << ceiled_bpm << result.bpm << result.id;
+        update_track++;
+        if (sqlite3_changes(storage->db.connection().get()) == 0)
+        {
+            continue;
+        }
+
+        // String metadata, type 10, is the duration encoded as "MM:SS".
+        stdx::optional<std::string> length_mm_ss;
+        if (secs)
+        {
+            std::ostringstream oss;
+            oss << std::setw(2) << std::setfill('0');
+            oss << (*secs / 60);
+            oss << ":";
+            oss << (*secs % 60);
+            length_mm_ss = oss.str();
+        }
+
+        storage->set_meta_data(
+            result.id, metadata_str_type::duration_mm_ss, length_mm_ss);
+
+        // Data not produced by analysis, such as cues, loops and the key, is
+        // carried over from any existing performance data.
+        auto row = storage->get_performance_data(result.id);
+        auto sampling = sample_rate != 0 ? stdx::make_optional(result.sampling)
+                                         : stdx::nullopt;
+
+        auto track_d = row.track_performance_data.value_or(track_data{});
+        track_d.sampling = sampling;
+        track_d.average_loudness = result.average_loudness.value_or(0) == 0
+                                       ? stdx::nullopt
+                                       : result.average_loudness;
+
+        auto beat_d = row.beats.value_or(beat_data{});
+        beat_d.sampling = sampling;
+        if (result.bpm)
+        {
+            beat_d.default_beatgrid = result.beatgrid;
+
+            // An existing adjusted beatgrid may have been corrected by hand.
+            if (replace_adjusted_beatgrids || beat_d.adjusted_beatgrid.empty())
+            {
+                beat_d.adjusted_beatgrid = result.beatgrid;
+            }
+        }
+
+        auto high_res_waveform_d =
+            row.high_res_waveform.value_or(high_res_waveform_data{});
+        auto overview_waveform_d =
+            row.overview_waveform.value_or(overview_waveform_data{});
+        if (!result.waveform.empty())
+        {
+            overview_waveform_d.samples_per_entry =
+                util::calculate_overview_waveform_samples_per_entry(
+                    sample_rate, sample_count);
+            overview_waveform_d.waveform =
+                calculate_overview_waveform(result.waveform);
+            high_res_waveform_d.samples_per_entry =
+                util::waveform_quantisation_number(sample_rate);
+            high_res_waveform_d.waveform = result.waveform;
+        }
+
+        auto is_analyzed = 1;
+        storage->set_performance_data(
+            result.id, is_analyzed, row.is_rendered, track_d,
+            high_res_waveform_d, overview_waveform_d, beat_d,
+            row.quick_cues.value_or(quick_cues_data{}),
+            row.loops.value_or(loops_data{}), row.has_serato_values,
+            row.has_rekordbox_values, row.has_traktor_values);
+        storage->invalidate_prefetched(result.id);
+        ++written;
+    }
+
+    trans.commit();
+    return written;
+}
+
+}  // namespace djinterop::enginelibrary
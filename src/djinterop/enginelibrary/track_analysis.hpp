@@ -0,0 +1,44 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <djinterop/impl/database_impl.hpp>
+
+#include "el_storage.hpp"
+
+namespace djinterop::enginelibrary
+{
+/// Find the tracks of a storage that have no sampling information, with a
+/// single query.
+std::vector<analysis_job> find_unanalyzed_tracks(el_storage& storage);
+
+/// Write the results of analysing the files of tracks to a storage, in a
+/// single transaction, returning the number of tracks written.
+///
+/// Each track's performance data is read, updated and written back once.
+/// Results for tracks that no longer exist are ignored.
+std::size_t write_analysis_results(
+    const std::shared_ptr<el_storage>& storage,
+    const std::vector<analysis_results>& results,
+    bool replace_adjusted_beatgrids);
+
+}  // namespace djinterop::enginelibrary
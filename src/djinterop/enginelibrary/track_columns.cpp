@@ -0,0 +1,247 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/enginelibrary/track_columns.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <djinterop/enginelibrary/metadata_types.hpp>
+#include <djinterop/optional.hpp>
+
+namespace djinterop::enginelibrary
+{
+namespace
+{
+const double missing_double = std::numeric_limits<double>::quiet_NaN();
+
+const int32_t missing_int = -1;
+
+/// Builds a dictionary-encoded column of strings, one track at a time.
+class string_column_builder
+{
+public:
+    explicit string_column_builder(std::size_t track_count)
+    {
+        column_.codes.assign(track_count, missing_int);
+    }
+
+    void set(std::size_t index, std::string value)
+    {
+        auto next_code = static_cast<int32_t>(column_.dictionary.size());
+        auto [iter, inserted] =
+            codes_by_value_.emplace(std::move(value), next_code);
+        if (inserted)
+        {
+            column_.dictionary.push_back(iter->first);
+        }
+
+        column_.codes[index] = iter->second;
+    }
+
+    /// Sort the dictionary, renumbering the codes to match.
+    string_column finish()
+    {
+        auto& dictionary = column_.dictionary;
+        std::vector<int32_t> order(dictionary.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](int32_t a, int32_t b) {
+            return dictionary[a] < dictionary[b];
+        });
+
+        std::vector<int32_t> new_codes(order.size());
+        std::vector<std::string> sorted;
+        sorted.reserve(order.size());
+        for (std::size_t i = 0; i < order.size(); ++i)
+        {
+            new_codes[order[i]] = static_cast<int32_t>(i);
+            sorted.push_back(std::move(dictionary[order[i]]));
+        }
+
+        dictionary = std::move(sorted);
+        for (auto& code : column_.codes)
+        {
+            if (code != missing_int)
+            {
+                code = new_codes[code];
+            }
+        }
+
+        return std::move(column_);
+    }
+
+private:
+    string_column column_;
+    std::unordered_map<std::string, int32_t> codes_by_value_;
+};
+
+bool contains(const std::vector<track_column>& columns, track_column column)
+{
+    return std::find(columns.begin(), columns.end(), column) != columns.end();
+}
+
+/// Find the index of a track ID in a sorted list of IDs, if present.
+stdx::optional<std::size_t> index_of(
+    const std::vector<int64_t>& ids, int64_t id)
+{
+    auto iter = std::lower_bound(ids.begin(), ids.end(), id);
+    if (iter == ids.end() || *iter != id)
+    {
+        return stdx::nullopt;
+    }
+
+    return static_cast<std::size_t>(iter - ids.begin());
+}
+
+/// Build an SQL list of metadata types.
+template <typename T>
+std::string type_list(const std::vector<T>& types)
+{
+    std::string list;
+    for (auto type : types)
+    {
+        list += (list.empty() ? "" : ", ") +
+                std::to_string(static_cast<int>(type));
+    }
+
+    return "(" + list + ")";
+}
+
+}  // namespace
+
+track_columns fetch_track_columns(
+    el_storage& storage, const std::vector<track_column>& columns)
+{
+    track_columns result;
+    auto want_bpm = contains(columns, track_column::bpm);
+    auto want_duration = contains(columns, track_column::duration);
+    auto want_year = contains(columns, track_column::year);
+
+    // Fields held in the `Track` table.  The duration is taken preferably
+    // from the length calculated from the track's sampling information.
+    storage.db << "SELECT id, bpmAnalyzed, "
+                  "IFNULL(lengthCalculated, length), year "
+                  "FROM Track ORDER BY id" >>
+        [&](int64_t id, stdx::optional<double> bpm,
+            stdx::optional<int64_t> length, stdx::optional<int64_t> year) {
+            result.ids.push_back(id);
+            if (want_bpm)
+            {
+                result.bpm.push_back(bpm.value_or(missing_double));
+            }
+
+            if (want_duration)
+            {
+                result.duration.push_back(
+                    length ? static_cast<double>(*length) : missing_double);
+            }
+
+            if (want_year)
+            {
+                result.year.push_back(
+                    year ? static_cast<int32_t>(*year) : missing_int);
+            }
+        };
+
+    auto track_count = result.ids.size();
+
+    // Fields held in the `MetaDataInteger` table.
+    std::vector<metadata_int_type> int_types;
+    if (contains(columns, track_column::key))
+    {
+        int_types.push_back(metadata_int_type::musical_key);
+        result.key.assign(track_count, missing_int);
+    }
+
+    if (contains(columns, track_column::rating))
+    {
+        int_types.push_back(metadata_int_type::rating);
+        result.rating.assign(track_count, missing_int);
+    }
+
+    if (!int_types.empty())
+    {
+        storage.db << "SELECT id, type, value FROM MetaDataInteger "
+                      "WHERE value IS NOT NULL AND type IN " +
+                          type_list(int_types) >>
+            [&](int64_t id, int64_t type, int64_t value) {
+                auto index = index_of(result.ids, id);
+                if (!index)
+                {
+                    return;
+                }
+
+                auto& column =
+                    type == static_cast<int64_t>(metadata_int_type::rating)
+                        ? result.rating
+                        : result.key;
+                column[*index] = static_cast<int32_t>(value);
+            };
+    }
+
+    // Fields held in the `MetaData` table.
+    std::vector<std::pair<metadata_str_type, string_column*>> str_columns;
+    auto add_str_column = [&](track_column column, metadata_str_type type,
+                              string_column& target) {
+        if (contains(columns, column))
+        {
+            str_columns.emplace_back(type, &target);
+        }
+    };
+    add_str_column(track_column::album, metadata_str_type::album, result.album);
+    add_str_column(
+        track_column::artist, metadata_str_type::artist, result.artist);
+    add_str_column(track_column::genre, metadata_str_type::genre, result.genre);
+    add_str_column(track_column::title, metadata_str_type::title, result.title);
+
+    if (!str_columns.empty())
+    {
+        std::vector<metadata_str_type> str_types;
+        std::unordered_map<int64_t, string_column_builder> builders;
+        for (auto&& [type, target] : str_columns)
+        {
+            str_types.push_back(type);
+            builders.emplace(
+                static_cast<int64_t>(type), string_column_builder{track_count});
+        }
+
+        storage.db << "SELECT id, type, text FROM MetaData "
+                      "WHERE text IS NOT NULL AND type IN " +
+                          type_list(str_types) >>
+            [&](int64_t id, int64_t type, std::string text) {
+                auto index = index_of(result.ids, id);
+                if (index)
+                {
+                    builders.at(type).set(*index, std::move(text));
+                }
+            };
+
+        for (auto&& [type, target] : str_columns)
+        {
+            *target = builders.at(static_cast<int64_t>(type)).finish();
+        }
+    }
+
+    return result;
+}
+
+}  // namespace djinterop::enginelibrary
@@ -0,0 +1,181 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/enginelibrary/track_export.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+#include <djinterop/enginelibrary/el_track_impl.hpp>
+#include <djinterop/enginelibrary/el_transaction_guard_impl.hpp>
+#include <djinterop/executor.hpp>
+#include <djinterop/parallel.hpp>
+#include <djinterop/track_snapshot.hpp>
+
+namespace djinterop::enginelibrary
+{
+namespace
+{
+/// A batch of encoded tracks, to be written to every target.
+struct export_batch
+{
+    std::vector<encoded_track> tracks;
+
+    /// The number of requested IDs covered by the batch, including those of
+    /// tracks that do not exist.
+    std::size_t id_count = 0;
+};
+
+/// The state of one export target.
+struct export_target
+{
+    std::string directory;
+
+    /// The executor of the source, which the target's connection shares.
+    std::shared_ptr<executor> task_executor;
+
+    std::shared_ptr<el_storage> storage;
+    std::size_t completed = 0;
+    bool failed = false;
+};
+
+/// Read and encode the tracks of the next batch, starting at `next`.
+export_batch encode_batch(
+    const std::shared_ptr<el_storage>& source, const std::vector<int64_t>& ids,
+    std::size_t& next, std::size_t batch_size)
+{
+    export_batch batch;
+    auto end = std::min(ids.size(), next + batch_size);
+    batch.id_count = end - next;
+    for (; next < end; ++next)
+    {
+        el_track_impl tr{source, ids[next]};
+        if (!tr.is_valid())
+        {
+            continue;
+        }
+
+        batch.tracks.push_back(encode_track(tr.snapshot()));
+    }
+
+    return batch;
+}
+
+/// Write a batch to one target, on its own connection.
+void write_batch(
+    const export_batch& batch, std::size_t target_index, export_target& target,
+    std::size_t total, const export_options& options,
+    std::mutex& progress_mutex, export_target_result& result)
+{
+    if (target.failed)
+    {
+        return;
+    }
+
+    try
+    {
+        if (!target.storage)
+        {
+            target.storage = std::make_shared<el_storage>(
+                target.directory, target.task_executor);
+        }
+
+        std::vector<int64_t> ids;
+        ids.reserve(batch.tracks.size());
+
+        el_transaction_guard_impl trans{target.storage};
+        for (auto&& encoded : batch.tracks)
+        {
+            ids.push_back(create_track(*target.storage, encoded));
+        }
+        trans.commit();
+
+        result.track_ids.insert(result.track_ids.end(), ids.begin(), ids.end());
+        target.completed += batch.id_count;
+        if (options.on_progress)
+        {
+            std::lock_guard<std::mutex> lock{progress_mutex};
+            options.on_progress(
+                export_progress{target_index, target.completed, total});
+        }
+    }
+    catch (const std::exception& e)
+    {
+        result.error = e.what();
+        target.failed = true;
+        target.storage.reset();
+    }
+}
+
+}  // namespace
+
+std::vector<export_target_result> export_tracks(
+    const std::shared_ptr<el_storage>& source,
+    const std::vector<std::string>& directories,
+    const std::vector<int64_t>& ids, const export_options& options)
+{
+    std::vector<export_target_result> results(directories.size());
+    if (directories.empty())
+    {
+        return results;
+    }
+
+    std::vector<export_target> targets(directories.size());
+    for (std::size_t i = 0; i < directories.size(); ++i)
+    {
+        targets[i].directory = directories[i];
+        targets[i].task_executor = source->task_executor;
+    }
+
+    auto batch_size = std::max<std::size_t>(options.batch_size, 1);
+    std::size_t next = 0;
+    std::mutex progress_mutex;
+    auto batch = encode_batch(source, ids, next, batch_size);
+    while (batch.id_count != 0)
+    {
+        // Index zero reads and encodes the next batch, while the others write
+        // this batch to each target.
+        export_batch next_batch;
+        parallel_for(
+            *source->task_executor, targets.size() + 1, 0,
+            [&](std::size_t i) {
+                if (i == 0)
+                {
+                    next_batch = encode_batch(source, ids, next, batch_size);
+                }
+                else
+                {
+                    write_batch(
+                        batch, i - 1, targets[i - 1], ids.size(), options,
+                        progress_mutex, results[i - 1]);
+                }
+            });
+
+        batch = std::move(next_batch);
+        if (std::all_of(targets.begin(), targets.end(), [](auto&& target) {
+                return target.failed;
+            }))
+        {
+            break;
+        }
+    }
+
+    return results;
+}
+
+}  // namespace djinterop::enginelibrary
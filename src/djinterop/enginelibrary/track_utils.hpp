@@ -45,5 +45,22 @@ inline int64_t required_waveform_samples_per_entry(double sample_rate)
     return waveform_quantisation_number(sample_rate);
 }
 
+/// Calculate the samples-per-entry in an overview waveform.
+///
+/// An overview waveform always has 1024 entries, and the number of samples
+/// that each one represents must be calculated from the true sample count by
+/// rounding the number of samples to the quantisation number first.
+inline int64_t calculate_overview_waveform_samples_per_entry(
+    int64_t sample_rate, int64_t sample_count)
+{
+    auto qn = waveform_quantisation_number(sample_rate);
+    if (qn == 0)
+    {
+        return 0;
+    }
+
+    return ((sample_count / qn) * qn) / 1024;
+}
+
 
 }  // namespace djinterop::enginelibrary::util
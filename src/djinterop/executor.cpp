@@ -0,0 +1,116 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/executor.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace djinterop
+{
+struct thread_pool_executor::impl
+{
+    void run()
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        for (;;)
+        {
+            wakeup.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+            {
+                return;
+            }
+
+            auto task = std::move(tasks.front());
+            tasks.pop_front();
+            lock.unlock();
+
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                // An exception escaping a task must not take down the pool.
+            }
+
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::deque<std::function<void()> > tasks;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+};
+
+thread_pool_executor::thread_pool_executor(std::size_t thread_count) :
+    pimpl_{std::make_unique<impl>()}
+{
+    if (thread_count == 0)
+    {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (std::size_t i = 0; i < thread_count; ++i)
+    {
+        pimpl_->threads.emplace_back(&impl::run, pimpl_.get());
+    }
+}
+
+thread_pool_executor::~thread_pool_executor()
+{
+    {
+        std::lock_guard<std::mutex> lock{pimpl_->mutex};
+        pimpl_->stopping = true;
+    }
+
+    pimpl_->wakeup.notify_all();
+    for (auto& thread : pimpl_->threads)
+    {
+        thread.join();
+    }
+}
+
+void thread_pool_executor::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock{pimpl_->mutex};
+        pimpl_->tasks.push_back(std::move(task));
+    }
+
+    pimpl_->wakeup.notify_one();
+}
+
+std::size_t thread_pool_executor::concurrency() const
+{
+    return pimpl_->threads.size();
+}
+
+std::shared_ptr<executor> default_executor()
+{
+    static auto instance = std::make_shared<thread_pool_executor>();
+    return instance;
+}
+
+}  // namespace djinterop
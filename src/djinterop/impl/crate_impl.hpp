@@ -53,6 +53,7 @@ public:
         const std::string& name) = 0;
     virtual void set_name(std::string name) = 0;
     virtual void set_parent(stdx::optional<crate> parent) = 0;
+    virtual std::size_t track_count() = 0;
     virtual std::vector<track> tracks() = 0;
 
 private:
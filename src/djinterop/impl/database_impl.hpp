@@ -17,10 +17,15 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include <djinterop/database.hpp>
+#include <djinterop/executor.hpp>
 #include <djinterop/optional.hpp>
+#include <djinterop/performance_data.hpp>
 
 namespace djinterop
 {
@@ -30,32 +35,100 @@ class track;
 struct track_snapshot;
 class transaction_guard;
 
+/// A track whose file is yet to be analysed by `database::analyze_tracks()`.
+struct analysis_job
+{
+    int64_t id;
+    std::string relative_path;
+};
+
+/// The results of analysing the file of a track, to be written to the track
+/// by `database::analyze_tracks()`.
+struct analysis_results
+{
+    int64_t id;
+    sampling_info sampling;
+    stdx::optional<double> average_loudness;
+    stdx::optional<double> bpm;
+    std::vector<beatgrid_marker> beatgrid;
+    std::vector<waveform_entry> waveform;
+};
+
 class database_impl
 {
 public:
     virtual ~database_impl();
 
+    virtual std::size_t apply_delta_package(
+        const std::string& package_directory) = 0;
+    virtual bool backup_to(
+        const std::string& directory, const backup_options& options) = 0;
     virtual transaction_guard begin_transaction() = 0;
+    virtual std::vector<checkpoint_result> checkpoint(
+        checkpoint_mode mode) = 0;
+    virtual database clone_to_memory() = 0;
+    virtual track_columns columns(
+        const std::vector<track_column>& columns) = 0;
     virtual stdx::optional<crate> crate_by_id(int64_t id) = 0;
     virtual std::vector<crate> crates() = 0;
     virtual std::vector<crate> crates_by_name(const std::string& name) = 0;
+    virtual std::vector<bool> crates_exist(const std::vector<int64_t>& ids) = 0;
+    virtual std::size_t create_delta_package(
+        const std::string& package_directory,
+        const std::string& target_directory) = 0;
     virtual crate create_root_crate(std::string name) = 0;
     virtual track create_track(const track_snapshot& snapshot) = 0;
     virtual std::string directory() = 0;
+    virtual std::vector<export_target_result> export_to(
+        const std::vector<std::string>& directories,
+        const std::vector<int64_t>& ids, const export_options& options) = 0;
+    virtual folder_import_result import_folder_tree(
+        const std::string& root_directory,
+        const folder_import_options& options) = 0;
+    virtual std::vector<imported_track_link> imported_tracks(
+        const std::string& source_directory) = 0;
     virtual bool is_supported() = 0;
+    virtual std::size_t link_imported_tracks(
+        const std::string& source_directory) = 0;
+    virtual void prefetch(
+        const std::vector<int64_t>& ids, prefetch_fields fields) = 0;
+    virtual std::size_t quantize_cues(
+        const std::vector<int64_t>& ids, quantize_resolution resolution,
+        const bulk_update_options& options) = 0;
+    virtual std::size_t regenerate_overviews(
+        const bulk_update_options& options) = 0;
+    virtual relink_result relink_tracks(
+        const std::vector<std::string>& directories,
+        const relink_options& options) = 0;
+    virtual std::size_t transform_beatgrids(
+        const std::vector<int64_t>& ids, const beatgrid_transform& transform,
+        const bulk_update_options& options) = 0;
+    virtual std::vector<analysis_job> unanalyzed_tracks() = 0;
     virtual void verify() = 0;
     virtual void remove_crate(crate cr) = 0;
     virtual void remove_track(track tr) = 0;
     virtual std::vector<crate> root_crates() = 0;
     virtual stdx::optional<crate> root_crate_by_name(
         const std::string& name) = 0;
+    virtual void set_checkpoint_options(
+        const checkpoint_options& options) = 0;
+    virtual void set_wal_mode(bool enabled) = 0;
+    virtual void submit_async(std::function<void(database&)> operation) = 0;
+    virtual std::shared_ptr<executor> task_executor() = 0;
     virtual stdx::optional<track> track_by_id(int64_t id) = 0;
+    virtual std::size_t track_count() = 0;
+    virtual std::vector<track> track_handles(
+        const std::vector<int64_t>& ids) = 0;
     virtual std::vector<track> tracks() = 0;
+    virtual std::vector<bool> tracks_exist(const std::vector<int64_t>& ids) = 0;
     virtual std::vector<track> tracks_by_relative_path(
         const std::string& relative_path) = 0;
     virtual std::string uuid() = 0;
     virtual semantic_version version() = 0;
     virtual std::string version_name() = 0;
+    virtual std::size_t write_analysis_results(
+        const std::vector<analysis_results>& results,
+        bool replace_adjusted_beatgrids) = 0;
 };
 
 }  // namespace djinterop
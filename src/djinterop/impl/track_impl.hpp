@@ -27,6 +27,7 @@
 namespace djinterop
 {
 class database;
+struct playback_data;
 class track;
 struct track_import_info;
 struct track_snapshot;
@@ -102,6 +103,7 @@ public:
     last_played_at() = 0;
     virtual void set_last_played_at(
         stdx::optional<std::chrono::system_clock::time_point> time) = 0;
+    virtual playback_data load_for_playback() = 0;
     virtual stdx::optional<loop> loop_at(int32_t index) = 0;
     virtual void set_loop_at(int32_t index, stdx::optional<loop> l) = 0;
     virtual std::array<stdx::optional<loop>, 8> loops() = 0;
@@ -0,0 +1,234 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <utility>
+
+namespace djinterop
+{
+namespace
+{
+struct parallel_for_state
+{
+    parallel_for_state(
+        std::size_t count, const std::function<void(std::size_t)>& fn) :
+        count{count}, fn{fn}
+    {
+    }
+
+    const std::size_t count;
+
+    // Only called for claimed indices, all of which are run before
+    // `parallel_for()` returns, and so a reference is safe.
+    const std::function<void(std::size_t)>& fn;
+
+    std::atomic<std::size_t> next{0};
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::size_t active_helpers = 0;
+    std::exception_ptr error;
+};
+
+void run_indices(parallel_for_state& state)
+{
+    for (;;)
+    {
+        auto index = state.next.fetch_add(1);
+        if (index >= state.count)
+        {
+            return;
+        }
+
+        try
+        {
+            state.fn(index);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock{state.mutex};
+            if (!state.error)
+            {
+                state.error = std::current_exception();
+            }
+
+            state.next = state.count;
+        }
+    }
+}
+
+}  // anonymous namespace
+
+void parallel_for(
+    executor& exec, std::size_t count, std::size_t max_parallelism,
+    const std::function<void(std::size_t)>& fn)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (max_parallelism == 0)
+    {
+        max_parallelism = exec.concurrency();
+    }
+
+    auto state = std::make_shared<parallel_for_state>(count, fn);
+    auto helper_count =
+        std::min(count, std::max<std::size_t>(max_parallelism, 1)) - 1;
+    for (std::size_t i = 0; i < helper_count; ++i)
+    {
+        // A helper that only starts once all indices are claimed does nothing,
+        // and so the caller never waits for helpers that have not started.
+        exec.submit([state] {
+            {
+                std::lock_guard<std::mutex> lock{state->mutex};
+                if (state->next >= state->count)
+                {
+                    return;
+                }
+
+                ++state->active_helpers;
+            }
+
+            run_indices(*state);
+
+            std::lock_guard<std::mutex> lock{state->mutex};
+            --state->active_helpers;
+            state->idle.notify_all();
+        });
+    }
+
+    run_indices(*state);
+
+    std::unique_lock<std::mutex> lock{state->mutex};
+    state->idle.wait(lock, [&] { return state->active_helpers == 0; });
+    if (state->error)
+    {
+        std::rethrow_exception(state->error);
+    }
+}
+
+struct serial_task::state : std::enable_shared_from_this<state>
+{
+    state(std::shared_ptr<executor> exec, std::function<void()> fn) :
+        exec{std::move(exec)}, fn{std::move(fn)}
+    {
+    }
+
+    void submit()
+    {
+        exec->submit([s = shared_from_this()] { s->run(); });
+    }
+
+    void run()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (!pending || stopped)
+            {
+                scheduled = false;
+                idle.notify_all();
+                return;
+            }
+
+            pending = false;
+            running = true;
+        }
+
+        try
+        {
+            fn();
+        }
+        catch (...)
+        {
+            // Background work is best-effort.
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            running = false;
+            idle.notify_all();
+            if (!pending || stopped)
+            {
+                scheduled = false;
+                return;
+            }
+        }
+
+        // Woken while running: resubmit rather than loop, so that other tasks
+        // on the executor get a turn.
+        submit();
+    }
+
+    const std::shared_ptr<executor> exec;
+    const std::function<void()> fn;
+    std::mutex mutex;
+    std::condition_variable idle;
+    bool pending = false;
+    bool scheduled = false;
+    bool running = false;
+    bool stopped = false;
+};
+
+serial_task::serial_task(
+    std::shared_ptr<executor> exec, std::function<void()> fn) :
+    state_{std::make_shared<state>(std::move(exec), std::move(fn))}
+{
+}
+
+serial_task::~serial_task()
+{
+    stop();
+}
+
+void serial_task::wake()
+{
+    {
+        std::lock_guard<std::mutex> lock{state_->mutex};
+        if (state_->stopped)
+        {
+            return;
+        }
+
+        state_->pending = true;
+        if (state_->scheduled)
+        {
+            return;
+        }
+
+        state_->scheduled = true;
+    }
+
+    state_->submit();
+}
+
+void serial_task::stop()
+{
+    // A run that has been scheduled but not started will find the task
+    // stopped, and so only a run in progress need be waited for.
+    std::unique_lock<std::mutex> lock{state_->mutex};
+    state_->stopped = true;
+    state_->idle.wait(lock, [this] { return !state_->running; });
+}
+
+}  // namespace djinterop
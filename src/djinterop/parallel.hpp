@@ -0,0 +1,73 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include <djinterop/executor.hpp>
+
+namespace djinterop
+{
+/// Run a function for every index in `[0, count)`, spread across up to
+/// `max_parallelism` threads of an executor, or as many as the executor can
+/// usefully run if zero.
+///
+/// The calling thread takes part in the work, and only ever waits for indices
+/// that are already being run on other threads.  It is therefore safe to call
+/// from within a task run by the same executor.  Once the function throws, no
+/// further indices are started, and the first exception is rethrown.
+void parallel_for(
+    executor& exec, std::size_t count, std::size_t max_parallelism,
+    const std::function<void(std::size_t)>& fn);
+
+/// The `serial_task` class runs a function on an executor whenever it is
+/// woken, with no more than one run in progress at any time.
+///
+/// It is intended for background work that drains a queue: the function is
+/// run again if woken while it is already running, and so should return once
+/// it finds nothing left to do.  A function with a lot to do may also return
+/// early after waking the task, to give other tasks on the executor a turn.
+class serial_task
+{
+public:
+    serial_task(std::shared_ptr<executor> exec, std::function<void()> fn);
+
+    /// Stop the task, waiting for any run in progress to finish.
+    ~serial_task();
+
+    serial_task(const serial_task&) = delete;
+    serial_task& operator=(const serial_task&) = delete;
+
+    /// Schedule a run of the function, unless one is already scheduled.
+    void wake();
+
+    /// Prevent any further runs of the function, and wait for any run in
+    /// progress to finish.
+    ///
+    /// This must not be called from within the function itself.
+    void stop();
+
+private:
+    struct state;
+
+    std::shared_ptr<state> state_;
+};
+
+}  // namespace djinterop
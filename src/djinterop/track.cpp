@@ -24,6 +24,7 @@
 #include <djinterop/database.hpp>
 #include <djinterop/impl/database_impl.hpp>
 #include <djinterop/impl/track_impl.hpp>
+#include <djinterop/playback_data.hpp>
 #include <djinterop/track.hpp>
 #include <djinterop/track_snapshot.hpp>
 
@@ -364,6 +365,11 @@ void track::set_last_played_at(system_clock::time_point played_at) const
     set_last_played_at(stdx::make_optional(played_at));
 }
 
+playback_data track::load_for_playback() const
+{
+    return pimpl_->load_for_playback();
+}
+
 stdx::optional<loop> track::loop_at(int32_t index) const
 {
     return pimpl_->loop_at(index);
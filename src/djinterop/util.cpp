@@ -17,10 +17,14 @@
 
 #include <djinterop/util.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <ios>
 #include <random>
 #include <sstream>
 #include <string>
+#include <type_traits>
 
 #include <sys/stat.h>
 #if defined(_WIN32)
@@ -106,4 +110,58 @@ stdx::optional<std::string> get_file_extension(const std::string& file_path)
     return file_extension;
 }
 
+// The reduction below treats waveform entries as packed bytes.
+static_assert(sizeof(waveform_entry) == 6, "waveform_entry must be 6 bytes");
+static_assert(
+    std::is_trivially_copyable<waveform_entry>::value,
+    "waveform_entry must be trivially copyable");
+
+// Calculate the entry-wise maximum over a range of waveform entries.
+//
+// The entries are processed as blocks of raw bytes, eight entries (48 bytes)
+// at a time, so that the inner loop is a plain byte-wise maximum that the
+// compiler can vectorise.
+waveform_entry max_waveform_entry(
+    const waveform_entry* begin, const waveform_entry* end)
+{
+    constexpr std::size_t block_entries = 8;
+    constexpr std::size_t block_bytes = block_entries * sizeof(waveform_entry);
+
+    std::array<uint8_t, block_bytes> acc{};
+    auto count = static_cast<std::size_t>(end - begin);
+    auto bytes = reinterpret_cast<const uint8_t*>(begin);
+    auto block_end = bytes + (count / block_entries) * block_bytes;
+    for (; bytes != block_end; bytes += block_bytes)
+    {
+        for (std::size_t i = 0; i < block_bytes; ++i)
+        {
+            acc[i] = std::max(acc[i], bytes[i]);
+        }
+    }
+
+    // Fold the eight lanes together, along with any trailing entries.
+    std::array<uint8_t, sizeof(waveform_entry)> result{};
+    auto fold = [&result](const uint8_t* entry) {
+        for (std::size_t i = 0; i < sizeof(waveform_entry); ++i)
+        {
+            result[i] = std::max(result[i], entry[i]);
+        }
+    };
+
+    for (std::size_t lane = 0; lane < block_entries; ++lane)
+    {
+        fold(&acc[lane * sizeof(waveform_entry)]);
+    }
+
+    for (auto tail = block_end; tail != reinterpret_cast<const uint8_t*>(end);
+         tail += sizeof(waveform_entry))
+    {
+        fold(tail);
+    }
+
+    waveform_entry entry;
+    std::memcpy(&entry, result.data(), sizeof entry);
+    return entry;
+}
+
 }  // namespace djinterop
@@ -21,6 +21,7 @@
 #include <string>
 
 #include <djinterop/optional.hpp>
+#include <djinterop/performance_data.hpp>
 
 namespace djinterop
 {
@@ -31,4 +32,9 @@ std::string generate_random_uuid();
 std::string get_filename(const std::string& file_path);
 stdx::optional<std::string> get_file_extension(const std::string& file_path);
 
+/// Calculate the entry-wise maximum over a non-empty range of waveform
+/// entries.
+waveform_entry max_waveform_entry(
+    const waveform_entry* begin, const waveform_entry* end);
+
 }  // namespace djinterop
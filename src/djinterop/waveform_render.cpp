@@ -0,0 +1,142 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/waveform_render.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+#include <djinterop/util.hpp>
+
+namespace djinterop
+{
+namespace
+{
+struct rgba
+{
+    double r;
+    double g;
+    double b;
+    double a;
+};
+
+/// Blend a colour over another, with a given opacity in the range [0, 1].
+void blend(rgba& dst, const pad_color& src, double opacity)
+{
+    dst.r = src.r * opacity + dst.r * (1 - opacity);
+    dst.g = src.g * opacity + dst.g * (1 - opacity);
+    dst.b = src.b * opacity + dst.b * (1 - opacity);
+    dst.a = 255 * opacity + dst.a * (1 - opacity);
+}
+
+uint8_t to_channel(double value)
+{
+    return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0, 255.0)));
+}
+
+}  // anonymous namespace
+
+waveform_tile render_waveform_tile(
+    const std::vector<waveform_entry>& waveform, double entries_per_pixel,
+    int64_t index, int width, int height, const waveform_palette& palette)
+{
+    if (!(entries_per_pixel > 0) || width <= 0 || height <= 0)
+    {
+        throw std::invalid_argument{
+            "Waveform tile dimensions and zoom level must be positive"};
+    }
+
+    if (index < 0)
+    {
+        throw std::invalid_argument{"Waveform tile index must not be negative"};
+    }
+
+    waveform_tile tile;
+    tile.index = index;
+    tile.entries_per_pixel = entries_per_pixel;
+    tile.width = width;
+    tile.height = height;
+    tile.pixels.resize(4 * static_cast<std::size_t>(width) * height);
+
+    const auto& bg = palette.background;
+    for (std::size_t i = 0; i < tile.pixels.size(); i += 4)
+    {
+        tile.pixels[i] = bg.r;
+        tile.pixels[i + 1] = bg.g;
+        tile.pixels[i + 2] = bg.b;
+        tile.pixels[i + 3] = bg.a;
+    }
+
+    auto size = static_cast<int64_t>(waveform.size());
+    auto half_height = height / 2.0;
+    for (int x = 0; x < width; ++x)
+    {
+        auto pixel = index * width + x;
+        auto begin = static_cast<int64_t>(pixel * entries_per_pixel);
+        if (begin >= size)
+        {
+            break;
+        }
+
+        // When zoomed in beyond one entry per pixel, several columns show the
+        // same entry.
+        auto end = std::clamp(
+            static_cast<int64_t>((pixel + 1) * entries_per_pixel), begin + 1,
+            size);
+        auto peak =
+            max_waveform_entry(waveform.data() + begin, waveform.data() + end);
+
+        const std::array<std::pair<waveform_point, const pad_color*>, 3> bands{
+            {{peak.low, &palette.low},
+             {peak.mid, &palette.mid},
+             {peak.high, &palette.high}}};
+        std::array<double, 3> bar_heights;
+        std::array<double, 3> opacities;
+        for (std::size_t band = 0; band < bands.size(); ++band)
+        {
+            auto& [point, colour] = bands[band];
+            bar_heights[band] = point.value / 255.0 * half_height;
+            opacities[band] = colour->a / 255.0 * point.opacity / 255.0;
+        }
+
+        for (int y = 0; y < height; ++y)
+        {
+            auto distance = std::abs(y + 0.5 - half_height);
+            rgba colour{
+                double(bg.r), double(bg.g), double(bg.b), double(bg.a)};
+            for (std::size_t band = 0; band < bands.size(); ++band)
+            {
+                if (distance < bar_heights[band])
+                {
+                    blend(colour, *bands[band].second, opacities[band]);
+                }
+            }
+
+            auto offset = 4 * (static_cast<std::size_t>(y) * width + x);
+            tile.pixels[offset] = to_channel(colour.r);
+            tile.pixels[offset + 1] = to_channel(colour.g);
+            tile.pixels[offset + 2] = to_channel(colour.b);
+            tile.pixels[offset + 3] = to_channel(colour.a);
+        }
+    }
+
+    return tile;
+}
+
+}  // namespace djinterop
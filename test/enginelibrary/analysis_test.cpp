@@ -0,0 +1,558 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/djinterop.hpp>
+
+#define BOOST_TEST_MODULE analysis_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "temporary_directory.hpp"
+
+namespace el = djinterop::enginelibrary;
+namespace utf = boost::unit_test;
+
+namespace
+{
+constexpr double pi = 3.14159265358979323846;
+
+struct click_track
+{
+    double sample_rate;
+    double bpm;
+    double first_beat_seconds;
+};
+
+std::ostream& operator<<(std::ostream& os, const click_track& ct)
+{
+    os << "click_track(sample_rate=" << ct.sample_rate << ", bpm=" << ct.bpm
+       << ", first_beat_seconds=" << ct.first_beat_seconds << ")";
+    return os;
+}
+
+const std::vector<click_track> click_tracks{
+    click_track{44100, 120, 0.25},
+    click_track{44100, 128, 0.1},
+    click_track{48000, 174, 0.5},
+    click_track{44100, 87.5, 1.0},
+};
+
+/// Generate interleaved stereo audio consisting of a short, decaying tone
+/// burst on every beat.
+std::vector<float> make_clicks(const click_track& ct, double seconds)
+{
+    auto frame_count = static_cast<int64_t>(ct.sample_rate * seconds);
+    auto samples_per_beat = 60 * ct.sample_rate / ct.bpm;
+    std::vector<float> samples(2 * frame_count);
+    for (auto beat = ct.first_beat_seconds * ct.sample_rate;
+         beat < frame_count; beat += samples_per_beat)
+    {
+        auto start = static_cast<int64_t>(beat);
+        auto length = static_cast<int64_t>(0.05 * ct.sample_rate);
+        for (int64_t i = 0; i < length && start + i < frame_count; ++i)
+        {
+            auto t = i / ct.sample_rate;
+            auto value = static_cast<float>(
+                0.8 * std::exp(-t * 80) * std::sin(2 * pi * 1000 * t));
+            samples[2 * (start + i)] = value;
+            samples[2 * (start + i) + 1] = value;
+        }
+    }
+
+    return samples;
+}
+
+/// Generate interleaved stereo audio consisting of a 997Hz sine tone.
+std::vector<float> make_tone(
+    double sample_rate, double amplitude, double seconds)
+{
+    auto frame_count = static_cast<int64_t>(sample_rate * seconds);
+    std::vector<float> samples(2 * frame_count);
+    for (int64_t i = 0; i < frame_count; ++i)
+    {
+        auto value = static_cast<float>(
+            amplitude * std::sin(2 * pi * 997 * i / sample_rate));
+        samples[2 * i] = value;
+        samples[2 * i + 1] = value;
+    }
+
+    return samples;
+}
+
+struct chord_progression
+{
+    std::vector<std::vector<int> > chords;
+    djinterop::musical_key expected_key;
+};
+
+std::ostream& operator<<(std::ostream& os, const chord_progression& cp)
+{
+    os << "chord_progression(expected_key="
+       << static_cast<int>(cp.expected_key) << ")";
+    return os;
+}
+
+// Chords are given as MIDI note numbers.
+const std::vector<chord_progression> chord_progressions{
+    // C - F - G - C
+    chord_progression{
+        {{48, 60, 64, 67}, {53, 60, 65, 69}, {55, 59, 62, 67},
+         {48, 60, 64, 67}},
+        djinterop::musical_key::c_major},
+    // Am - Dm - E - Am
+    chord_progression{
+        {{45, 57, 60, 64}, {50, 57, 62, 65}, {52, 56, 59, 64},
+         {45, 57, 60, 64}},
+        djinterop::musical_key::a_minor},
+    // F# - B - C# - F#
+    chord_progression{
+        {{54, 66, 70, 73}, {59, 66, 71, 75}, {61, 65, 68, 73},
+         {54, 66, 70, 73}},
+        djinterop::musical_key::f_sharp_major},
+    // Gm - Cm - D - Gm
+    chord_progression{
+        {{43, 55, 58, 62}, {48, 55, 60, 63}, {50, 54, 57, 62},
+         {43, 55, 58, 62}},
+        djinterop::musical_key::g_minor},
+};
+
+/// Generate mono audio of a repeated chord progression, using tones with a
+/// few decaying harmonics.
+std::vector<float> make_chords(
+    const chord_progression& cp, double sample_rate, double seconds)
+{
+    auto frame_count = static_cast<int64_t>(sample_rate * seconds);
+    auto chord_length = static_cast<int64_t>(sample_rate);
+    std::vector<float> samples(frame_count);
+    for (int64_t i = 0; i < frame_count; ++i)
+    {
+        const auto& chord = cp.chords[(i / chord_length) % cp.chords.size()];
+        auto t = i / sample_rate;
+        double value = 0;
+        for (auto note : chord)
+        {
+            auto frequency = 440 * std::pow(2.0, (note - 69) / 12.0);
+            for (int harmonic = 1; harmonic <= 4; ++harmonic)
+            {
+                value += std::sin(2 * pi * frequency * harmonic * t) /
+                         (harmonic * harmonic);
+            }
+        }
+
+        samples[i] = static_cast<float>(0.1 * value);
+    }
+
+    return samples;
+}
+
+template <typename T>
+void write_le(std::ofstream& os, T value, int size)
+{
+    for (int i = 0; i < size; ++i)
+    {
+        os.put(static_cast<char>((static_cast<uint32_t>(value) >> (8 * i)) &
+                                 0xFF));
+    }
+}
+
+/// Write interleaved stereo audio to a 16-bit PCM WAV file.
+void write_wav(
+    const std::string& path, const std::vector<float>& samples,
+    int sample_rate)
+{
+    std::ofstream os{path, std::ios::binary};
+    auto data_size = static_cast<uint32_t>(2 * samples.size());
+    os.write("RIFF", 4);
+    write_le(os, 36 + data_size, 4);
+    os.write("WAVEfmt ", 8);
+    write_le(os, 16, 4);
+    write_le(os, 1, 2);
+    write_le(os, 2, 2);
+    write_le(os, sample_rate, 4);
+    write_le(os, 4 * sample_rate, 4);
+    write_le(os, 4, 2);
+    write_le(os, 16, 2);
+    os.write("data", 4);
+    write_le(os, data_size, 4);
+    for (auto sample : samples)
+    {
+        write_le(os, static_cast<int16_t>(std::lround(32767 * sample)), 2);
+    }
+}
+
+}  // anonymous namespace
+
+BOOST_TEST_DECORATOR(
+    *utf::description("beatgrid_analyzer::finish() for click tracks"))
+BOOST_DATA_TEST_CASE(
+    beatgrid_analyzer_finish__click_track__expected_grid, click_tracks, ct)
+{
+    // Arrange
+    constexpr double seconds = 60;
+    auto samples = make_clicks(ct, seconds);
+    auto frame_count = samples.size() / 2;
+    djinterop::beatgrid_analyzer analyzer{ct.sample_rate, 2};
+
+    // Act
+    constexpr std::size_t block_size = 4096;
+    for (std::size_t offset = 0; offset < frame_count; offset += block_size)
+    {
+        auto count = std::min(block_size, frame_count - offset);
+        analyzer.feed(&samples[2 * offset], count);
+    }
+
+    auto result = analyzer.finish();
+
+    // Assert
+    BOOST_REQUIRE(result.bpm);
+    BOOST_CHECK_CLOSE(*result.bpm, ct.bpm, 0.1);
+    BOOST_REQUIRE_EQUAL(result.beatgrid.size(), 2);
+    BOOST_CHECK_EQUAL(result.beatgrid[0].index, -4);
+    BOOST_CHECK_GE(result.beatgrid[1].sample_offset, frame_count);
+
+    // Every beat should fall within 10ms of a click.
+    auto samples_per_beat =
+        (result.beatgrid[1].sample_offset - result.beatgrid[0].sample_offset) /
+        (result.beatgrid[1].index - result.beatgrid[0].index);
+    auto first_click = ct.first_beat_seconds * ct.sample_rate;
+    auto expected_samples_per_beat = 60 * ct.sample_rate / ct.bpm;
+    for (auto index = 0; index < result.beatgrid[1].index; ++index)
+    {
+        auto beat =
+            result.beatgrid[0].sample_offset + (index + 4) * samples_per_beat;
+        auto beats_from_click =
+            (beat - first_click) / expected_samples_per_beat;
+        auto error_seconds = (beats_from_click - std::round(beats_from_click)) *
+                             expected_samples_per_beat / ct.sample_rate;
+        BOOST_CHECK_SMALL(error_seconds, 0.01);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("beatgrid_analyzer::finish() for silence"))
+BOOST_AUTO_TEST_CASE(beatgrid_analyzer_finish__silence__no_grid)
+{
+    // Arrange
+    std::vector<float> samples(44100 * 30);
+    djinterop::beatgrid_analyzer analyzer{44100, 1};
+
+    // Act
+    analyzer.feed(samples.data(), samples.size());
+    auto result = analyzer.finish();
+
+    // Assert
+    BOOST_CHECK(!result.bpm);
+    BOOST_CHECK(result.beatgrid.empty());
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("beatgrid_analyzer ctor with a very low sample rate"))
+BOOST_DATA_TEST_CASE(
+    beatgrid_analyzer_ctor__low_sample_rate__throws,
+    utf::data::make({1.0, 85.0}), sample_rate)
+{
+    // Act/Assert
+    BOOST_CHECK_EXCEPTION(
+        djinterop::beatgrid_analyzer(sample_rate, 1), std::invalid_argument,
+        [](const std::invalid_argument& e) {
+            return std::string{e.what()}.find("Sample rate") == 0;
+        });
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("loudness_analyzer::finish() for sine tones"))
+BOOST_DATA_TEST_CASE(
+    loudness_analyzer_finish__sine_tone__expected_loudness,
+    utf::data::make({44100.0, 48000.0}) * utf::data::make({1.0, 0.5, 0.1}),
+    sample_rate, amplitude)
+{
+    // Arrange
+    auto samples = make_tone(sample_rate, amplitude, 20);
+    auto frame_count = samples.size() / 2;
+    djinterop::loudness_analyzer analyzer{sample_rate, 2};
+
+    // Act
+    constexpr std::size_t block_size = 1000;
+    for (std::size_t offset = 0; offset < frame_count; offset += block_size)
+    {
+        auto count = std::min(block_size, frame_count - offset);
+        analyzer.feed(&samples[2 * offset], count);
+    }
+
+    auto result = analyzer.finish();
+
+    // Assert
+    // A full-scale 997Hz sine on both channels measures 0 LUFS.
+    BOOST_REQUIRE(result.integrated_loudness);
+    BOOST_CHECK_SMALL(
+        *result.integrated_loudness - 20 * std::log10(amplitude), 0.1);
+    BOOST_REQUIRE(result.average_loudness);
+    BOOST_CHECK_CLOSE(*result.average_loudness, amplitude, 1.5);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("loudness_analyzer::finish() for silence"))
+BOOST_AUTO_TEST_CASE(loudness_analyzer_finish__silence__no_loudness)
+{
+    // Arrange
+    std::vector<float> samples(44100 * 10);
+    djinterop::loudness_analyzer analyzer{44100, 1};
+
+    // Act
+    analyzer.feed(samples.data(), samples.size());
+    auto result = analyzer.finish();
+
+    // Assert
+    BOOST_CHECK(!result.integrated_loudness);
+    BOOST_CHECK(!result.average_loudness);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("loudness_analyzer ctor with a very low sample rate"))
+BOOST_DATA_TEST_CASE(
+    loudness_analyzer_ctor__low_sample_rate__throws,
+    utf::data::make({1.0, 4.0}), sample_rate)
+{
+    // Act/Assert
+    BOOST_CHECK_THROW(
+        djinterop::loudness_analyzer(sample_rate, 1), std::invalid_argument);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("key_analyzer::finish() for chord progressions"))
+BOOST_DATA_TEST_CASE(
+    key_analyzer_finish__chord_progression__expected_key,
+    chord_progressions * utf::data::make({44100.0, 48000.0}), cp,
+    sample_rate)
+{
+    // Arrange
+    auto samples = make_chords(cp, sample_rate, 16);
+    djinterop::key_analyzer analyzer{sample_rate, 1};
+
+    // Act
+    constexpr std::size_t block_size = 3000;
+    for (std::size_t offset = 0; offset < samples.size();
+         offset += block_size)
+    {
+        auto count = std::min(block_size, samples.size() - offset);
+        analyzer.feed(&samples[offset], count);
+    }
+
+    auto result = analyzer.finish();
+
+    // Assert
+    BOOST_REQUIRE(result.key);
+    BOOST_CHECK_EQUAL(
+        static_cast<int>(*result.key), static_cast<int>(cp.expected_key));
+    BOOST_CHECK_GT(result.strength, 0.5);
+}
+
+BOOST_TEST_DECORATOR(*utf::description("key_analyzer::finish() for silence"))
+BOOST_AUTO_TEST_CASE(key_analyzer_finish__silence__no_key)
+{
+    // Arrange
+    std::vector<float> samples(44100 * 10);
+    djinterop::key_analyzer analyzer{44100, 1};
+
+    // Act
+    analyzer.feed(samples.data(), samples.size());
+    auto result = analyzer.finish();
+
+    // Assert
+    BOOST_CHECK(!result.key);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("key_analyzer ctor with a very low sample rate"))
+BOOST_DATA_TEST_CASE(
+    key_analyzer_ctor__low_sample_rate__throws,
+    utf::data::make({8000.0, 11024.0}), sample_rate)
+{
+    // Act/Assert
+    BOOST_CHECK_THROW(
+        djinterop::key_analyzer(sample_rate, 1), std::invalid_argument);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("waveform_analyzer::finish() for low and high tones"))
+BOOST_DATA_TEST_CASE(
+    waveform_analyzer_finish__tone__expected_band,
+    utf::data::make({44100.0, 48000.0}), sample_rate)
+{
+    // Arrange
+    auto frame_count = static_cast<std::size_t>(sample_rate * 5);
+    auto samples_per_entry = static_cast<std::size_t>(
+        el::required_waveform_samples_per_entry(sample_rate));
+    std::vector<float> low_tone(frame_count);
+    std::vector<float> high_tone(frame_count);
+    for (std::size_t i = 0; i < frame_count; ++i)
+    {
+        low_tone[i] = static_cast<float>(
+            0.5 * std::sin(2 * pi * 60 * i / sample_rate));
+        high_tone[i] = static_cast<float>(
+            0.5 * std::sin(2 * pi * 10000 * i / sample_rate));
+    }
+
+    djinterop::waveform_analyzer low_analyzer{sample_rate, 1};
+    djinterop::waveform_analyzer high_analyzer{sample_rate, 1};
+
+    // Act
+    low_analyzer.feed(low_tone.data(), frame_count);
+    high_analyzer.feed(high_tone.data(), frame_count);
+    auto low_result = low_analyzer.finish();
+    auto high_result = high_analyzer.finish();
+
+    // Assert
+    auto expected_size =
+        (frame_count + samples_per_entry - 1) / samples_per_entry;
+    BOOST_REQUIRE_EQUAL(low_result.size(), expected_size);
+    BOOST_REQUIRE_EQUAL(high_result.size(), expected_size);
+
+    // Skip the first second, while the filters settle.
+    for (auto i = expected_size / 5; i < expected_size - 1; ++i)
+    {
+        BOOST_CHECK_CLOSE(low_result[i].low.value, 127.0, 10);
+        BOOST_CHECK_LT(low_result[i].high.value, 10);
+        BOOST_CHECK_CLOSE(high_result[i].high.value, 127.0, 10);
+        BOOST_CHECK_LT(high_result[i].low.value, 10);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("database::analyze_tracks() for a library of WAV files"))
+BOOST_AUTO_TEST_CASE(analyze_tracks__wav_library__tracks_analysed)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir);
+        click_track ct{44100, 128, 0.1};
+        write_wav(
+            tmp_loc.temp_dir + "/clicks.wav", make_clicks(ct, 30),
+            static_cast<int>(ct.sample_rate));
+        djinterop::track_snapshot snapshot{};
+        snapshot.relative_path = "clicks.wav";
+        auto analysable = db.create_track(snapshot);
+        snapshot.relative_path = "missing.WAV";
+        auto missing = db.create_track(snapshot);
+        snapshot.relative_path = "compressed.mp3";
+        db.create_track(snapshot);
+
+        djinterop::batch_analysis_options options;
+        options.thread_count = 2;
+        options.batch_size = 1;
+        std::vector<djinterop::batch_analysis_progress> progress;
+        options.on_progress = [&](const auto& p) { progress.push_back(p); };
+
+        // Act
+        auto result = db.analyze_tracks(options);
+
+        // Assert
+        BOOST_CHECK_EQUAL(result.analyzed, 1);
+        BOOST_CHECK_EQUAL(result.skipped, 1);
+        BOOST_REQUIRE_EQUAL(result.failures.size(), 1);
+        BOOST_CHECK_EQUAL(result.failures[0].track_id, missing.id());
+        BOOST_CHECK(!result.cancelled);
+        BOOST_REQUIRE_EQUAL(progress.size(), 2);
+        BOOST_CHECK_EQUAL(progress[1].completed, 2);
+        BOOST_CHECK_EQUAL(progress[1].total, 2);
+
+        auto sampling = analysable.sampling();
+        BOOST_REQUIRE(sampling);
+        BOOST_CHECK_EQUAL(sampling->sample_rate, ct.sample_rate);
+        BOOST_CHECK_EQUAL(sampling->sample_count, 30 * 44100);
+        auto bpm = analysable.bpm();
+        BOOST_REQUIRE(bpm);
+        BOOST_CHECK_CLOSE(*bpm, ct.bpm, 0.1);
+        BOOST_CHECK_EQUAL(analysable.default_beatgrid().size(), 2);
+        BOOST_CHECK(analysable.average_loudness());
+        BOOST_CHECK(!analysable.waveform().empty());
+        BOOST_CHECK(!missing.sampling());
+    }
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::analyze_tracks() for a track with an adjusted beatgrid"))
+BOOST_AUTO_TEST_CASE(analyze_tracks__adjusted_beatgrid__beatgrid_kept)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir);
+        click_track ct{44100, 128, 0.1};
+        write_wav(
+            tmp_loc.temp_dir + "/clicks.wav", make_clicks(ct, 30),
+            static_cast<int>(ct.sample_rate));
+        djinterop::track_snapshot snapshot{};
+        snapshot.relative_path = "clicks.wav";
+        auto tr = db.create_track(snapshot);
+        std::vector<djinterop::beatgrid_marker> adjusted{
+            {-4, -100}, {812, 400000}};
+        tr.set_adjusted_beatgrid(adjusted);
+
+        // Act
+        auto result = db.analyze_tracks();
+
+        // Assert
+        BOOST_CHECK_EQUAL(result.analyzed, 1);
+        BOOST_REQUIRE(tr.sampling());
+        BOOST_CHECK_EQUAL(tr.default_beatgrid().size(), 2);
+        BOOST_CHECK(tr.adjusted_beatgrid() == adjusted);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("database::analyze_tracks() when already cancelled"))
+BOOST_AUTO_TEST_CASE(analyze_tracks__cancelled__nothing_analysed)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir);
+        write_wav(tmp_loc.temp_dir + "/tone.wav", make_tone(44100, 0.5, 5),
+                  44100);
+        djinterop::track_snapshot snapshot{};
+        snapshot.relative_path = "tone.wav";
+        auto tr = db.create_track(snapshot);
+        std::atomic<bool> cancel{true};
+        djinterop::batch_analysis_options options;
+        options.cancel = &cancel;
+
+        // Act
+        auto result = db.analyze_tracks(options);
+
+        // Assert
+        BOOST_CHECK_EQUAL(result.analyzed, 0);
+        BOOST_CHECK(result.cancelled);
+        BOOST_CHECK(!tr.sampling());
+    }
+}
@@ -0,0 +1,189 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/coroutine.hpp>
+
+#define BOOST_TEST_MODULE coroutine_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <djinterop/enginelibrary.hpp>
+#include <djinterop/track.hpp>
+#include <djinterop/track_snapshot.hpp>
+#include <djinterop/transaction_guard.hpp>
+
+#include "boost_test_utils.hpp"
+#include "example_track_data.hpp"
+#include "temporary_directory.hpp"
+
+namespace utf = boost::unit_test;
+namespace el = djinterop::enginelibrary;
+
+namespace
+{
+/// A minimal coroutine type that starts eagerly, and whose result can be
+/// waited for from outside.
+template <typename T>
+struct eager_task
+{
+    struct promise_type
+    {
+        eager_task get_return_object() { return {result.get_future()}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_value(T value) { result.set_value(std::move(value)); }
+        void unhandled_exception()
+        {
+            result.set_exception(std::current_exception());
+        }
+
+        std::promise<T> result;
+    };
+
+    std::future<T> future;
+};
+
+struct round_trip_result
+{
+    std::vector<djinterop::track> created;
+    std::vector<djinterop::track> found;
+    djinterop::stdx::optional<djinterop::track_snapshot> snapshot;
+    std::thread::id resumed_on;
+};
+
+eager_task<round_trip_result> round_trip(
+    djinterop::database db, std::vector<djinterop::track_snapshot> snapshots)
+{
+    auto relative_path = *snapshots[0].relative_path;
+    auto created = co_await db.create_tracks_async(std::move(snapshots));
+    auto resumed_on = std::this_thread::get_id();
+    auto found = co_await db.find_tracks_async(relative_path);
+    auto created_snapshot = co_await db.snapshot_async(created[0].id());
+    co_return round_trip_result{
+        std::move(created), std::move(found), std::move(created_snapshot),
+        resumed_on};
+}
+
+eager_task<std::vector<djinterop::track> > create_async(
+    djinterop::database db, std::vector<djinterop::track_snapshot> snapshots)
+{
+    co_return co_await db.create_tracks_async(std::move(snapshots));
+}
+
+eager_task<int> throw_async(djinterop::database db)
+{
+    co_return co_await db.run_async([](djinterop::database&) -> int {
+        throw std::runtime_error{"Failed"};
+    });
+}
+
+}  // anonymous namespace
+
+BOOST_TEST_DECORATOR(
+    * utf::description("Awaitable operations round-trip, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    create_find_snapshot_async__new_tracks__round_trip, el::all_versions,
+    version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        djinterop::track_snapshot snapshot{};
+        populate_track_snapshot(
+            example_track_type::fully_analysed_1, version, snapshot);
+
+        auto second = snapshot;
+        second.relative_path = "../second.mp3";
+
+        // Act
+        auto result = round_trip(db, {snapshot, second}).future.get();
+
+        // Assert
+        BOOST_CHECK(result.resumed_on != std::this_thread::get_id());
+        BOOST_REQUIRE_EQUAL(result.created.size(), 2);
+        BOOST_REQUIRE_EQUAL(result.found.size(), 1);
+        BOOST_CHECK_EQUAL(result.found[0].id(), result.created[0].id());
+        BOOST_REQUIRE(result.snapshot);
+        assert_track_snapshot_equal(snapshot, *result.snapshot, false);
+        assert_track_snapshot_equal(
+            snapshot, result.created[0].snapshot(), false);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("Awaitable writes while a transaction is open"))
+BOOST_AUTO_TEST_CASE(create_tracks_async__open_transaction__not_rolled_back)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir);
+        djinterop::track_snapshot snapshot{};
+        snapshot.relative_path = "../a.mp3";
+
+        // Act
+        std::vector<djinterop::track> created;
+        {
+            auto trans = db.begin_transaction();
+            created = create_async(db, {snapshot}).future.get();
+
+            // The transaction is rolled back on leaving scope.
+        }
+
+        // Assert
+        BOOST_REQUIRE_EQUAL(created.size(), 1);
+        BOOST_CHECK(db.track_by_id(created[0].id()));
+        BOOST_CHECK_EQUAL(db.track_count(), 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(run_async__throws__exception_propagated)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir);
+
+        // Act / Assert
+        BOOST_CHECK_THROW(throw_async(db).future.get(), std::runtime_error);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(run_async__temporary_database__throws)
+{
+    // Arrange
+    auto db = el::create_temporary_database();
+
+    // Act / Assert
+    BOOST_CHECK_THROW(throw_async(db).future.get(), std::logic_error);
+}
@@ -248,6 +248,41 @@ BOOST_AUTO_TEST_CASE(add_track__valid_track__saves)
     remove_temp_dir(temp_dir);
 }
 
+BOOST_AUTO_TEST_CASE(track_count__tracks_added_and_removed__counted)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    copy_test_db_to_temp_dir(temp_dir);
+    auto db = el::load_database(temp_dir.string());
+    auto c = *db.crate_by_id(2);
+    auto initial_count = c.track_count();
+
+    // Act
+    c.add_track(*db.track_by_id(1));
+    auto added_count = c.track_count();
+    c.remove_track(*db.track_by_id(1));
+    auto removed_count = c.track_count();
+
+    // Assert
+    BOOST_CHECK_EQUAL(initial_count, 0);
+    BOOST_CHECK_EQUAL(added_count, 1);
+    BOOST_CHECK_EQUAL(removed_count, 0);
+    remove_temp_dir(temp_dir);
+}
+
+BOOST_AUTO_TEST_CASE(track_count__deleted_crate__throws)
+{
+    // Arrange
+    auto temp_dir = create_temp_dir();
+    auto db = el::create_database(temp_dir.string(), el::version_1_18_0);
+    auto c = db.create_root_crate("Root");
+    db.remove_crate(c);
+
+    // Act/Assert
+    BOOST_CHECK_THROW(c.track_count(), djinterop::crate_deleted);
+    remove_temp_dir(temp_dir);
+}
+
 BOOST_AUTO_TEST_CASE(op_copy_assign__saved_track__copied_fields)
 {
     // Arrange
@@ -20,16 +20,30 @@
 #include <boost/test/data/test_case.hpp>
 #include <boost/test/included/unit_test.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
 #include <ostream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <djinterop/crate.hpp>
 #include <djinterop/enginelibrary.hpp>
+#include <djinterop/executor.hpp>
 #include <djinterop/optional.hpp>
 #include <djinterop/track.hpp>
 #include <djinterop/track_snapshot.hpp>
 #include <djinterop/semantic_version.hpp>
 
+#include "boost_test_utils.hpp"
+#include "example_track_data.hpp"
 #include "temporary_directory.hpp"
 
 #define STRINGIFY(x) STRINGIFY_(x)
@@ -85,6 +99,51 @@ const std::vector<example_file> valid_files{
 };
 
 const std::string sample_path{STRINGIFY(TESTDATA_DIR) "/el2"};
+
+/// Calculate the expected peak-preserving overview of a waveform.
+std::vector<djinterop::waveform_entry> expected_overview(
+    const std::vector<djinterop::waveform_entry>& waveform)
+{
+    std::vector<djinterop::waveform_entry> overview(1024);
+    for (std::size_t i = 0; i < overview.size(); ++i)
+    {
+        auto begin = waveform.size() * i / 1024;
+        auto end = std::max(begin + 1, waveform.size() * (i + 1) / 1024);
+        for (auto& point : {&djinterop::waveform_entry::low,
+                            &djinterop::waveform_entry::mid,
+                            &djinterop::waveform_entry::high})
+        {
+            uint8_t value = 0;
+            for (auto j = begin; j < end; ++j)
+            {
+                value = std::max(value, (waveform[j].*point).value);
+            }
+
+            (overview[i].*point).value = value;
+        }
+    }
+
+    return overview;
+}
+
+/// An executor that counts the tasks submitted to it, and runs them on a pool
+/// with fewer threads than it claims to be able to use.
+class counting_executor : public djinterop::executor
+{
+public:
+    void submit(std::function<void()> task) override
+    {
+        ++submitted;
+        pool_.submit(std::move(task));
+    }
+
+    std::size_t concurrency() const override { return 4; }
+
+    std::atomic<std::size_t> submitted{0};
+
+private:
+    djinterop::thread_pool_executor pool_{1};
+};
 }  // anonymous namespace
 
 
@@ -214,3 +273,922 @@ BOOST_AUTO_TEST_CASE(track_by_id__invalid_id__nullopt)
     // Act / Assert
     BOOST_CHECK(!db.track_by_id(123));
 }
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::regenerate_overviews() for up-to-date overviews, all schema "
+    "versions"))
+BOOST_DATA_TEST_CASE(
+    regenerate_overviews__up_to_date__none_changed, el::all_versions, version)
+{
+    // Arrange
+    auto db = el::create_temporary_database(version);
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        example_track_type::fully_analysed_1, version, snapshot);
+    std::vector<djinterop::track> tracks;
+    for (int i = 0; i < 5; ++i)
+    {
+        snapshot.relative_path = "../track_" + std::to_string(i) + ".mp3";
+        tracks.push_back(db.create_track(snapshot));
+    }
+
+    auto expected = tracks[0].overview_waveform();
+    djinterop::bulk_update_options options;
+    options.thread_count = 2;
+    options.batch_size = 2;
+
+    // Act
+    auto changed = db.regenerate_overviews(options);
+
+    // Assert
+    BOOST_CHECK_EQUAL(changed, 0);
+    for (auto& tr : tracks)
+    {
+        BOOST_CHECK(tr.overview_waveform() == expected);
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::regenerate_overviews() run from within a task of the "
+    "database's own executor, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    regenerate_overviews__nested_in_executor__completes, el::all_versions,
+    version)
+{
+    // Arrange
+    auto exec = std::make_shared<counting_executor>();
+    auto db = el::create_temporary_database(version, exec);
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        example_track_type::fully_analysed_1, version, snapshot);
+    for (int i = 0; i < 5; ++i)
+    {
+        snapshot.relative_path = "../track_" + std::to_string(i) + ".mp3";
+        db.create_track(snapshot);
+    }
+
+    // Act
+    // The only thread of the pool is busy running the task itself, so any
+    // work that waits on tasks that have not started would never finish.
+    std::promise<std::size_t> changed;
+    exec->submit([&] {
+        try
+        {
+            changed.set_value(db.regenerate_overviews());
+        }
+        catch (...)
+        {
+            changed.set_exception(std::current_exception());
+        }
+    });
+    auto result = changed.get_future();
+
+    // Assert
+    BOOST_REQUIRE(
+        result.wait_for(std::chrono::seconds{60}) ==
+        std::future_status::ready);
+    BOOST_CHECK_EQUAL(result.get(), 0);
+    BOOST_CHECK_GT(exec->submitted.load(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(regenerate_overviews__sample_db__peaks_preserved)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        for (auto name : {"/m.db", "/p.db"})
+        {
+            boost::filesystem::copy_file(
+                sample_path + name, tmp_loc.temp_dir + name);
+        }
+
+        auto db = el::load_database(tmp_loc.temp_dir);
+
+        // Act
+        db.regenerate_overviews();
+
+        // Assert
+        for (auto& tr : db.tracks())
+        {
+            auto waveform = tr.waveform();
+            BOOST_REQUIRE(!waveform.empty());
+            auto expected = expected_overview(waveform);
+            BOOST_CHECK(tr.overview_waveform() == expected);
+        }
+
+        BOOST_CHECK_EQUAL(db.regenerate_overviews(), 0);
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::transform_beatgrids() shifting beatgrids, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    transform_beatgrids__shift__shifted, el::all_versions, version)
+{
+    // Arrange
+    auto db = el::create_temporary_database(version);
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        example_track_type::fully_analysed_1, version, snapshot);
+    std::vector<djinterop::track> tracks;
+    for (int i = 0; i < 3; ++i)
+    {
+        snapshot.relative_path = "../track_" + std::to_string(i) + ".mp3";
+        tracks.push_back(db.create_track(snapshot));
+    }
+
+    djinterop::bulk_update_options options;
+    options.thread_count = 2;
+    options.batch_size = 1;
+    auto expected = snapshot.default_beatgrid;
+    for (auto& marker : expected)
+    {
+        marker.sample_offset += 100;
+    }
+
+    // Act
+    auto changed = db.transform_beatgrids(
+        {tracks[0].id(), 12345, tracks[1].id()},
+        djinterop::shift_beatgrid(100), options);
+
+    // Assert
+    BOOST_CHECK_EQUAL(changed, 2);
+    for (int i = 0; i < 2; ++i)
+    {
+        BOOST_CHECK(tracks[i].default_beatgrid() == expected);
+        BOOST_CHECK(tracks[i].adjusted_beatgrid() == expected);
+    }
+
+    BOOST_CHECK(tracks[2].default_beatgrid() == snapshot.default_beatgrid);
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::transform_beatgrids() rescaling and copying beatgrids, all "
+    "schema versions"))
+BOOST_DATA_TEST_CASE(
+    transform_beatgrids__rescale_then_copy__copied, el::all_versions, version)
+{
+    // Arrange
+    auto db = el::create_temporary_database(version);
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        example_track_type::fully_analysed_1, version, snapshot);
+    auto track = db.create_track(snapshot);
+
+    // Act
+    auto rescaled = db.transform_beatgrids(
+        {track.id()},
+        djinterop::rescale_beatgrid(
+            120, djinterop::beatgrid_target::default_beatgrid));
+    auto copied = db.transform_beatgrids(
+        {track.id()}, djinterop::copy_default_to_adjusted_beatgrid());
+
+    // Assert
+    BOOST_CHECK_EQUAL(rescaled, 1);
+    BOOST_CHECK_EQUAL(copied, 1);
+    auto beatgrid = track.adjusted_beatgrid();
+    BOOST_REQUIRE_EQUAL(beatgrid.size(), 2);
+    BOOST_CHECK_EQUAL(
+        beatgrid[0].sample_offset, snapshot.default_beatgrid[0].sample_offset);
+    BOOST_CHECK_CLOSE(
+        (beatgrid[1].sample_offset - beatgrid[0].sample_offset) /
+            (beatgrid[1].index - beatgrid[0].index),
+        60 * 44100 / 120.0, 1e-9);
+    BOOST_CHECK(track.default_beatgrid() == beatgrid);
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::quantize_cues() to beats and bars, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    quantize_cues__off_grid__snapped,
+    el::all_versions * utf::data::make({1, 4}), version, beats_per_step)
+{
+    // Arrange
+    auto db = el::create_temporary_database(version);
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        example_track_type::fully_analysed_1, version, snapshot);
+    auto track = db.create_track(snapshot);
+
+    // Beat n lies at sample offset 1000 + 22050n.
+    auto beat = [](double n) { return 1000 + 22050 * n; };
+    track.set_adjusted_beatgrid(
+        {djinterop::beatgrid_marker{-4, beat(-4)},
+         djinterop::beatgrid_marker{100, beat(100)}});
+    track.set_hot_cue_at(
+        0, djinterop::hot_cue{"Cue", beat(5) + 300, djinterop::pad_color{}});
+    track.set_loop_at(
+        0, djinterop::loop{
+               "Half beat", beat(2) - 200, beat(2.5) - 200,
+               djinterop::pad_color{}});
+    track.set_adjusted_main_cue(beat(7) - 100);
+    auto resolution = beats_per_step == 4
+                          ? djinterop::quantize_resolution::bar
+                          : djinterop::quantize_resolution::beat;
+
+    // Act
+    auto changed = db.quantize_cues({track.id(), 12345}, resolution);
+
+    // Assert
+    BOOST_CHECK_EQUAL(changed, 1);
+    auto snap = [&](double sample_offset) {
+        auto n = (sample_offset - 1000) / 22050;
+        return beat(std::round(n / beats_per_step) * beats_per_step);
+    };
+    auto hot_cue = track.hot_cue_at(0);
+    BOOST_REQUIRE(hot_cue);
+    BOOST_CHECK_CLOSE(hot_cue->sample_offset, snap(beat(5) + 300), 1e-9);
+    auto loop = track.loop_at(0);
+    BOOST_REQUIRE(loop);
+    BOOST_CHECK_CLOSE(loop->start_sample_offset, snap(beat(2) - 200), 1e-9);
+    BOOST_CHECK_CLOSE(
+        loop->end_sample_offset, loop->start_sample_offset + 11025, 1e-9);
+    BOOST_CHECK_CLOSE(track.adjusted_main_cue(), snap(beat(7) - 100), 1e-9);
+    BOOST_CHECK_EQUAL(db.quantize_cues({track.id()}, resolution), 0);
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("database::export_to() with several targets, all "
+                       "schema versions"))
+BOOST_DATA_TEST_CASE(
+    export_to__several_targets__tracks_copied, el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dirs.
+    temporary_directory tmp_loc_1;
+    temporary_directory tmp_loc_2;
+
+    {
+        // Arrange
+        auto db = el::create_temporary_database(version);
+        djinterop::track_snapshot snapshot{};
+        populate_track_snapshot(
+            example_track_type::fully_analysed_1, version, snapshot);
+        std::vector<djinterop::track_snapshot> expected;
+        std::vector<int64_t> ids;
+        for (int i = 0; i < 3; ++i)
+        {
+            snapshot.relative_path = "../track_" + std::to_string(i) + ".mp3";
+            ids.push_back(db.create_track(snapshot).id());
+            expected.push_back(snapshot);
+        }
+
+        ids.push_back(12345);
+        el::create_database(tmp_loc_1.temp_dir, version);
+        el::create_database(tmp_loc_2.temp_dir, version);
+        std::vector<std::string> directories{
+            tmp_loc_1.temp_dir, tmp_loc_2.temp_dir,
+            tmp_loc_1.temp_dir + "/missing"};
+        std::vector<std::size_t> completed(directories.size());
+        djinterop::export_options options;
+        options.batch_size = 2;
+        options.on_progress = [&](const djinterop::export_progress& progress) {
+            completed[progress.target] = progress.completed;
+        };
+
+        // Act
+        auto results = db.export_to(directories, ids, options);
+
+        // Assert
+        BOOST_REQUIRE_EQUAL(results.size(), 3);
+        for (std::size_t target = 0; target < 2; ++target)
+        {
+            BOOST_CHECK(!results[target].error);
+            BOOST_CHECK_EQUAL(completed[target], 4);
+            BOOST_REQUIRE_EQUAL(results[target].track_ids.size(), 3);
+            auto target_db = el::load_database(directories[target]);
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                auto tr = target_db.track_by_id(results[target].track_ids[i]);
+                BOOST_REQUIRE(tr);
+                assert_track_snapshot_equal(expected[i], tr->snapshot(), false);
+            }
+        }
+
+        BOOST_CHECK(results[2].error);
+        BOOST_CHECK(results[2].track_ids.empty());
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("database::columns(), all schema versions"))
+BOOST_DATA_TEST_CASE(
+    columns__several_tracks__aligned, el::all_versions, version)
+{
+    // Arrange
+    auto db = el::create_temporary_database(version);
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        example_track_type::fully_analysed_1, version, snapshot);
+    snapshot.relative_path = "../a.mp3";
+    snapshot.genre = "Techno";
+    snapshot.rating = 60;
+    auto tr_1 = db.create_track(snapshot);
+    snapshot.relative_path = "../b.mp3";
+    snapshot.genre = "House";
+    snapshot.rating = 40;
+    auto tr_2 = db.create_track(snapshot);
+    djinterop::track_snapshot empty_snapshot{};
+    empty_snapshot.relative_path = "../c.mp3";
+    auto tr_3 = db.create_track(empty_snapshot);
+
+    // Act
+    auto columns = db.columns(
+        {djinterop::track_column::bpm, djinterop::track_column::year,
+         djinterop::track_column::rating, djinterop::track_column::key,
+         djinterop::track_column::duration, djinterop::track_column::genre});
+
+    // Assert
+    BOOST_CHECK(
+        columns.ids == (std::vector<int64_t>{tr_1.id(), tr_2.id(), tr_3.id()}));
+    BOOST_REQUIRE_EQUAL(columns.bpm.size(), 3);
+    BOOST_CHECK_EQUAL(columns.bpm[0], *tr_1.bpm());
+    BOOST_CHECK_EQUAL(columns.bpm[1], *tr_2.bpm());
+    BOOST_CHECK(std::isnan(columns.bpm[2]));
+    BOOST_REQUIRE_EQUAL(columns.year.size(), 3);
+    BOOST_CHECK_EQUAL(columns.year[0], *tr_1.year());
+    BOOST_CHECK_EQUAL(columns.year[2], -1);
+    BOOST_REQUIRE_EQUAL(columns.rating.size(), 3);
+    BOOST_CHECK_EQUAL(columns.rating[0], 60);
+    BOOST_CHECK_EQUAL(columns.rating[1], 40);
+    BOOST_CHECK_EQUAL(columns.rating[2], -1);
+    BOOST_REQUIRE_EQUAL(columns.key.size(), 3);
+    BOOST_CHECK_EQUAL(columns.key[0], static_cast<int32_t>(*tr_1.key()));
+    BOOST_CHECK_EQUAL(columns.key[2], -1);
+    BOOST_REQUIRE_EQUAL(columns.duration.size(), 3);
+    BOOST_CHECK_EQUAL(
+        columns.duration[0],
+        std::chrono::duration_cast<std::chrono::seconds>(*tr_1.duration())
+            .count());
+    BOOST_CHECK(std::isnan(columns.duration[2]));
+    BOOST_CHECK(
+        columns.genre.dictionary ==
+        (std::vector<std::string>{"House", "Techno"}));
+    BOOST_CHECK(columns.genre.codes == (std::vector<int32_t>{1, 0, -1}));
+    BOOST_CHECK(columns.title.codes.empty());
+    BOOST_CHECK(columns.artist.dictionary.empty());
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("database::track_count(), crate::track_count() and "
+                       "batch existence checks, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    track_count__several_tracks__counted, el::all_versions, version)
+{
+    // Arrange
+    auto db = el::create_temporary_database(version);
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        example_track_type::fully_analysed_1, version, snapshot);
+    auto cr = db.create_root_crate("Crate");
+    std::vector<int64_t> ids;
+    for (int i = 0; i < 3; ++i)
+    {
+        snapshot.relative_path = "../track_" + std::to_string(i) + ".mp3";
+        auto tr = db.create_track(snapshot);
+        cr.add_track(tr);
+        ids.push_back(tr.id());
+    }
+
+    cr.remove_track(*db.track_by_id(ids[0]));
+
+    // Act
+    auto track_count = db.track_count();
+    auto crate_track_count = cr.track_count();
+    auto tracks_exist = db.tracks_exist({ids[2], 12345, ids[0], ids[2]});
+    auto crates_exist = db.crates_exist({12345, cr.id()});
+
+    // Assert
+    BOOST_CHECK_EQUAL(track_count, 3);
+    BOOST_CHECK_EQUAL(crate_track_count, 2);
+    BOOST_CHECK(tracks_exist == (std::vector<bool>{true, false, true, true}));
+    BOOST_CHECK(crates_exist == (std::vector<bool>{false, true}));
+    BOOST_CHECK(db.tracks_exist({}).empty());
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("database::import_folder_tree(), all schema versions"))
+BOOST_DATA_TEST_CASE(
+    import_folder_tree__nested_folders__mirrored, el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto root = tmp_loc.temp_dir_path;
+        for (auto path :
+             {"Music/a.mp3", "Music/House/b.mp3", "Music/House/Deep/c.flac",
+              "Music/House/cover.jpg", "Music/Techno/d.MP3",
+              "Music/Bad;Name/e.mp3"})
+        {
+            boost::filesystem::create_directories(
+                (root / path).parent_path());
+            std::ofstream os{(root / path).string(), std::ios::binary};
+            os << path;
+        }
+
+        boost::filesystem::create_directories(root / "Music/Empty");
+        auto db =
+            el::create_database((root / "Engine Library").string(), version);
+        djinterop::track_snapshot snapshot{};
+        populate_track_snapshot(
+            example_track_type::fully_analysed_1, version, snapshot);
+        snapshot.relative_path = "../Music/a.mp3";
+        auto existing = db.create_track(snapshot);
+
+        // Act
+        auto result = db.import_folder_tree((root / "Music").string());
+        auto repeated = db.import_folder_tree((root / "Music").string());
+
+        // Assert
+        BOOST_CHECK_EQUAL(result.created_track_ids.size(), 3);
+        BOOST_CHECK_EQUAL(result.matched_track_count, 1);
+        BOOST_CHECK_EQUAL(result.created_crate_count, 4);
+        BOOST_CHECK_EQUAL(repeated.created_track_ids.size(), 0);
+        BOOST_CHECK_EQUAL(repeated.matched_track_count, 4);
+        BOOST_CHECK_EQUAL(repeated.created_crate_count, 0);
+        BOOST_CHECK_EQUAL(repeated.root_crate_id, result.root_crate_id);
+
+        auto music = db.root_crate_by_name("Music");
+        BOOST_REQUIRE(music);
+        BOOST_CHECK_EQUAL(music->id(), result.root_crate_id);
+        BOOST_CHECK(!music->sub_crate_by_name("Empty"));
+        BOOST_CHECK(!music->sub_crate_by_name("Bad;Name"));
+        auto music_tracks = music->tracks();
+        BOOST_REQUIRE_EQUAL(music_tracks.size(), 1);
+        BOOST_CHECK_EQUAL(music_tracks[0].id(), existing.id());
+
+        auto house = music->sub_crate_by_name("House");
+        BOOST_REQUIRE(house);
+        BOOST_CHECK_EQUAL(house->track_count(), 1);
+        auto deep = house->sub_crate_by_name("Deep");
+        BOOST_REQUIRE(deep);
+        BOOST_CHECK_EQUAL(deep->parent()->id(), house->id());
+        auto deep_tracks = deep->tracks();
+        BOOST_REQUIRE_EQUAL(deep_tracks.size(), 1);
+        BOOST_CHECK_EQUAL(
+            deep_tracks[0].relative_path(), "../Music/House/Deep/c.flac");
+        auto techno = music->sub_crate_by_name("Techno");
+        BOOST_REQUIRE(techno);
+        BOOST_CHECK_EQUAL(techno->track_count(), 1);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("database::link_imported_tracks() and "
+                       "database::imported_tracks(), all schema versions"))
+BOOST_DATA_TEST_CASE(
+    link_imported_tracks__matching_paths__linked, el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dirs.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto source_db = el::create_database(tmp_loc.temp_dir, version);
+        auto db = el::create_temporary_database(version);
+        djinterop::track_snapshot snapshot{};
+        populate_track_snapshot(
+            example_track_type::fully_analysed_1, version, snapshot);
+        std::vector<int64_t> source_ids;
+        for (auto name : {"a", "b", "c"})
+        {
+            snapshot.relative_path = std::string{"../"} + name + ".mp3";
+            source_ids.push_back(source_db.create_track(snapshot).id());
+        }
+
+        std::vector<djinterop::track> tracks;
+        for (auto name : {"d", "c", "b"})
+        {
+            snapshot.relative_path = std::string{"../"} + name + ".mp3";
+            tracks.push_back(db.create_track(snapshot));
+        }
+
+        // Act
+        auto linked = db.link_imported_tracks(tmp_loc.temp_dir);
+        auto relinked = db.link_imported_tracks(tmp_loc.temp_dir);
+        auto links = db.imported_tracks(tmp_loc.temp_dir);
+        source_db.remove_track(*source_db.track_by_id(source_ids[2]));
+        auto remaining_links = db.imported_tracks(tmp_loc.temp_dir);
+
+        // Assert
+        BOOST_CHECK_EQUAL(linked, 2);
+        BOOST_CHECK_EQUAL(relinked, 0);
+        BOOST_CHECK(!tracks[0].import_info());
+        auto import_info = tracks[1].import_info();
+        BOOST_REQUIRE(import_info);
+        BOOST_CHECK_EQUAL(import_info->external_db_uuid, source_db.uuid());
+        BOOST_CHECK_EQUAL(import_info->external_track_id, source_ids[2]);
+        BOOST_REQUIRE_EQUAL(links.size(), 2);
+        BOOST_CHECK_EQUAL(links[0].id, tracks[1].id());
+        BOOST_CHECK_EQUAL(links[0].source_id, source_ids[2]);
+        BOOST_CHECK_EQUAL(links[1].id, tracks[2].id());
+        BOOST_CHECK_EQUAL(links[1].source_id, source_ids[1]);
+        BOOST_REQUIRE_EQUAL(remaining_links.size(), 1);
+        BOOST_CHECK_EQUAL(remaining_links[0].id, tracks[2].id());
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("database::relink_tracks(), all schema versions"))
+BOOST_DATA_TEST_CASE(
+    relink_tracks__moved_files__relinked, el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto root = tmp_loc.temp_dir_path;
+        auto write_file = [&](const std::string& path, std::size_t size) {
+            boost::filesystem::create_directories((root / path).parent_path());
+            std::ofstream os{(root / path).string(), std::ios::binary};
+            os << std::string(size, 'x');
+        };
+        write_file("present.mp3", 1);
+        write_file("moved/a/one.mp3", 10);
+        write_file("moved/b/two.mp3", 20);
+        write_file("moved/c/two.mp3", 20);
+        if (version >= el::version_1_15_0)
+        {
+            // A file of the wrong size is not a candidate.
+            write_file("moved/c/one.mp3", 11);
+        }
+
+        auto db =
+            el::create_database((root / "Engine Library").string(), version);
+        djinterop::track_snapshot snapshot{};
+        populate_track_snapshot(
+            example_track_type::fully_analysed_1, version, snapshot);
+        std::vector<djinterop::track> tracks;
+        std::pair<const char*, int64_t> files[] = {
+            {"present", 1}, {"one", 10}, {"two", 20}, {"three", 30}};
+        for (auto&& [name, size] : files)
+        {
+            snapshot.relative_path = std::string{"../"} + name + ".mp3";
+            snapshot.file_bytes = djinterop::stdx::nullopt;
+            if (version >= el::version_1_15_0)
+            {
+                snapshot.file_bytes = size;
+            }
+
+            tracks.push_back(db.create_track(snapshot));
+        }
+
+        // Act
+        auto result = db.relink_tracks({(root / "moved").string()});
+
+        // Assert
+        BOOST_REQUIRE_EQUAL(result.relinked.size(), 1);
+        BOOST_CHECK_EQUAL(result.relinked[0].id, tracks[1].id());
+        BOOST_CHECK_EQUAL(
+            result.relinked[0].relative_path, "../moved/a/one.mp3");
+        BOOST_CHECK_EQUAL(tracks[1].relative_path(), "../moved/a/one.mp3");
+        BOOST_CHECK_EQUAL(tracks[0].relative_path(), "../present.mp3");
+        BOOST_REQUIRE_EQUAL(result.ambiguous.size(), 1);
+        BOOST_CHECK_EQUAL(result.ambiguous[0].id, tracks[2].id());
+        BOOST_CHECK_EQUAL(result.ambiguous[0].candidates.size(), 2);
+        BOOST_CHECK_EQUAL(tracks[2].relative_path(), "../two.mp3");
+        BOOST_REQUIRE_EQUAL(result.unmatched.size(), 1);
+        BOOST_CHECK_EQUAL(result.unmatched[0], tracks[3].id());
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("database::backup_to() in small steps, all schema "
+                       "versions"))
+BOOST_DATA_TEST_CASE(backup_to__small_steps__copied, el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dirs.
+    temporary_directory tmp_loc_1;
+    temporary_directory tmp_loc_2;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc_1.temp_dir, version);
+        djinterop::track_snapshot snapshot{};
+        populate_track_snapshot(
+            example_track_type::fully_analysed_1, version, snapshot);
+        auto track = db.create_track(snapshot);
+        djinterop::backup_options options;
+        options.pages_per_step = 1;
+        options.step_interval = std::chrono::milliseconds{0};
+        std::size_t steps = 0;
+        options.on_progress = [&](const djinterop::backup_progress& progress) {
+            ++steps;
+            BOOST_CHECK(
+                progress.filename == "m.db" || progress.filename == "p.db");
+            BOOST_CHECK_LE(progress.copied_pages, progress.total_pages);
+        };
+
+        // Act
+        auto backed_up = db.backup_to(tmp_loc_2.temp_dir, options);
+
+        // Assert
+        BOOST_CHECK(backed_up);
+        BOOST_CHECK_GT(steps, 2);
+        auto backup = el::load_database(tmp_loc_2.temp_dir);
+        BOOST_CHECK_EQUAL(backup.uuid(), db.uuid());
+        auto backup_track = backup.track_by_id(track.id());
+        BOOST_REQUIRE(backup_track);
+        assert_track_snapshot_equal(snapshot, backup_track->snapshot(), false);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("database::backup_to() skips unchanged databases"))
+BOOST_AUTO_TEST_CASE(backup_to__unchanged__skipped)
+{
+    // Note separate scope to ensure no locks are held on the temporary dirs.
+    temporary_directory tmp_loc_1;
+    temporary_directory tmp_loc_2;
+
+    {
+        // Arrange
+        auto version = el::version_1_17_0;
+        auto db = el::create_database(tmp_loc_1.temp_dir, version);
+        djinterop::track_snapshot snapshot{};
+        populate_track_snapshot(
+            example_track_type::fully_analysed_1, version, snapshot);
+        auto track = db.create_track(snapshot);
+        djinterop::backup_options options;
+        options.skip_if_unchanged = true;
+        db.backup_to(tmp_loc_2.temp_dir, options);
+
+        // Act
+        auto unchanged_backed_up = db.backup_to(tmp_loc_2.temp_dir, options);
+        track.set_bitrate(int64_t{1411});
+        auto changed_backed_up = db.backup_to(tmp_loc_2.temp_dir, options);
+
+        // Assert
+        BOOST_CHECK(!unchanged_backed_up);
+        BOOST_CHECK(changed_backed_up);
+        auto backup = el::load_database(tmp_loc_2.temp_dir);
+        BOOST_CHECK(backup.track_by_id(track.id())->bitrate() == 1411);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("database::create_delta_package() and "
+                       "database::apply_delta_package() transfer only "
+                       "changes"))
+BOOST_AUTO_TEST_CASE(apply_delta_package__repeated__changes_transferred)
+{
+    // Note separate scope to ensure no locks are held on the temporary dirs.
+    temporary_directory tmp_loc_1;
+    temporary_directory tmp_loc_2;
+
+    {
+        // Arrange
+        auto version = el::version_1_18_0;
+        auto db = el::create_temporary_database(version);
+        auto target_db = el::create_database(tmp_loc_1.temp_dir, version);
+        djinterop::track_snapshot snapshot{};
+        populate_track_snapshot(
+            example_track_type::fully_analysed_1, version, snapshot);
+        snapshot.relative_path = "../a.mp3";
+        auto track_a = db.create_track(snapshot);
+        snapshot.relative_path = "../b.mp3";
+        auto track_b = db.create_track(snapshot);
+        db.create_root_crate("Crate").create_sub_crate("Sub").add_track(
+            track_a);
+        auto package = [&](const std::string& name) {
+            return tmp_loc_2.temp_dir + "/" + name;
+        };
+
+        // Act
+        auto first_packaged =
+            db.create_delta_package(package("1"), tmp_loc_1.temp_dir);
+        auto first_applied = target_db.apply_delta_package(package("1"));
+        track_b.set_title(std::string{"Changed"});
+        snapshot.relative_path = "../c.mp3";
+        db.create_track(snapshot);
+        auto second_packaged =
+            db.create_delta_package(package("2"), tmp_loc_1.temp_dir);
+        auto second_applied = target_db.apply_delta_package(package("2"));
+        auto third_packaged =
+            db.create_delta_package(package("3"), tmp_loc_1.temp_dir);
+
+        // Assert
+        BOOST_CHECK_EQUAL(first_packaged, 2);
+        BOOST_CHECK_EQUAL(first_applied, 2);
+        BOOST_CHECK_EQUAL(second_packaged, 2);
+        BOOST_CHECK_EQUAL(second_applied, 2);
+        BOOST_CHECK_EQUAL(third_packaged, 0);
+        BOOST_REQUIRE_EQUAL(target_db.tracks().size(), 3);
+        for (auto&& tr : db.tracks())
+        {
+            auto copies = target_db.tracks_by_relative_path(tr.relative_path());
+            BOOST_REQUIRE_EQUAL(copies.size(), 1);
+            assert_track_snapshot_equal(
+                tr.snapshot(), copies[0].snapshot(), false);
+        }
+
+        auto crate = target_db.root_crate_by_name("Crate");
+        BOOST_REQUIRE(crate);
+        auto sub_crate = crate->sub_crate_by_name("Sub");
+        BOOST_REQUIRE(sub_crate);
+        auto crate_tracks = sub_crate->tracks();
+        BOOST_REQUIRE_EQUAL(crate_tracks.size(), 1);
+        BOOST_CHECK_EQUAL(crate_tracks[0].relative_path(), "../a.mp3");
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("database::apply_delta_package() after changes to "
+                       "crates only"))
+BOOST_AUTO_TEST_CASE(apply_delta_package__crate_changed__tracks_replaced)
+{
+    // Note separate scope to ensure no locks are held on the temporary dirs.
+    temporary_directory tmp_loc_1;
+    temporary_directory tmp_loc_2;
+
+    {
+        // Arrange
+        auto version = el::version_1_18_0;
+        auto db = el::create_temporary_database(version);
+        auto target_db = el::create_database(tmp_loc_1.temp_dir, version);
+        djinterop::track_snapshot snapshot{};
+        snapshot.relative_path = "../a.mp3";
+        auto track_a = db.create_track(snapshot);
+        snapshot.relative_path = "../b.mp3";
+        auto track_b = db.create_track(snapshot);
+        auto sub_crate = db.create_root_crate("Crate").create_sub_crate("Sub");
+        sub_crate.add_track(track_a);
+        auto package = [&](const std::string& name) {
+            return tmp_loc_2.temp_dir + "/" + name;
+        };
+
+        db.create_delta_package(package("1"), tmp_loc_1.temp_dir);
+        target_db.apply_delta_package(package("1"));
+
+        // Act
+        sub_crate.remove_track(track_a);
+        sub_crate.add_track(track_b);
+        auto packaged =
+            db.create_delta_package(package("2"), tmp_loc_1.temp_dir);
+        auto applied = target_db.apply_delta_package(package("2"));
+
+        // Assert
+        BOOST_CHECK_EQUAL(packaged, 1);
+        BOOST_CHECK_EQUAL(applied, 1);
+        BOOST_CHECK_EQUAL(target_db.tracks().size(), 2);
+        auto crate = target_db.root_crate_by_name("Crate");
+        BOOST_REQUIRE(crate);
+        auto target_sub_crate = crate->sub_crate_by_name("Sub");
+        BOOST_REQUIRE(target_sub_crate);
+        auto crate_tracks = target_sub_crate->tracks();
+        BOOST_REQUIRE_EQUAL(crate_tracks.size(), 1);
+        BOOST_CHECK_EQUAL(crate_tracks[0].relative_path(), "../b.mp3");
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("database::apply_delta_package() for a track whose "
+                       "album art is missing"))
+BOOST_AUTO_TEST_CASE(apply_delta_package__missing_album_art__no_album_art)
+{
+    // Note separate scope to ensure no locks are held on the temporary dirs.
+    temporary_directory tmp_loc_1;
+    temporary_directory tmp_loc_2;
+
+    {
+        // Arrange
+        auto version = el::version_1_18_0;
+        auto db = el::create_temporary_database(version);
+        auto target_db = el::create_database(tmp_loc_1.temp_dir, version);
+        djinterop::track_snapshot snapshot{};
+        snapshot.relative_path = "../a.mp3";
+        auto track = db.create_track(snapshot);
+        track.set_album_art_id(5);
+        auto package = tmp_loc_2.temp_dir + "/1";
+        db.create_delta_package(package, tmp_loc_1.temp_dir);
+
+        // Act
+        target_db.apply_delta_package(package);
+
+        // Assert
+        auto copies = target_db.tracks_by_relative_path("../a.mp3");
+        BOOST_REQUIRE_EQUAL(copies.size(), 1);
+        BOOST_CHECK(!copies[0].album_art_id());
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("database::clone_to_memory() of an on-disk database, "
+                       "all schema versions"))
+BOOST_DATA_TEST_CASE(
+    clone_to_memory__on_disk__independent_copy, el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        djinterop::track_snapshot snapshot{};
+        populate_track_snapshot(
+            example_track_type::fully_analysed_1, version, snapshot);
+        auto track = db.create_track(snapshot);
+
+        // Act
+        auto clone = db.clone_to_memory();
+
+        // Assert
+        BOOST_CHECK_EQUAL(clone.uuid(), db.uuid());
+        BOOST_CHECK(clone.version() == db.version());
+        auto clone_track = clone.track_by_id(track.id());
+        BOOST_REQUIRE(clone_track);
+        assert_track_snapshot_equal(snapshot, clone_track->snapshot(), false);
+
+        clone_track->set_title(std::string{"Changed"});
+        clone.create_root_crate("Clone only");
+        BOOST_CHECK(track.title() == snapshot.title);
+        BOOST_CHECK(!db.root_crate_by_name("Clone only"));
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("database::checkpoint() of a database in WAL mode, "
+                       "all schema versions"))
+BOOST_DATA_TEST_CASE(
+    checkpoint__wal_mode__log_copied, el::all_versions, version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        db.set_wal_mode(true);
+        djinterop::track_snapshot snapshot{};
+        populate_track_snapshot(
+            example_track_type::fully_analysed_1, version, snapshot);
+        db.create_track(snapshot);
+
+        // Act
+        auto results = db.checkpoint();
+        auto truncate_results =
+            db.checkpoint(djinterop::checkpoint_mode::truncate);
+
+        // Assert
+        BOOST_REQUIRE_EQUAL(results.size(), 2);
+        BOOST_CHECK_EQUAL(results[0].filename, "m.db");
+        BOOST_CHECK_EQUAL(results[1].filename, "p.db");
+        for (auto&& result : results)
+        {
+            BOOST_CHECK_GT(result.log_frames, 0);
+            BOOST_CHECK_EQUAL(result.checkpointed_frames, result.log_frames);
+            BOOST_CHECK(!result.busy);
+        }
+
+        BOOST_REQUIRE_EQUAL(truncate_results.size(), 2);
+        for (auto&& result : truncate_results)
+        {
+            BOOST_CHECK_EQUAL(result.log_frames, 0);
+            BOOST_CHECK(!result.busy);
+        }
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    * utf::description("database::set_checkpoint_options() with background "
+                       "checkpoints, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    set_checkpoint_options__background__changes_persisted, el::all_versions,
+    version)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+    int64_t track_id;
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        example_track_type::fully_analysed_1, version, snapshot);
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        db.set_wal_mode(true);
+        djinterop::checkpoint_options options;
+        options.auto_checkpoint_frames = 1;
+        options.background = true;
+        db.set_checkpoint_options(options);
+
+        // Act
+        track_id = db.create_track(snapshot).id();
+    }
+
+    // Assert
+    {
+        auto db = el::load_database(tmp_loc.temp_dir);
+        auto track = db.track_by_id(track_id);
+        BOOST_REQUIRE(track);
+        assert_track_snapshot_equal(snapshot, track->snapshot(), false);
+        for (auto&& result : db.checkpoint())
+        {
+            BOOST_CHECK(!result.busy);
+        }
+    }
+}
@@ -0,0 +1,218 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/performance_data_codec.hpp>
+
+#define BOOST_TEST_MODULE performance_data_codec_test
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace utf = boost::unit_test;
+namespace el = djinterop::enginelibrary;
+
+namespace
+{
+el::beat_data make_beat_data()
+{
+    el::beat_data data;
+    data.sampling = djinterop::sampling_info{44100, 10000000};
+    data.default_beatgrid = {{-4, -83316.78}, {812, 17470734.439}};
+    data.adjusted_beatgrid = {{-4, -83316.78}, {812, 17470734.439}};
+    return data;
+}
+
+el::quick_cues_data make_quick_cues_data()
+{
+    el::quick_cues_data data;
+    data.hot_cues[0] = djinterop::hot_cue{
+        "Cue 1", 1377924.5, djinterop::pad_color{0xFF, 0x00, 0x00, 0xFF}};
+    data.hot_cues[3] = djinterop::hot_cue{
+        "Cue 4", 5508265.3, djinterop::pad_color{0x00, 0xFF, 0x00, 0xFF}};
+    data.adjusted_main_cue = 1144.012;
+    data.default_main_cue = 1144.012;
+    return data;
+}
+
+el::high_res_waveform_data make_waveform_data(std::size_t size)
+{
+    el::high_res_waveform_data data;
+    data.samples_per_entry = 441;
+    data.waveform.resize(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        auto value = static_cast<uint8_t>(i);
+        data.waveform[i] = djinterop::waveform_entry{
+            {value, 255}, {value, 127}, {value, 63}};
+    }
+    return data;
+}
+
+}  // anonymous namespace
+
+BOOST_TEST_DECORATOR(*utf::description("beat_data round trip"))
+BOOST_AUTO_TEST_CASE(beat_data__round_trip__equal)
+{
+    // Arrange
+    auto expected = make_beat_data();
+
+    // Act
+    auto actual = el::beat_data::decode(expected.encode());
+
+    // Assert
+    BOOST_CHECK(actual == expected);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("encode() into a buffer matches encode() by value"))
+BOOST_AUTO_TEST_CASE(encode__reused_buffer__same_blob)
+{
+    // Arrange
+    auto data = make_quick_cues_data();
+    std::vector<char> blob(100000, 'x');
+
+    // Act
+    data.encode(blob);
+
+    // Assert
+    BOOST_CHECK(blob == data.encode());
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("decode() into a used object replaces its contents"))
+BOOST_AUTO_TEST_CASE(decode__reused_object__overwritten)
+{
+    // Arrange
+    auto used = make_quick_cues_data();
+    el::quick_cues_data expected;
+    expected.hot_cues[5] = djinterop::hot_cue{
+        "Cue 6", 42.5, djinterop::pad_color{0x00, 0x00, 0xFF, 0xFF}};
+    auto blob = expected.encode();
+
+    // Act
+    el::quick_cues_data::decode(blob.data(), blob.size(), used);
+
+    // Assert
+    BOOST_CHECK(used == expected);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("decode() into a used waveform shrinks and grows it"))
+BOOST_AUTO_TEST_CASE(decode__reused_waveform__resized)
+{
+    // Arrange
+    auto small = make_waveform_data(16);
+    auto large = make_waveform_data(4096);
+    auto small_blob = small.encode();
+    auto large_blob = large.encode();
+    el::high_res_waveform_data actual;
+
+    // Act/Assert
+    el::high_res_waveform_data::decode(
+        large_blob.data(), large_blob.size(), actual);
+    BOOST_CHECK(actual == large);
+    el::high_res_waveform_data::decode(
+        small_blob.data(), small_blob.size(), actual);
+    BOOST_CHECK(actual == small);
+}
+
+BOOST_TEST_DECORATOR(*utf::description("loops_data round trip, uncompressed"))
+BOOST_AUTO_TEST_CASE(loops_data__round_trip__equal)
+{
+    // Arrange
+    el::loops_data expected;
+    expected.loops[1] = djinterop::loop{
+        "Loop 2", 1144.012, 345339.134,
+        djinterop::pad_color{0x00, 0xFF, 0xFF, 0xFF}};
+    std::vector<char> blob;
+    el::loops_data actual;
+
+    // Act
+    expected.encode(blob);
+    el::loops_data::decode(blob.data(), blob.size(), actual);
+
+    // Assert
+    BOOST_CHECK_EQUAL(blob.size(), 192 + 6);
+    BOOST_CHECK(actual == expected);
+}
+
+BOOST_TEST_DECORATOR(*utf::description("track_data round trip"))
+BOOST_AUTO_TEST_CASE(track_data__round_trip__equal)
+{
+    // Arrange
+    el::track_data expected;
+    expected.sampling = djinterop::sampling_info{48000, 15552000};
+    expected.average_loudness = 0.5;
+    expected.key = djinterop::musical_key::a_minor;
+
+    // Act
+    auto actual = el::track_data::decode(expected.encode());
+
+    // Assert
+    BOOST_CHECK(actual == expected);
+}
+
+BOOST_TEST_DECORATOR(*utf::description("decode() rejects malformed BLOBs"))
+BOOST_AUTO_TEST_CASE(decode__malformed__throws)
+{
+    // Arrange
+    std::vector<char> short_loops(100, 0);
+    auto track_blob = el::track_data{}.encode();
+    el::quick_cues_data quick_cues;
+
+    // Act/Assert
+    BOOST_CHECK_THROW(
+        el::loops_data::decode(short_loops), std::invalid_argument);
+    BOOST_CHECK_THROW(
+        el::quick_cues_data::decode(
+            track_blob.data(), track_blob.size(), quick_cues),
+        std::invalid_argument);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("decode() rejects truncated compressed BLOBs"))
+BOOST_AUTO_TEST_CASE(decode__truncated__throws)
+{
+    // Arrange
+    auto blob = make_beat_data().encode();
+    std::vector<char> truncated{blob.begin(), blob.begin() + blob.size() / 2};
+    std::vector<char> header_only{blob.begin(), blob.begin() + 4};
+
+    // Act/Assert
+    BOOST_CHECK_THROW(el::beat_data::decode(truncated), std::invalid_argument);
+    BOOST_CHECK_THROW(
+        el::beat_data::decode(header_only), std::invalid_argument);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("decode() rejects short or corrupt compressed BLOBs"))
+BOOST_AUTO_TEST_CASE(decode__corrupt__throws)
+{
+    // Arrange
+    std::vector<char> too_short{0, 1};
+    auto corrupt = make_beat_data().encode();
+    for (std::size_t i = 4; i < corrupt.size(); ++i)
+    {
+        corrupt[i] = static_cast<char>(0xFF);
+    }
+
+    // Act/Assert
+    BOOST_CHECK_THROW(el::beat_data::decode(too_short), std::invalid_argument);
+    BOOST_CHECK_THROW(el::beat_data::decode(corrupt), std::invalid_argument);
+}
@@ -22,14 +22,17 @@
 
 #include <ostream>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include <djinterop/enginelibrary.hpp>
+#include <djinterop/playback_data.hpp>
 #include <djinterop/track_snapshot.hpp>
 
 #include "boost_test_utils.hpp"
 #include "example_track_data.hpp"
+#include "temporary_directory.hpp"
 
 #define STRINGIFY(x) STRINGIFY_(x)
 #define STRINGIFY_(x) #x
@@ -199,3 +202,111 @@ BOOST_DATA_TEST_CASE(
     // Assert
     BOOST_CHECK(track.sampling() == djinterop::stdx::nullopt);
 }
+
+BOOST_TEST_DECORATOR(
+    *utf::description("set waveform with transients, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    set_waveform__transients__preserved_in_overview, el::all_versions, version)
+{
+    // Arrange
+    auto db = el::create_temporary_database(version);
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        example_track_type::fully_analysed_1, version, snapshot);
+    auto track = db.create_track(snapshot);
+    djinterop::waveform_entry quiet{{10, 255}, {10, 255}, {10, 255}};
+    std::vector<djinterop::waveform_entry> waveform(10000, quiet);
+    waveform[5] = djinterop::waveform_entry{{200, 255}, {10, 255}, {10, 255}};
+    waveform[8] = djinterop::waveform_entry{{10, 255}, {150, 255}, {10, 255}};
+    waveform[9999] =
+        djinterop::waveform_entry{{10, 255}, {10, 255}, {100, 255}};
+
+    // Act
+    track.set_waveform(waveform);
+
+    // Assert
+    auto overview = track.overview_waveform();
+    BOOST_REQUIRE_EQUAL(overview.size(), 1024);
+    BOOST_CHECK(
+        overview[0] ==
+        (djinterop::waveform_entry{{200, 255}, {150, 255}, {10, 255}}));
+    BOOST_CHECK(overview[1] == quiet);
+    BOOST_CHECK(
+        overview[1023] ==
+        (djinterop::waveform_entry{{10, 255}, {10, 255}, {100, 255}}));
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("load for playback matches snapshot, all schema "
+                      "versions, all snapshots"))
+BOOST_DATA_TEST_CASE(
+    load_for_playback__supported_version__same_as_snapshot,
+    el::all_versions* creatable_snapshot_types, version, snapshot_type)
+{
+    // Arrange
+    auto db = el::create_temporary_database(version);
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(snapshot_type, version, snapshot);
+    auto track = db.create_track(snapshot);
+    auto expected = track.snapshot();
+
+    // Act
+    auto actual = track.load_for_playback();
+
+    // Assert
+    BOOST_CHECK_EQUAL(actual.track_id, track.id());
+    BOOST_CHECK_EQUAL(pr(expected.sampling), pr(actual.sampling));
+    BOOST_TEST(
+        expected.default_beatgrid == actual.default_beatgrid,
+        boost::test_tools::per_element());
+    BOOST_TEST(
+        expected.adjusted_beatgrid == actual.adjusted_beatgrid,
+        boost::test_tools::per_element());
+    BOOST_CHECK_EQUAL(
+        pr(expected.default_main_cue), pr(actual.default_main_cue));
+    BOOST_CHECK_EQUAL(
+        pr(expected.adjusted_main_cue), pr(actual.adjusted_main_cue));
+    BOOST_TEST(
+        expected.hot_cues == actual.hot_cues, boost::test_tools::per_element());
+    BOOST_TEST(
+        expected.loops == actual.loops, boost::test_tools::per_element());
+    BOOST_CHECK_EQUAL(
+        pr(expected.average_loudness), pr(actual.average_loudness));
+    BOOST_REQUIRE(actual.waveform);
+    BOOST_TEST(
+        expected.waveform == *actual.waveform,
+        boost::test_tools::per_element());
+    BOOST_REQUIRE(actual.overview_waveform);
+    BOOST_CHECK(*actual.overview_waveform == track.overview_waveform());
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("prefetched track reads back the same, and reflects "
+                      "later writes, all schema versions, all snapshots"))
+BOOST_DATA_TEST_CASE(
+    prefetch__supported_version__same_then_updated,
+    el::all_versions* creatable_snapshot_types, version, snapshot_type)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = el::create_database(tmp_loc.temp_dir, version);
+        djinterop::track_snapshot expected{};
+        populate_track_snapshot(snapshot_type, version, expected);
+        auto track = db.create_track(expected);
+        auto expected_overview = track.overview_waveform();
+
+        // Act
+        db.prefetch({track.id()});
+        std::this_thread::sleep_for(c::milliseconds{100});
+
+        // Assert
+        auto actual = track.snapshot();
+        assert_track_snapshot_equal(expected, actual, false);
+        BOOST_CHECK(track.overview_waveform() == expected_overview);
+        track.set_title(std::string{"Updated Title"});
+        BOOST_CHECK(track.title() == std::string{"Updated Title"});
+    }
+}
@@ -0,0 +1,148 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/waveform_render.hpp>
+
+#define BOOST_TEST_MODULE waveform_render_test
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace utf = boost::unit_test;
+
+namespace
+{
+const djinterop::waveform_palette palette{
+    djinterop::pad_color{0x00, 0x00, 0x00, 0xFF},
+    djinterop::pad_color{0xFF, 0x00, 0x00, 0xFF},
+    djinterop::pad_color{0x00, 0xFF, 0x00, 0xFF},
+    djinterop::pad_color{0x00, 0x00, 0xFF, 0xFF}};
+
+djinterop::pad_color pixel_at(
+    const djinterop::waveform_tile& tile, int x, int y)
+{
+    auto offset = 4 * (y * tile.width + x);
+    return djinterop::pad_color{
+        tile.pixels[offset], tile.pixels[offset + 1], tile.pixels[offset + 2],
+        tile.pixels[offset + 3]};
+}
+
+djinterop::waveform_entry make_entry(uint8_t low, uint8_t mid, uint8_t high)
+{
+    return djinterop::waveform_entry{{low, 255}, {mid, 255}, {high, 255}};
+}
+
+}  // anonymous namespace
+
+BOOST_TEST_DECORATOR(*utf::description("render_waveform_tile() band layering"))
+BOOST_AUTO_TEST_CASE(render_waveform_tile__nested_bands__layered)
+{
+    // Arrange
+    std::vector<djinterop::waveform_entry> waveform{make_entry(255, 128, 64)};
+
+    // Act
+    auto tile =
+        djinterop::render_waveform_tile(waveform, 1, 0, 1, 100, palette);
+
+    // Assert
+    BOOST_REQUIRE_EQUAL(tile.pixels.size(), 400);
+    BOOST_CHECK(pixel_at(tile, 0, 0) == palette.low);
+    BOOST_CHECK(pixel_at(tile, 0, 99) == palette.low);
+    BOOST_CHECK(pixel_at(tile, 0, 30) == palette.mid);
+    BOOST_CHECK(pixel_at(tile, 0, 69) == palette.mid);
+    BOOST_CHECK(pixel_at(tile, 0, 40) == palette.high);
+    BOOST_CHECK(pixel_at(tile, 0, 59) == palette.high);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("render_waveform_tile() preserves peaks when zoomed out"))
+BOOST_AUTO_TEST_CASE(render_waveform_tile__zoomed_out__peaks_preserved)
+{
+    // Arrange
+    std::vector<djinterop::waveform_entry> waveform(1000, make_entry(0, 0, 0));
+    waveform[517] = make_entry(255, 0, 0);
+
+    // Act
+    auto tile =
+        djinterop::render_waveform_tile(waveform, 100, 1, 4, 10, palette);
+
+    // Assert
+    // Tile 1 covers entries 400 to 799, so column 1 covers entries 500 to 599.
+    BOOST_CHECK(pixel_at(tile, 0, 5) == palette.background);
+    BOOST_CHECK(pixel_at(tile, 1, 0) == palette.low);
+    BOOST_CHECK(pixel_at(tile, 1, 5) == palette.low);
+    BOOST_CHECK(pixel_at(tile, 2, 5) == palette.background);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("render_waveform_tile() beyond the end of the waveform"))
+BOOST_AUTO_TEST_CASE(render_waveform_tile__beyond_end__background)
+{
+    // Arrange
+    std::vector<djinterop::waveform_entry> waveform(10, make_entry(255, 0, 0));
+
+    // Act
+    auto tile =
+        djinterop::render_waveform_tile(waveform, 0.5, 1, 16, 4, palette);
+
+    // Assert
+    // Tile 1 covers entries 8 to 15, so only the first four columns are drawn.
+    BOOST_CHECK(pixel_at(tile, 3, 2) == palette.low);
+    BOOST_CHECK(pixel_at(tile, 4, 2) == palette.background);
+    BOOST_CHECK(pixel_at(tile, 15, 2) == palette.background);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("render_waveform_tile() blends translucent bands"))
+BOOST_AUTO_TEST_CASE(render_waveform_tile__translucent__blended)
+{
+    // Arrange
+    std::vector<djinterop::waveform_entry> waveform{
+        djinterop::waveform_entry{{255, 255}, {0, 255}, {255, 0}}};
+    auto translucent = palette;
+    translucent.low.a = 0x80;
+
+    // Act
+    auto tile =
+        djinterop::render_waveform_tile(waveform, 1, 0, 1, 2, translucent);
+
+    // Assert
+    // The high band has zero opacity, and so is invisible.
+    BOOST_CHECK(
+        pixel_at(tile, 0, 0) == (djinterop::pad_color{0x80, 0x00, 0x00, 0xFF}));
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("render_waveform_tile() with invalid arguments"))
+BOOST_AUTO_TEST_CASE(render_waveform_tile__invalid_arguments__throws)
+{
+    // Arrange
+    std::vector<djinterop::waveform_entry> waveform(10);
+
+    // Act / Assert
+    BOOST_CHECK_THROW(
+        djinterop::render_waveform_tile(waveform, 0, 0, 16, 16),
+        std::invalid_argument);
+    BOOST_CHECK_THROW(
+        djinterop::render_waveform_tile(waveform, 1, -1, 16, 16),
+        std::invalid_argument);
+    BOOST_CHECK_THROW(
+        djinterop::render_waveform_tile(waveform, 1, 0, 0, 16),
+        std::invalid_argument);
+}